@@ -17,10 +17,34 @@
     #define DEVICE_UNCONNECTED 0
 #endif
 
+/**
+*   \brief States of the asynchronous transfer.
+*/
+#define ASYNC_IDLE    0 ///< No transfer in progress
+#define ASYNC_WRITING 1 ///< Register address being written (no stop)
+#define ASYNC_READING 2 ///< Data being read after the repeated start
+
 #include "I2C_Interface.h" 
 #include "I2C_Master.h"
 #include "project.h"
 
+static uint8_t async_state = ASYNC_IDLE;
+static uint8_t async_device_address;
+static uint8_t async_register_address; // Must outlive the call: the ISR sends it
+static uint8_t async_register_count;
+static uint8_t* async_data;
+static I2C_Peripheral_Callback async_callback;
+static ErrorCode async_error = NO_ERROR;
+static I2C_Peripheral_BusCounters bus_counters;
+
+    static void I2C_Peripheral_CountTransaction(uint16_t bytes)
+    {
+        bus_counters.transactions++;
+        bus_counters.bytes += bytes;
+    }
+    
+    
+    
     ErrorCode I2C_Peripheral_Start(void) 
     {
         // Start I2C peripheral
@@ -46,6 +70,9 @@
                                             uint8_t register_address,
                                             uint8_t* data)
     {
+        // Device address (write), register address, device address (read), data
+        I2C_Peripheral_CountTransaction(4);
+        
         // Send start condition
         uint8_t error = I2C_Master_MasterSendStart(device_address,I2C_Master_WRITE_XFER_MODE);
         if (error == I2C_Master_MSTR_NO_ERROR)
@@ -73,15 +100,23 @@
     
     ErrorCode I2C_Peripheral_ReadRegisterMulti(uint8_t device_address,
                                                 uint8_t register_address,
-                                                uint8_t register_count,
+                                                uint16_t register_count,
                                                 uint8_t* data)
     {
-        uint8 i =0 ;
+        uint16_t i =0 ;
+        
+        if (register_count == 0)
+        {
+            return ERROR;
+        }
         
         /*Datasheet specifies to set the MSB equal to 1 in order to enable 
         the reading/writing of multiple adjacent registers*/ 
         register_address = register_address | 0x80; 
         
+        // Two device addresses, register address, register_count data bytes
+        I2C_Peripheral_CountTransaction(3 + register_count);
+        
         // Send start condition
         uint8_t error = I2C_Master_MasterSendStart(device_address,I2C_Master_WRITE_XFER_MODE);
         if (error == I2C_Master_MSTR_NO_ERROR)
@@ -96,13 +131,13 @@
                 {
                     /*Read multiple adjacent registers*/
                    
-                    for (i = 0; i< register_count; i++)
+                    for (i = 0; i< register_count - 1; i++)
                     {
                     // Read data with acknowledgement
                     *(data+i) = I2C_Master_MasterReadByte(I2C_Master_ACK_DATA); //qui metto ACK al posto di NACK
 
                     }
-                    // Read data without acknowledgement
+                    // Read last data without acknowledgement
                     *(data+i) = I2C_Master_MasterReadByte(I2C_Master_NAK_DATA);
                 }
             }
@@ -120,6 +155,9 @@
                                             uint8_t register_address,
                                             uint8_t data)
     {
+        // Device address, register address, data
+        I2C_Peripheral_CountTransaction(3);
+        
         // Send start condition
         uint8_t error = I2C_Master_MasterSendStart(device_address, I2C_Master_WRITE_XFER_MODE);
         if (error == I2C_Master_MSTR_NO_ERROR)
@@ -147,10 +185,18 @@
     {
         uint8 i =0 ;
         
+        if (register_count == 0)
+        {
+            return ERROR;
+        }
+        
         /*Datasheet specifies to set the MSB equal to 1 in order to enable 
         the reading/writing of multiple adjacent registers*/ 
         register_address = register_address | 0x80;
         
+        // Device address, register address, register_count data bytes
+        I2C_Peripheral_CountTransaction(2 + register_count);
+        
         // Send start condition
         uint8_t error = I2C_Master_MasterSendStart(device_address, I2C_Master_WRITE_XFER_MODE);
         if (error == I2C_Master_MSTR_NO_ERROR)
@@ -160,7 +206,7 @@
             if (error == I2C_Master_MSTR_NO_ERROR)
             {
                 /*Write in multiple adjacent registers*/
-                for (i = 0; i<= register_count; i++) 
+                for (i = 0; i < register_count && error == I2C_Master_MSTR_NO_ERROR; i++) 
                 {
                 // Write byte of interest
                 error = I2C_Master_MasterWriteByte(*(data+i));
@@ -177,6 +223,9 @@
     
     uint8_t I2C_Peripheral_IsDeviceConnected(uint8_t device_address)
     {
+        // Device address only
+        I2C_Peripheral_CountTransaction(1);
+        
         // Send a start condition followed by a stop condition
         uint8_t error = I2C_Master_MasterSendStart(device_address, I2C_Master_WRITE_XFER_MODE);
         I2C_Master_MasterSendStop();
@@ -187,5 +236,130 @@
         }
         return DEVICE_UNCONNECTED;
     }
+    
+    
+    
+    static void I2C_Peripheral_AsyncComplete(ErrorCode error)
+    {
+        async_state = ASYNC_IDLE;
+        async_error = error;
+        if (async_callback != NULL)
+        {
+            async_callback(error);
+        }
+    }
+    
+    
+    
+    ErrorCode I2C_Peripheral_ReadRegisterMultiAsync(uint8_t device_address,
+                                                    uint8_t register_address,
+                                                    uint8_t register_count,
+                                                    uint8_t* data,
+                                                    I2C_Peripheral_Callback callback)
+    {
+        // Only one transfer at a time
+        if (async_state != ASYNC_IDLE || register_count == 0)
+        {
+            return ERROR;
+        }
+        
+        /*Datasheet specifies to set the MSB equal to 1 in order to enable 
+        the reading/writing of multiple adjacent registers*/ 
+        async_register_address = register_address | 0x80;
+        async_device_address = device_address;
+        async_register_count = register_count;
+        async_data = data;
+        async_callback = callback;
+        
+        // Two device addresses, register address, register_count data bytes
+        I2C_Peripheral_CountTransaction(3 + register_count);
+        
+        // Write the register address without stop: the read follows with a restart
+        I2C_Master_MasterClearStatus();
+        uint8_t error = I2C_Master_MasterWriteBuf(device_address,
+                                                  &async_register_address,
+                                                  1,
+                                                  I2C_Master_MODE_NO_STOP);
+        if (error != I2C_Master_MSTR_NO_ERROR)
+        {
+            async_error = ERROR;
+            return ERROR;
+        }
+        
+        async_state = ASYNC_WRITING;
+        return NO_ERROR;
+    }
+    
+    
+    
+    uint8_t I2C_Peripheral_AsyncPoll(void)
+    {
+        uint8_t status;
+        
+        if (async_state == ASYNC_IDLE)
+        {
+            return 0;
+        }
+        
+        status = I2C_Master_MasterStatus();
+        
+        if (status & I2C_Master_MSTAT_ERR_XFER)
+        {
+            // Release the bus in case the engine stopped in halt state
+            I2C_Master_MasterSendStop();
+            I2C_Peripheral_AsyncComplete(ERROR);
+        }
+        else if (async_state == ASYNC_WRITING)
+        {
+            if (status & I2C_Master_MSTAT_WR_CMPLT)
+            {
+                // Register address sent: read data after a repeated start
+                I2C_Master_MasterClearStatus();
+                if (I2C_Master_MasterReadBuf(async_device_address,
+                                             async_data,
+                                             async_register_count,
+                                             I2C_Master_MODE_REPEAT_START) == I2C_Master_MSTR_NO_ERROR)
+                {
+                    async_state = ASYNC_READING;
+                }
+                else
+                {
+                    I2C_Master_MasterSendStop();
+                    I2C_Peripheral_AsyncComplete(ERROR);
+                }
+            }
+        }
+        else if (status & I2C_Master_MSTAT_RD_CMPLT)
+        {
+            // Last byte NAKed and stop condition generated by the component
+            I2C_Peripheral_AsyncComplete(NO_ERROR);
+        }
+        
+        return async_state != ASYNC_IDLE;
+    }
+    
+    
+    
+    void I2C_Peripheral_GetBusCounters(I2C_Peripheral_BusCounters* counters)
+    {
+        *counters = bus_counters;
+    }
+    
+    
+    
+    void I2C_Peripheral_ResetBusCounters(void)
+    {
+        bus_counters.transactions = 0;
+        bus_counters.bytes = 0;
+    }
+    
+    
+    
+    ErrorCode I2C_Peripheral_AsyncWait(void)
+    {
+        while (I2C_Peripheral_AsyncPoll());
+        
+        return async_error;
+    }
 
 /* [] END OF FILE */
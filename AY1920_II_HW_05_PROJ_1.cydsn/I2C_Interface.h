@@ -44,15 +44,17 @@
     *   \brief Read multiple bytes over I2C.
     *   
     *   This function performs a complete reading operation over I2C from multiple
-    *   registers.
+    *   registers. Long bursts (e.g. the whole LIS3DH FIFO, 192 bytes) are
+    *   read in a single transaction.
     *   \param device_address I2C address of the device to talk to.
     *   \param register_address Address of the first register to be read.
-    *   \param register_count Number of registers we want to read.
+    *   \param register_count Number of registers we want to read (all of them,
+    *          the first one included).
     *   \param data Pointer to an array where data will be saved.
     */
     ErrorCode I2C_Peripheral_ReadRegisterMulti(uint8_t device_address,
                                                 uint8_t register_address,
-                                                uint8_t register_count,
+                                                uint16_t register_count,
                                                 uint8_t* data);
     /** 
     *   \brief Write a byte over I2C.
@@ -71,10 +73,12 @@
     *   \brief Write multiple bytes over I2C.
     *   
     *   This function performs a complete writing operation over I2C to multiple
-    *   registers
+    *   registers: exactly register_count data bytes are sent after the
+    *   register address.
     *   \param device_address I2C address of the device to talk to.
     *   \param register_address Address of the first register to be written.
-    *   \param register_count Number of registers that need to be written.
+    *   \param register_count Number of registers that need to be written (all 
+    *          of them, the first one included).
     *   \param data Array of data to be written
     */
     ErrorCode I2C_Peripheral_WriteRegisterMulti(uint8_t device_address,
@@ -91,5 +95,75 @@
     */
     uint8_t I2C_Peripheral_IsDeviceConnected(uint8_t device_address);
     
+    /**
+    *   \brief Bus occupancy counters.
+    *
+    *   Every I2C_Peripheral_* call updates these counters so that the bus
+    *   load of different acquisition schemes can be compared.
+    */
+    typedef struct {
+        uint32_t transactions;  ///< Start conditions generated (restarts excluded)
+        uint32_t bytes;         ///< Bytes clocked on the bus, address bytes included
+    } I2C_Peripheral_BusCounters;
+    
+    /**
+    *   \brief Get the bus occupancy counters.
+    *
+    *   \param counters Pointer to a structure where the counters will be saved.
+    */
+    void I2C_Peripheral_GetBusCounters(I2C_Peripheral_BusCounters* counters);
+    
+    /**
+    *   \brief Reset the bus occupancy counters.
+    */
+    void I2C_Peripheral_ResetBusCounters(void);
+    
+    /**
+    *   \brief Callback invoked when an asynchronous transfer is over.
+    *
+    *   \param error NO_ERROR if the transfer completed, ERROR otherwise.
+    */
+    typedef void (*I2C_Peripheral_Callback)(ErrorCode error);
+    
+    /** 
+    *   \brief Start a non-blocking read of multiple bytes over I2C.
+    *   
+    *   This function only starts the reading operation from multiple registers:
+    *   the transfer is carried on by the interrupt-driven engine of the I2C 
+    *   component (MasterWriteBuf/MasterReadBuf), so the CPU is free to do other
+    *   work while the bus is busy. Completion is detected by calling
+    *   I2C_Peripheral_AsyncPoll() (or I2C_Peripheral_AsyncWait()).
+    *   No other I2C_Peripheral_* function can be used until the transfer is over.
+    *   \param device_address I2C address of the device to talk to.
+    *   \param register_address Address of the first register to be read.
+    *   \param register_count Number of registers we want to read (all of them, 
+    *          the first one included).
+    *   \param data Pointer to an array where data will be saved. It must stay 
+    *          valid until the transfer is over.
+    *   \param callback Function called at the end of the transfer (can be NULL).
+    */
+    ErrorCode I2C_Peripheral_ReadRegisterMultiAsync(uint8_t device_address,
+                                                    uint8_t register_address,
+                                                    uint8_t register_count,
+                                                    uint8_t* data,
+                                                    I2C_Peripheral_Callback callback);
+    
+    /**
+    *   \brief Advance the asynchronous transfer.
+    *
+    *   This function checks the status of the I2C component and moves the 
+    *   asynchronous transfer to its next phase. When the transfer is over the 
+    *   callback is called from here (and not from the interrupt context).
+    *   \retval Returns true (>0) while the transfer is still in progress.
+    */
+    uint8_t I2C_Peripheral_AsyncPoll(void);
+    
+    /**
+    *   \brief Wait for the end of the asynchronous transfer.
+    *
+    *   \retval Result of the last asynchronous transfer.
+    */
+    ErrorCode I2C_Peripheral_AsyncWait(void);
+    
 #endif // I2C_Interface_H
 /* [] END OF FILE */
@@ -0,0 +1,97 @@
+/**
+ * \file LIS3DH_Config.h
+ * \brief LIS3DH configuration registers shadow.
+ *
+ * The Temperature Sensor Configuration register and the Control registers
+ * 1-6 are adjacent (0x1F..0x25): a local copy of them, of the FIFO Control
+ * register and of the INT1 Configuration register is kept so that a
+ * register is written only when its value changes, read-modify-write
+ * operations do not need a bus read, and the whole configuration is checked
+ * with a single auto-increment burst instead of a read back per register.
+ * A configuration is described by a table of LIS3DH_Config_Entry: only the
+ * registers which change are written, adjacent ones in a single burst.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef LIS3DH_Config_H
+    #define LIS3DH_Config_H
+    
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+    
+    /**
+    *   \brief Entry of a configuration table: value of one register.
+    */
+    typedef struct {
+        uint8_t register_address;   ///< TEMP_CFG_REG, CTRL_REG1..6, FIFO_CTRL_REG or INT1_CFG
+        uint8_t value;              ///< Value the register must hold
+    } LIS3DH_Config_Entry;
+    
+    /**
+    *   \brief Load the shadow from the device.
+    *
+    *   This function reads LIS3DH_CONFIG_REG_COUNT registers starting from
+    *   LIS3DH_CONFIG_FIRST_REG in a single burst.
+    */
+    ErrorCode LIS3DH_Config_Load(void);
+    
+    /**
+    *   \brief Read a configuration register.
+    *
+    *   The value comes from the shadow. The device is read only if the
+    *   register is not known yet (e.g. LIS3DH_Config_Load() not called).
+    *   \param register_address Address of the register to be read.
+    *   \param data Pointer to a variable where the value will be saved.
+    */
+    ErrorCode LIS3DH_Config_Read(uint8_t register_address, uint8_t* data);
+    
+    /**
+    *   \brief Write a configuration register.
+    *
+    *   The write is skipped if the shadow already holds the same value.
+    *   Registers outside the shadow are always written.
+    *   \param register_address Address of the register to be written.
+    *   \param data Data to be written.
+    */
+    ErrorCode LIS3DH_Config_Write(uint8_t register_address, uint8_t data);
+    
+    /**
+    *   \brief Apply a configuration table.
+    *
+    *   The registers of the table which already hold their value are skipped.
+    *   The others are grouped in runs of adjacent registers, each one written
+    *   with a single WriteRegisterMulti burst: a run also covers up to 
+    *   two unchanged registers (rewritten with their known value), since this
+    *   costs fewer bus bytes than a new transaction. Hence 
+    *   registers changing together (e.g. the ODR in CTRL_REG1 and the full
+    *   scale in CTRL_REG4) reach the device in the same transaction. A table
+    *   holding only some of the registers applies a delta on the current
+    *   configuration. It must not be called while an asynchronous transfer
+    *   is in progress.
+    *   \param table Array of entries, in any order.
+    *   \param entry_count Number of entries of the table.
+    *   \retval ERROR if a register is not a configuration register or a 
+    *           burst fails (its registers are then read again when needed).
+    */
+    ErrorCode LIS3DH_Config_Apply(const LIS3DH_Config_Entry* table, uint8_t entry_count);
+    
+    /**
+    *   \brief Verify the whole configuration.
+    *
+    *   This function reads back the TEMP_CFG_REG..CTRL_REG6 block in a single
+    *   burst and compares it with the values written. The shadow is then
+    *   refreshed with the values read.
+    *   \param data Array of LIS3DH_CONFIG_REG_COUNT bytes where the values
+    *          read will be saved (register LIS3DH_CONFIG_FIRST_REG first).
+    *   \retval ERROR if the bus transfer fails or a register differs.
+    */
+    ErrorCode LIS3DH_Config_Verify(uint8_t* data);
+    
+    /**
+    *   \brief Number of writes skipped because the value did not change.
+    */
+    uint32_t LIS3DH_Config_GetSkippedWrites(void);
+
+#endif // LIS3DH_Config_H
+/* [] END OF FILE */
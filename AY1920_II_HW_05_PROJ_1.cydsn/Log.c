@@ -0,0 +1,120 @@
+/*
+* This file includes all the required source code to write
+* the diagnostic messages.
+*/
+
+#include "Log.h"
+#include "project.h"
+
+/**
+*   \brief Format of each message.
+*/
+#define LOG_FORMAT_STRING(id, arguments, format) format,
+
+static const char* const log_formats[LOG_MESSAGE_COUNT] = {LOG_MESSAGES(LOG_FORMAT_STRING)};
+
+    // Append a value in base 10 or 16, padded on the left up to 'width' characters
+    static uint8_t Log_Number(char* out, uint8_t room, uint32_t value, uint8_t base,
+                              const char* digits, char pad, uint8_t width)
+    {
+        char reversed[10];
+        uint8_t count = 0;
+        uint8_t length = 0;
+        
+        do
+        {
+            reversed[count++] = digits[value % base];
+            value /= base;
+        } while (value);
+        
+        for (; width > count && length < room; width--)
+        {
+            out[length++] = pad;
+        }
+        while (count && length < room)
+        {
+            out[length++] = reversed[--count];
+        }
+        return length;
+    }
+    
+    
+    
+    uint8_t Log_FormatList(uint8_t* record, uint8_t id, va_list arguments)
+    {
+        const char* format = log_formats[id];
+        char* out = (char*)record;
+        uint8_t length = 0;
+        
+        while (*format && length < LOG_RECORD_SIZE)
+        {
+            if (*format != '%')
+            {
+                out[length++] = *format++;
+                continue;
+            }
+            
+            // Conversion: optional 0 flag and width, then u, x or X
+            char pad = ' ';
+            uint8_t width = 0;
+            
+            format++;
+            if (*format == '0')
+            {
+                pad = '0';
+                format++;
+            }
+            while (*format >= '0' && *format <= '9')
+            {
+                width = 10 * width + (*format++ - '0');
+            }
+            if (*format == 'u')
+            {
+                length += Log_Number(&out[length], LOG_RECORD_SIZE - length, va_arg(arguments, unsigned int),
+                                     10, "0123456789", pad, width);
+            }
+            else if (*format == 'x' || *format == 'X')
+            {
+                length += Log_Number(&out[length], LOG_RECORD_SIZE - length, va_arg(arguments, unsigned int),
+                                     16, (*format == 'x') ? "0123456789abcdef" : "0123456789ABCDEF", pad, width);
+            }
+            else if (*format == '%')
+            {
+                out[length++] = '%';
+            }
+            if (*format)
+            {
+                format++;
+            }
+        }
+        return length;
+    }
+    
+    
+    
+    uint8_t Log_Format(uint8_t* record, uint8_t id, ...)
+    {
+        va_list arguments;
+        uint8_t length;
+        
+        va_start(arguments, id);
+        length = Log_FormatList(record, id, arguments);
+        va_end(arguments);
+        return length;
+    }
+    
+    
+    
+    void Log_Print(uint8_t id, ...)
+    {
+        uint8_t record[LOG_RECORD_SIZE];
+        va_list arguments;
+        uint8_t length;
+        
+        va_start(arguments, id);
+        length = Log_FormatList(record, id, arguments);
+        va_end(arguments);
+        UART_Debug_PutArray(record, length);
+    }
+
+/* [] END OF FILE */
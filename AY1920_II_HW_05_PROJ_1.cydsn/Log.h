@@ -0,0 +1,62 @@
+/**
+ * \file Log.h
+ * \brief Diagnostic messages without sprintf.
+ *
+ * A message is an ID of the table in LogMessages.h and its arguments
+ * (unsigned values of 32 bits at most), instead of a string built with
+ * sprintf into a buffer. Log_Format() writes the text of the message with
+ * a small formatter which knows %u, %x and %X only, so the printf family
+ * of the C library is not linked. This is the text format of the logger
+ * of PROJ_2 and PROJ_3: the temperature frames of this project have no
+ * packets to carry binary records.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef Log_H
+    #define Log_H
+    
+    #include "cytypes.h"
+    #include "stdarg.h"
+    #include "LogMessages.h"
+    
+    /**
+    *   \brief Maximum size of a record (a longer text is cut).
+    */
+    #define LOG_RECORD_SIZE 80
+    
+    /**
+    *   \brief IDs of the messages, in the order of the table.
+    */
+    #define LOG_ID(id, arguments, format) id,
+    
+    typedef enum {
+        LOG_MESSAGES(LOG_ID)
+        LOG_MESSAGE_COUNT
+    } Log_Message;
+    
+    /**
+    *   \brief Write the record of a message.
+    *
+    *   \param record Buffer of LOG_RECORD_SIZE bytes.
+    *   \param id Message (LOG_MESSAGES).
+    *   \param ... Arguments of the message, as many as in the table.
+    *   \retval Number of bytes of the record.
+    */
+    uint8_t Log_Format(uint8_t* record, uint8_t id, ...);
+    
+    /**
+    *   \brief Write the record of a message, arguments given as a va_list.
+    */
+    uint8_t Log_FormatList(uint8_t* record, uint8_t id, va_list arguments);
+    
+    /**
+    *   \brief Send a message over the UART at once (blocking).
+    *
+    *   \param id Message (LOG_MESSAGES).
+    *   \param ... Arguments of the message, as many as in the table.
+    */
+    void Log_Print(uint8_t id, ...);
+
+#endif // Log_H
+/* [] END OF FILE */
@@ -0,0 +1,35 @@
+/**
+ * \file LogMessages.h
+ * \brief Format table of the diagnostic messages (see Log.h).
+ *
+ * One X(id, arguments, format) entry per message: the ID is the position
+ * in the table, the arguments are unsigned values of 32 bits at most and
+ * the format takes one %u, %x or %X (with an optional 0 flag and width)
+ * per argument. New messages go at the end.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef LogMessages_H
+    #define LogMessages_H
+    
+    /**
+    *   \brief Messages of main.c, in the order they are sent.
+    */
+    #define LOG_MESSAGES(X) \
+        X(LOG_DEVICE,               1, "Device 0x%02X is connected\r\n") \
+        X(LOG_WHO_AM_I,             1, "WHO AM I REG: 0x%02X [Expected: 0x33]\r\n") \
+        X(LOG_WHO_AM_I_ERROR,       0, "Error occurred during I2C comm\r\n") \
+        X(LOG_STATUS_REG,           1, "STATUS REGISTER: 0x%02X\r\n") \
+        X(LOG_STATUS_REG_ERROR,     0, "Error occurred during I2C comm to read status register\r\n") \
+        X(LOG_CONFIG_LOAD_ERROR,    0, "Error occurred during I2C comm to read control registers\r\n") \
+        X(LOG_WRITING,              0, "\r\nWriting new values..\r\n") \
+        X(LOG_CONFIG_APPLY_ERROR,   0, "Error occurred during I2C comm to set control registers\r\n") \
+        X(LOG_CONFIG,               7, "TEMP_CFG, CTRL_REG1-6: %02X %02X %02X %02X %02X %02X %02X\r\n") \
+        X(LOG_CONFIG_VERIFY_ERROR,  0, "Error occurred during verification of control registers\r\n") \
+        X(LOG_CTRL_REG23,           2, "CONTROL REGISTER 2 and 3: 0x%02X\r\n and 0x%02X\r\n") \
+        X(LOG_CTRL_REG23_ERROR,     0, "Error occurred during I2C comm to read control register23\r\n") \
+        X(LOG_CTRL_REG23_UPDATED,   2, "CONTROL REGISTER 2 and 3 after being updated: 0x%02X\r\n and 0x%02X\r\n")
+
+#endif // LogMessages_H
+/* [] END OF FILE */
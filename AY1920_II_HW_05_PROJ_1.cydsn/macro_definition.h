@@ -25,15 +25,25 @@
     */
     #define LIS3DH_STATUS_REG 0x27
 
+    /**
+    *   \brief Address of the Status register of the auxiliary ADC and its
+    *   3DA bit (new temperature data, cleared by reading OUT_ADC_3H)
+    */
+    #define LIS3DH_STATUS_REG_AUX 0x07
+    #define LIS3DH_STATUS_REG_AUX_3DA 0x04
+
     /**
     *   \brief Address of the Control register 1
     */
     #define LIS3DH_CTRL_REG1 0x20
 
     /**
-    *   \brief Hex value to set normal mode to the accelerator
+    *   \brief Hex value to set normal mode to the accelerator (50 Hz, all the axes).
+    *    A host build may set it on the command line (see Host_Tools/Benchmark.c).
     */
-    #define LIS3DH_NORMAL_MODE_CTRL_REG1 0x47
+    #ifndef LIS3DH_NORMAL_MODE_CTRL_REG1
+        #define LIS3DH_NORMAL_MODE_CTRL_REG1 0x47
+    #endif
 
     /**
     *   \brief  Address of the Temperature Sensor Configuration register
@@ -47,7 +57,13 @@
     */
     #define LIS3DH_CTRL_REG4 0x23
 
-    #define LIS3DH_CTRL_REG4_BDU_ACTIVE 0x80
+    /**
+    *   \brief Block data update. A host build may set it on the command line,
+    *    with the HR bit (0x08) for the high resolution mode.
+    */
+    #ifndef LIS3DH_CTRL_REG4_BDU_ACTIVE
+        #define LIS3DH_CTRL_REG4_BDU_ACTIVE 0x80
+    #endif
 
     /**
     *   \brief Address of the ADC output LSB register
@@ -59,6 +75,26 @@
     */
     #define LIS3DH_OUT_ADC_3H 0x0D
     
+    /**
+    *   \brief Address of the other configuration registers (left at their
+    *    default value, except for the Control registers 2 and 3 written by
+    *    the MultiWrite test)
+    */
+    #define LIS3DH_CTRL_REG2 0x21
+    #define LIS3DH_CTRL_REG3 0x22
+    #define LIS3DH_CTRL_REG5 0x24
+    #define LIS3DH_CTRL_REG6 0x25
+    #define LIS3DH_FIFO_CTRL_REG 0x2E
+    #define LIS3DH_INT1_CFG 0x30
+    
+    /**
+    *   \brief Configuration registers kept in the shadow (see LIS3DH_Config.h):
+    *    the Temperature Sensor Configuration register and the Control registers
+    *    1-6 are adjacent (0x1F..0x25), so they are read back in a single burst.
+    */
+    #define LIS3DH_CONFIG_FIRST_REG LIS3DH_TEMP_CFG_REG
+    #define LIS3DH_CONFIG_REG_COUNT 7
+    
     /**
     *   \brief number of bytes to be sent definition
     */    
@@ -13,8 +13,9 @@
 
 // Include required header files
 #include "I2C_Interface.h"
+#include "LIS3DH_Config.h"
+#include "Log.h"
 #include "project.h"
-#include "stdio.h"
 #include "macro_definition.h"
 
 
@@ -27,9 +28,6 @@ int main(void)
     UART_Debug_Start();
     
     CyDelay(5); //"The boot procedure is complete about 5 milliseconds after device power-up."
-    
-    // String to print out messages on the UART
-    char message[50];
 
     // Check which devices are present on the I2C bus
     for (int i = 0 ; i < 128; i++)
@@ -37,8 +35,7 @@ int main(void)
         if (I2C_Peripheral_IsDeviceConnected(i))
         {
             // print out the address is hex format
-            sprintf(message, "Device 0x%02X is connected\r\n", i);
-            UART_Debug_PutString(message); 
+            Log_Print(LOG_DEVICE, i);
         }
         
     }
@@ -54,12 +51,11 @@ int main(void)
                                                   &who_am_i_reg);
     if (error == NO_ERROR)
     {
-        sprintf(message, "WHO AM I REG: 0x%02X [Expected: 0x33]\r\n", who_am_i_reg);
-        UART_Debug_PutString(message); 
+        Log_Print(LOG_WHO_AM_I, who_am_i_reg);
     }
     else
     {
-        UART_Debug_PutString("Error occurred during I2C comm\r\n");   
+        Log_Print(LOG_WHO_AM_I_ERROR);
     }
     
     /*      I2C Reading Status Register       */
@@ -71,30 +67,24 @@ int main(void)
     
     if (error == NO_ERROR)
     {
-        sprintf(message, "STATUS REGISTER: 0x%02X\r\n", status_register);
-        UART_Debug_PutString(message); 
+        Log_Print(LOG_STATUS_REG, status_register);
     }
     else
     {
-        UART_Debug_PutString("Error occurred during I2C comm to read status register\r\n");   
+        Log_Print(LOG_STATUS_REG_ERROR);
     }
     
     /******************************************/
-    /*        Read Control Register 1         */
+    /*    Load the configuration registers    */
     /******************************************/
-    uint8_t ctrl_reg1; 
-    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                        LIS3DH_CTRL_REG1,
-                                        &ctrl_reg1);
     
-    if (error == NO_ERROR)
-    {
-        sprintf(message, "CONTROL REGISTER 1: 0x%02X\r\n", ctrl_reg1);
-        UART_Debug_PutString(message); 
-    }
-    else
+    /* TEMP_CFG_REG and CTRL_REG1..CTRL_REG6 are read in a single burst: from 
+    now on a register is written only if its value has to change */
+    error = LIS3DH_Config_Load();
+    
+    if (error != NO_ERROR)
     {
-        UART_Debug_PutString("Error occurred during I2C comm to read control register 1\r\n");   
+        Log_Print(LOG_CONFIG_LOAD_ERROR);
     }
     
     /******************************************/
@@ -102,123 +92,44 @@ int main(void)
     /******************************************/
     
         
-    UART_Debug_PutString("\r\nWriting new values..\r\n");
+    Log_Print(LOG_WRITING);
     
-    if (ctrl_reg1 != LIS3DH_NORMAL_MODE_CTRL_REG1)
-    {
-        ctrl_reg1 = LIS3DH_NORMAL_MODE_CTRL_REG1;
+    /* Whole configuration of the accelerometer: only the registers which differ 
+    from the loaded values are written, adjacent ones in a single burst (see 
+    LIS3DH_Config.h) */
+    const LIS3DH_Config_Entry configuration[] = {
+        {LIS3DH_TEMP_CFG_REG,  LIS3DH_TEMP_CFG_REG_ACTIVE},
+        {LIS3DH_CTRL_REG1,     LIS3DH_NORMAL_MODE_CTRL_REG1},
+        {LIS3DH_CTRL_REG2,     0x00},
+        {LIS3DH_CTRL_REG3,     0x00},
+        {LIS3DH_CTRL_REG4,     LIS3DH_CTRL_REG4_BDU_ACTIVE},
+        {LIS3DH_CTRL_REG5,     0x00},
+        {LIS3DH_CTRL_REG6,     0x00},
+        {LIS3DH_FIFO_CTRL_REG, 0x00},
+        {LIS3DH_INT1_CFG,      0x00},
+    };
     
-        error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                             LIS3DH_CTRL_REG1,
-                                             ctrl_reg1);
+    error = LIS3DH_Config_Apply(configuration, sizeof(configuration) / sizeof(configuration[0]));
     
-        if (error == NO_ERROR)
-        {
-            sprintf(message, "CONTROL REGISTER 1 successfully written as: 0x%02X\r\n", ctrl_reg1);
-            UART_Debug_PutString(message); 
-        }
-        else
-        {
-            UART_Debug_PutString("Error occurred during I2C comm to set control register 1\r\n");   
-        }
+    if (error != NO_ERROR)
+    {
+        Log_Print(LOG_CONFIG_APPLY_ERROR);
     }
     
     /******************************************/
-    /*     Read Control Register 1 again      */
+    /*   Verify the whole configuration once  */
     /******************************************/
-
-    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                        LIS3DH_CTRL_REG1,
-                                        &ctrl_reg1);
-    
-    if (error == NO_ERROR)
-    {
-        sprintf(message, "CONTROL REGISTER 1 after overwrite operation: 0x%02X\r\n", ctrl_reg1);
-        UART_Debug_PutString(message); 
-    }
-    else
-    {
-        UART_Debug_PutString("Error occurred during I2C comm to read control register 1\r\n");   
-    }
-    
-     /******************************************/
-     /* I2C Reading Temperature sensor CFG reg */
-     /******************************************/
-
-    uint8_t tmp_cfg_reg;
-
-    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                        LIS3DH_TEMP_CFG_REG,
-                                        &tmp_cfg_reg);
-    
-    if (error == NO_ERROR)
-    {
-        sprintf(message, "TEMPERATURE CONFIG REGISTER: 0x%02X\r\n", tmp_cfg_reg);
-        UART_Debug_PutString(message); 
-    }
-    else
-    {
-        UART_Debug_PutString("Error occurred during I2C comm to read temperature config register\r\n");   
-    }
-    
-    
-    tmp_cfg_reg = LIS3DH_TEMP_CFG_REG_ACTIVE; // must be changed to the appropriate value
-    
-    error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                         LIS3DH_TEMP_CFG_REG,
-                                         tmp_cfg_reg);
-    
-    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                        LIS3DH_TEMP_CFG_REG,
-                                        &tmp_cfg_reg);
-    
-    
-    if (error == NO_ERROR)
-    {
-        sprintf(message, "TEMPERATURE CONFIG REGISTER after being updated: 0x%02X\r\n", tmp_cfg_reg);
-        UART_Debug_PutString(message); 
-    }
-    else
-    {
-        UART_Debug_PutString("Error occurred during I2C comm to read temperature config register\r\n");   
-    }
-    
-    uint8_t ctrl_reg4;
-
-    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                        LIS3DH_CTRL_REG4,
-                                        &ctrl_reg4);
-    
-    if (error == NO_ERROR)
-    {
-        sprintf(message, "CONTROL REGISTER 4: 0x%02X\r\n", ctrl_reg4);
-        UART_Debug_PutString(message); 
-    }
-    else
-    {
-        UART_Debug_PutString("Error occurred during I2C comm to read control register4\r\n");   
-    }
-    
-    
-    ctrl_reg4 = LIS3DH_CTRL_REG4_BDU_ACTIVE; // must be changed to the appropriate value
-    
-    error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                         LIS3DH_CTRL_REG4,
-                                         ctrl_reg4);
-    
-    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                        LIS3DH_CTRL_REG4,
-                                        &ctrl_reg4);
     
+    uint8_t config[LIS3DH_CONFIG_REG_COUNT]; //TEMP_CFG_REG (config[0]) and CTRL_REG1..CTRL_REG6
+    error = LIS3DH_Config_Verify(&config[0]);
     
     if (error == NO_ERROR)
     {
-        sprintf(message, "CONTROL REGISTER 4 after being updated: 0x%02X\r\n", ctrl_reg4);
-        UART_Debug_PutString(message); 
+        Log_Print(LOG_CONFIG, config[0], config[1], config[2], config[3], config[4], config[5], config[6]);
     }
     else
     {
-        UART_Debug_PutString("Error occurred during I2C comm to read control register4\r\n");   
+        Log_Print(LOG_CONFIG_VERIFY_ERROR);
     }
     
      /******************************************/
@@ -227,43 +138,42 @@ int main(void)
     uint8_t ctrl_reg23 [2];
     
     error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
-                                        0x21,
+                                        LIS3DH_CTRL_REG2,
                                         2,
                                         &ctrl_reg23[0]);
     
     if (error == NO_ERROR)
     {
-        sprintf(message, "CONTROL REGISTER 2 and 3: 0x%02X\r\n and 0x%02X\r\n", ctrl_reg23 [0],ctrl_reg23 [1] );
-        UART_Debug_PutString(message); 
+        Log_Print(LOG_CTRL_REG23, ctrl_reg23[0], ctrl_reg23[1]);
     }
     else
     {
-        UART_Debug_PutString("Error occurred during I2C comm to read control register23\r\n");   
+        Log_Print(LOG_CTRL_REG23_ERROR);
     }
     
     
-    ctrl_reg23[0] = 0x50; // must be changed to the appropriate value
-    ctrl_reg23[1] = 0x51;
+    /* Delta on the current configuration: the two adjacent registers are written 
+    with a single WriteRegisterMulti burst of exactly 2 data bytes */
+    const LIS3DH_Config_Entry ctrl_reg23_delta[] = {
+        {LIS3DH_CTRL_REG2, 0x50}, // must be changed to the appropriate value
+        {LIS3DH_CTRL_REG3, 0x51},
+    };
     
-    error = I2C_Peripheral_WriteRegisterMulti(LIS3DH_DEVICE_ADDRESS,
-                                         0x21,
-                                         1,
-                                         &ctrl_reg23[0]);
+    error = LIS3DH_Config_Apply(ctrl_reg23_delta, 2);
     
     error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
-                                        0x21,
-                                        1,
+                                        LIS3DH_CTRL_REG2,
+                                        2,
                                         &ctrl_reg23[0]);
     
     
     if (error == NO_ERROR)
     {
-        sprintf(message, "CONTROL REGISTER 2 and 3 after being updated: 0x%02X\r\n and 0x%02X\r\n", ctrl_reg23 [0],ctrl_reg23 [1]);
-        UART_Debug_PutString(message); 
+        Log_Print(LOG_CTRL_REG23_UPDATED, ctrl_reg23[0], ctrl_reg23[1]);
     }
     else
     {
-        UART_Debug_PutString("Error occurred during I2C comm to read control register23\r\n");   
+        Log_Print(LOG_CTRL_REG23_ERROR);
     }
     
      /******************************************/
@@ -275,7 +185,8 @@ int main(void)
     uint8_t footer = 0xC0;
     uint8_t OutArray[TRANSMIT_BUFFER_SIZE]; //Array of dimension 'TRANSMIT_BUFFER_SIZE' containing all the axis information
     uint8_t TemperatureData[2]; //Array storing the info read from the 2 adjacent registers
-    uint8_t register_count = 1; //Number of registers to be read in sequence (exlcuding the one we start from)
+    uint8_t StatusAux; //Status register of the auxiliary ADC
+    uint8_t register_count = 2; //Number of registers to be read in sequence (the one we start from included)
     
     /* Setup header and tail */
     OutArray[0] = header;//Header
@@ -289,17 +200,25 @@ int main(void)
         /*    Read Auxiliary ADC register with ReadRegisterMulti function   */
         /********************************************************************/
         
-        error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
-                                            LIS3DH_OUT_ADC_3L,
-                                            register_count,
-                                            &TemperatureData[0]);
+        /* Only a new temperature is sent: below 10 Hz the same one would be read twice */
+        error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
+                                            LIS3DH_STATUS_REG_AUX,
+                                            &StatusAux);
         
-        if(error == NO_ERROR)
+        if(error == NO_ERROR && (StatusAux & LIS3DH_STATUS_REG_AUX_3DA))
         {
-            OutTemp = (int16)((TemperatureData[0] | (TemperatureData[1]<<8)))>>6; //Right justified 16bit integer
-            OutArray[1] = (uint8_t)(OutTemp & 0xFF); //LSB of temperature sensor data
-            OutArray[2] = (uint8_t)(OutTemp >> 8); //MSB of temperature sensor data
-            UART_Debug_PutArray(OutArray, TRANSMIT_BUFFER_SIZE); //Send information through UART communication protocol
+            error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
+                                                LIS3DH_OUT_ADC_3L,
+                                                register_count,
+                                                &TemperatureData[0]);
+            
+            if(error == NO_ERROR)
+            {
+                OutTemp = (int16)((TemperatureData[0] | (TemperatureData[1]<<8)))>>6; //Right justified 16bit integer
+                OutArray[1] = (uint8_t)(OutTemp & 0xFF); //LSB of temperature sensor data
+                OutArray[2] = (uint8_t)(OutTemp >> 8); //MSB of temperature sensor data
+                UART_Debug_PutArray(OutArray, TRANSMIT_BUFFER_SIZE); //Send information through UART communication protocol
+            }
         }
     }
 }
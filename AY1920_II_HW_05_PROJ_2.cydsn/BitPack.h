@@ -0,0 +1,57 @@
+/**
+ * \file BitPack.h
+ * \brief Samples packed at their native resolution (FRAME_FORMAT_PACKED).
+ *
+ * Each axis is sent with the number of bits of the acquisition profile
+ * (12 in high resolution, 10 in normal and 8 in low power mode), two's
+ * complement, one after the other with no padding: 36, 30 or 24 bits per
+ * sample instead of 48 (int16) or 96 (float). The bits are written LSB
+ * first, the enabled axes (X, Y, Z) of the first sample then of the next
+ * ones; the last byte of the packet is completed with zeros. Every packet
+ * carries the sensitivity and the resolution, hence the host gets exactly
+ * the values of the other formats.
+ *
+ * Packet (see Packet.h), before COBS encoding:
+ *   sequence (2)  count | PACKET_PACKED  axes  sensitivity in mg/digit
+ *   bits per axis  packed samples (ceil(count * axis count * bits / 8))
+ *   CRC16 (2)
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef BitPack_H
+    #define BitPack_H
+    
+    #include "cytypes.h"
+    
+    /**
+    *   \brief Write the header of a packet.
+    *
+    *   \param frame Frame buffer.
+    *   \param sequence Index of the first sample of the packet.
+    *   \param sample_count Number of samples of the packet.
+    *   \param axes Axes of the samples.
+    *   \retval Position of the first sample in the frame.
+    */
+    uint8_t* BitPack_Start(uint8_t* frame, uint16_t sequence, uint8_t sample_count, uint8_t axes);
+    
+    /**
+    *   \brief Pack a sample.
+    *
+    *   \param out Position of the sample in the frame.
+    *   \param data Output registers of the three axes (6 bytes, X first).
+    *   \param axes Axes to be packed, the same given to BitPack_Start().
+    *   \retval Position of the next byte to be written.
+    */
+    uint8_t* BitPack_Encode(uint8_t* out, const uint8_t* data, uint8_t axes);
+    
+    /**
+    *   \brief Write the bits left after the last sample of the packet.
+    *
+    *   \param out Position of the next byte to be written.
+    *   \retval End of the samples.
+    */
+    uint8_t* BitPack_Finish(uint8_t* out);
+
+#endif // BitPack_H
+/* [] END OF FILE */
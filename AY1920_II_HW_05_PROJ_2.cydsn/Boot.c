@@ -0,0 +1,207 @@
+/*
+* This file includes all the required source code to start
+* the acquisition quickly.
+*/
+
+#include "Boot.h"
+#include "CycleCounter.h"
+#include "I2C_Interface.h"
+#include "TxQueue.h"
+#include "macro_definition.h"
+#include "project.h"
+#include "string.h"
+
+/**
+*   \brief Addresses probed by the bus scan (the others are reserved by the
+*   I2C specification).
+*/
+#define BOOT_FIRST_ADDRESS 0x08
+#define BOOT_LAST_ADDRESS 0x77
+
+/**
+*   \brief Marks the known addresses as written by a previous scan (the RAM
+*   holds random values after a power cycle).
+*/
+#define BOOT_KNOWN_MAGIC 0xB007CA5Eu
+
+/**
+*   \brief Polls of the WHO AM I register before giving up.
+*/
+#define BOOT_WHO_AM_I_POLLS (BOOT_TIMEOUT_US / BOOT_POLL_INTERVAL_US)
+
+/**
+*   \brief Room kept at the end of the log for the boot times and the log
+*   instrumentation (three records).
+*/
+#define BOOT_TIMES_SIZE (3 * LOG_RECORD_SIZE)
+
+/**
+*   \brief CPU cycles per microsecond (the CPU runs at the bus clock).
+*/
+#define BOOT_CYCLES_PER_US (BCLK__BUS_CLK__HZ / 1000000)
+
+#if (BOOT_LOG_SIZE < BOOT_TIMES_SIZE + 2 * LOG_RECORD_SIZE)
+    #error "BOOT_LOG_SIZE too small (min 480)"
+#endif
+
+// Devices found by the last scan, a bit per address: not cleared at reset
+CY_NOINIT static uint32_t known_magic;
+CY_NOINIT static uint8_t known_addresses[16];
+
+static uint32_t boot_start;             // Cycle counter at Boot_Start()
+static Boot_Stats boot_stats = {0, 0, 0, 0, 0};
+static uint8_t first_sample = 0;        // First sample already recorded
+static uint8_t boot_log[BOOT_LOG_SIZE]; // Messages waiting for the first sample
+static uint16_t boot_log_length = 0;
+
+    // Keep the record of a message in the log (whole records up to 'limit' bytes) or send it at once
+    static void Boot_Write(uint8_t keep, uint16_t limit, uint8_t id, va_list arguments)
+    {
+        uint8_t record[LOG_RECORD_SIZE];
+        uint8_t length = Log_FormatList(record, id, arguments);
+        
+        if (!keep)
+        {
+            UART_Debug_PutArray(record, length);
+        }
+        else if (boot_log_length + length <= limit)
+        {
+            memcpy(&boot_log[boot_log_length], record, length);
+            boot_log_length += length;
+        }
+    }
+    
+    
+    
+    // Keep the record of a message in the room of the boot times
+    static void Boot_WriteTimes(uint8_t id, ...)
+    {
+        va_list arguments;
+        
+        va_start(arguments, id);
+        Boot_Write(1, BOOT_LOG_SIZE, id, arguments);
+        va_end(arguments);
+    }
+    
+    
+    
+    void Boot_Start(void)
+    {
+        CycleCounter_Start();
+        boot_start = CycleCounter_Get();
+    }
+    
+    
+    
+    ErrorCode Boot_WaitDevice(uint8_t* who_am_i)
+    {
+        ErrorCode error = ERROR;
+        uint16_t polls;
+        
+        *who_am_i = 0;
+        
+        // The device answers as soon as its boot is over (at most about 5 ms after power-up)
+        for (polls = 1; ; polls++)
+        {
+            if (I2C_Peripheral_IsDeviceConnected(LIS3DH_DEVICE_ADDRESS) &&
+                I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
+                                            LIS3DH_WHO_AM_I_REG_ADDR,
+                                            who_am_i) == NO_ERROR &&
+                *who_am_i == LIS3DH_WHO_AM_I_VALUE)
+            {
+                error = NO_ERROR;
+                break;
+            }
+            if (polls >= BOOT_WHO_AM_I_POLLS)
+            {
+                break;
+            }
+            CyDelayUs(BOOT_POLL_INTERVAL_US);
+        }
+        
+        boot_stats.who_am_i_polls = polls;
+        boot_stats.ready_cycles = CycleCounter_Get() - boot_start;
+        return error;
+    }
+    
+    
+    
+    void Boot_Scan(void)
+    {
+        uint8_t found[sizeof(known_addresses)];
+#if (BOOT_SCAN == BOOT_SCAN_KNOWN)
+        uint8_t known = (known_magic == BOOT_KNOWN_MAGIC);
+#endif
+
+        memset(found, 0, sizeof(found));
+        
+        for (uint8_t address = BOOT_FIRST_ADDRESS; address <= BOOT_LAST_ADDRESS; address++)
+        {
+#if (BOOT_SCAN == BOOT_SCAN_KNOWN)
+            // The accelerometer and the devices found by the previous scan only
+            if (address != LIS3DH_DEVICE_ADDRESS &&
+                !(known && (known_addresses[address >> 3] & (1 << (address & 7)))))
+            {
+                continue;
+            }
+#endif
+            boot_stats.probes++;
+            if (I2C_Peripheral_IsDeviceConnected(address))
+            {
+                found[address >> 3] |= 1 << (address & 7);
+                boot_stats.devices++;
+                
+                // print out the address in hex format
+                Boot_Log(LOG_DEVICE, address);
+            }
+        }
+        
+        // Remembered for the next boot (a device which does not answer is forgotten)
+        memcpy(known_addresses, found, sizeof(found));
+        known_magic = BOOT_KNOWN_MAGIC;
+    }
+    
+    
+    
+    void Boot_Log(uint8_t id, ...)
+    {
+        va_list arguments;
+        
+        va_start(arguments, id);
+        Boot_Write(BOOT_DEFERRED_MESSAGES, BOOT_LOG_SIZE - BOOT_TIMES_SIZE, id, arguments);
+        va_end(arguments);
+    }
+    
+    
+    
+    void Boot_FirstSample(uint8_t sample_count)
+    {
+        Log_Stats log;
+        
+        if (first_sample || sample_count == 0)
+        {
+            return;
+        }
+        first_sample = 1;
+        boot_stats.first_sample_cycles = CycleCounter_Get() - boot_start;
+        
+        // The loop is running: the times go after the messages, between the frames
+        Boot_WriteTimes(LOG_BOOT_TIMES, boot_stats.ready_cycles / BOOT_CYCLES_PER_US,
+                        boot_stats.who_am_i_polls, boot_stats.first_sample_cycles / BOOT_CYCLES_PER_US);
+        Boot_WriteTimes(LOG_BOOT_SCAN, boot_stats.probes, boot_stats.devices);
+        
+        // Cost of the boot messages (this one excluded)
+        Log_GetStats(&log);
+        Boot_WriteTimes(LOG_LOG_STATS, log.records, log.bytes, log.records ? log.cycles / log.records : 0);
+        
+        TxQueue_SetText(boot_log, boot_log_length);
+    }
+    
+    
+    
+    void Boot_GetStats(Boot_Stats* stats)
+    {
+        *stats = boot_stats;
+    }
+
+/* [] END OF FILE */
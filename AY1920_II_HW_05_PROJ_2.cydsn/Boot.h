@@ -0,0 +1,95 @@
+/**
+ * \file Boot.h
+ * \brief Fast start of the acquisition.
+ *
+ * The time from reset to the first sample is spent waiting and printing:
+ * a fixed 5 ms delay for the LIS3DH boot, a probe of all the 128 I2C
+ * addresses and a dozen sprintf'd lines pushed out at 9600 bps before the
+ * loop starts. Here:
+ *   - the WHO AM I register is polled until the LIS3DH answers, instead
+ *     of waiting the worst case boot time;
+ *   - the bus scan probes only LIS3DH_DEVICE_ADDRESS and the addresses
+ *     found by the previous scan (BOOT_SCAN_KNOWN), kept in a RAM area
+ *     which is not cleared at reset; the probe of all the addresses,
+ *     reserved ones (0x00-0x07, 0x78-0x7F) excluded, is BOOT_SCAN_FULL;
+ *   - with BOOT_DEFERRED_MESSAGES the messages are kept in RAM and sent
+ *     after the first sample, in the idle time of the link (see
+ *     TxQueue_SetText()).
+ * The times of the device answer and of the first sample are measured
+ * with the cycle counter from Boot_Start() and sent after the messages,
+ * with the CPU cycles spent on average to write each of them (see
+ * Log_GetStats()).
+ * With USE_INT1 or USE_POLL_TIMER the sleep before the first sample is
+ * not counted (the cycle counter stops while the CPU sleeps).
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef Boot_H
+    #define Boot_H
+    
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+    #include "Log.h"
+    
+    /**
+    *   \brief Boot instrumentation, in CPU cycles from Boot_Start().
+    */
+    typedef struct {
+        uint32_t ready_cycles;          ///< WHO AM I answered
+        uint32_t first_sample_cycles;   ///< First sample read (0 until then)
+        uint16_t who_am_i_polls;        ///< Polls of the WHO AM I register
+        uint8_t probes;                 ///< Addresses probed by the bus scan
+        uint8_t devices;                ///< Devices found by the bus scan
+    } Boot_Stats;
+    
+    /**
+    *   \brief Start the cycle counter: time 0 of the boot instrumentation.
+    */
+    void Boot_Start(void);
+    
+    /**
+    *   \brief Wait until the LIS3DH answers.
+    *
+    *   This function polls the WHO AM I register every BOOT_POLL_INTERVAL_US
+    *   until it reads LIS3DH_WHO_AM_I_VALUE, for BOOT_TIMEOUT_US at most.
+    *   \param who_am_i Pointer to a variable where the last value read will
+    *          be saved.
+    *   \retval ERROR if the device did not answer in time.
+    */
+    ErrorCode Boot_WaitDevice(uint8_t* who_am_i);
+    
+    /**
+    *   \brief Probe the I2C addresses of BOOT_SCAN and print the devices found.
+    */
+    void Boot_Scan(void);
+    
+    /**
+    *   \brief Print a boot message (see Log.h).
+    *
+    *   With BOOT_DEFERRED_MESSAGES the message is kept until the first
+    *   sample (BOOT_LOG_SIZE bytes at most, the messages which do not fit
+    *   are dropped), otherwise it is sent at once.
+    *   \param id Message (LOG_MESSAGES).
+    *   \param ... Arguments of the message.
+    */
+    void Boot_Log(uint8_t id, ...);
+    
+    /**
+    *   \brief Record the first sample and release the boot messages.
+    *
+    *   Called once per iteration of the acquisition loop: it does nothing
+    *   after the first sample.
+    *   \param sample_count Number of samples read in this iteration.
+    */
+    void Boot_FirstSample(uint8_t sample_count);
+    
+    /**
+    *   \brief Get the boot instrumentation.
+    *
+    *   \param stats Pointer to a structure where the statistics will be saved.
+    */
+    void Boot_GetStats(Boot_Stats* stats);
+
+#endif // Boot_H
+/* [] END OF FILE */
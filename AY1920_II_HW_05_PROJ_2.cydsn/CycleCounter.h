@@ -0,0 +1,70 @@
+/** 
+ * \file CycleCounter.h
+ * \brief Cortex-M3 cycle counter.
+ *
+ * Access to the DWT cycle counter (CYCCNT) of the Cortex-M3 core. It counts
+ * CPU clock cycles and stops while the CPU sleeps. In a host build
+ * (HOST_BUILD, see Host_Tools/Sim) it reads the simulated clock instead.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef CycleCounter_H
+    #define CycleCounter_H
+    
+    #include "cytypes.h"
+    
+#if defined(HOST_BUILD)
+    /**
+    *   \brief Cycles of the simulated CPU clock (provided by the host program).
+    */
+    uint32_t HostClock_Cycles(void);
+    
+    static inline void CycleCounter_Start(void)
+    {
+    }
+    
+    static inline uint32_t CycleCounter_Get(void)
+    {
+        return HostClock_Cycles();
+    }
+#else
+    /**
+    *   \brief Debug Exception and Monitor Control register (TRCENA bit 24)
+    */
+    #define CYCLE_COUNTER_DEMCR_REG (*(reg32 *) 0xE000EDFCu)
+    #define CYCLE_COUNTER_DEMCR_TRCENA 0x01000000u
+    
+    /**
+    *   \brief DWT Control register (CYCCNTENA bit 0) and cycle counter
+    */
+    #define CYCLE_COUNTER_DWT_CTRL_REG (*(reg32 *) 0xE0001000u)
+    #define CYCLE_COUNTER_DWT_CTRL_CYCCNTENA 0x00000001u
+    #define CYCLE_COUNTER_DWT_CYCCNT_REG (*(reg32 *) 0xE0001004u)
+    
+    /**
+    *   \brief Enable the cycle counter.
+    *
+    *   The count is not reset: the modules which start it (boot, INT1,
+    *   telemetry, profiler) only use differences, which stay correct.
+    */
+    static inline void CycleCounter_Start(void)
+    {
+        CYCLE_COUNTER_DEMCR_REG |= CYCLE_COUNTER_DEMCR_TRCENA;
+        CYCLE_COUNTER_DWT_CTRL_REG |= CYCLE_COUNTER_DWT_CTRL_CYCCNTENA;
+    }
+    
+    /**
+    *   \brief Read the cycle counter.
+    *
+    *   Differences between two readings are correct across the wrap-around
+    *   as long as they are computed with uint32_t arithmetic.
+    */
+    static inline uint32_t CycleCounter_Get(void)
+    {
+        return CYCLE_COUNTER_DWT_CYCCNT_REG;
+    }
+#endif
+    
+#endif // CycleCounter_H
+/* [] END OF FILE */
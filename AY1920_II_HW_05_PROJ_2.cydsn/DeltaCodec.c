@@ -0,0 +1,74 @@
+/*
+* This file includes all the required source code to 
+* compress the samples sent in FRAME_FORMAT_DELTA.
+*/
+
+#include "DeltaCodec.h"
+#include "Packet.h"
+#include "Conversion.h"
+#include "macro_definition.h"
+
+static int16_t previous[3];             // Last sample encoded (the reference of the next one)
+static uint8_t packets_to_keyframe = 0;
+static uint16_t next_sequence = 0;      // Sequence number following the last packet
+static uint8_t previous_axes = 0;       // Axes of the last packet
+
+    uint8_t* DeltaCodec_Start(uint8_t* frame, uint16_t sequence, uint8_t sample_count, uint8_t axes)
+    {
+        uint8_t* out = &frame[PACKET_HEADER_SIZE];
+        
+        // After dropped samples the host sees a gap: it needs a keyframe, as after a lost packet.
+        // So it does when the axes change: each value is relative to the same axis.
+        if (packets_to_keyframe == 0 || sequence != next_sequence || axes != previous_axes)
+        {
+            // Keyframe: the first sample is its own difference from zero
+            previous[0] = 0;
+            previous[1] = 0;
+            previous[2] = 0;
+            packets_to_keyframe = DELTA_KEYFRAME_PACKETS;
+            
+            Packet_Start(frame, sequence, sample_count | PACKET_DELTA | PACKET_KEYFRAME, axes);
+            *out++ = LIS3DH_PROFILE_SENSITIVITY_MG;
+        }
+        else
+        {
+            Packet_Start(frame, sequence, sample_count | PACKET_DELTA, axes);
+        }
+        packets_to_keyframe--;
+        next_sequence = sequence + sample_count;
+        previous_axes = axes;
+        
+        return out;
+    }
+    
+    
+    
+    uint8_t* DeltaCodec_Encode(uint8_t* out, const uint8_t* data, uint8_t axes)
+    {
+        uint8_t axis;
+        
+        for (axis = 0; axis < 3; axis++)
+        {
+            if (!(axes & (1 << axis)))
+            {
+                continue;
+            }
+            
+            int16_t value = Conversion_Raw(&data[2 * axis]);
+            int32_t delta = (int32_t)value - previous[axis];
+            uint32_t code = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);   // Zigzag: small magnitudes, small codes
+            
+            previous[axis] = value;
+            
+            while (code >= 0x80)
+            {
+                *out++ = (uint8_t)code | 0x80;
+                code >>= 7;
+            }
+            *out++ = (uint8_t)code;
+        }
+        
+        return out;
+    }
+
+/* [] END OF FILE */
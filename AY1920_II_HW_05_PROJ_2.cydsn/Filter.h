@@ -0,0 +1,81 @@
+/**
+ * \file Filter.h
+ * \brief Cascaded biquad filters of the samples, one chain per axis (USE_FILTER).
+ *
+ * Each axis has its own chain of second order sections (low pass, high
+ * pass or band pass), up to FILTER_MAX_SECTIONS, or none: the table of
+ * FilterCoefficients.h is written by Host_Tools/FilterDesign for the rate
+ * of the samples sent (ACC_ODR, or DECIMATION_OUTPUT_ODR_HZ, see
+ * Decimator.h). The samples of a read (one, or the whole FIFO burst, after
+ * the decimator) are filtered between the read and the frame, in place
+ * in the read buffer, so that every frame format sends the filtered values
+ * exactly as it sends the raw ones.
+ * The Cortex-M3 has no FPU: the coefficients are Q2.30 numbers, the samples
+ * and the states of the sections Q16.16 digits (16 bits of headroom over
+ * 12-bit samples, 16 fractional bits), the products are summed in 64 bits
+ * (SMULL, SMLAL) and rounded once per section. Direct form I: the states
+ * are the last inputs and outputs of the section, in the same format.
+ * The output is rounded to whole digits and saturated to the resolution
+ * of the profile.
+ * The state of a chain runs across the reads and the dropped frames (the
+ * samples dropped by the transmit ring are filtered too).
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef Filter_H
+    #define Filter_H
+    
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+    
+    /**
+    *   \brief Fractional bits of the coefficients (Q2.30: -2 to 2).
+    */
+    #define FILTER_COEFFICIENT_BITS 30
+    
+    /**
+    *   \brief Second order section:
+    *          y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+    *
+    *   The feedback coefficients are the ones of the transfer function with
+    *   their sign changed: the section is all multiply-accumulates.
+    */
+    typedef struct {
+        int32_t b0;                 ///< Feed-forward coefficients, Q2.30
+        int32_t b1;
+        int32_t b2;
+        int32_t a1;                 ///< Feedback coefficients (negated), Q2.30
+        int32_t a2;
+    } Filter_Section;
+    
+    /**
+    *   \brief Chain of an axis: the sections in the order they are applied.
+    */
+    typedef struct {
+        uint8_t sections;           ///< 0: the axis is not filtered
+        const Filter_Section* section;
+    } Filter_Chain;
+    
+    /**
+    *   \brief Set the chains and clear their states.
+    *
+    *   \param chains Chains of X, Y and Z, or NULL for the table of
+    *          FilterCoefficients.h. Kept by reference, not copied.
+    *   \retval ERROR if a chain has more than FILTER_MAX_SECTIONS sections
+    *           (the chains are not changed), NO_ERROR otherwise.
+    */
+    ErrorCode Filter_Start(const Filter_Chain* chains);
+    
+    /**
+    *   \brief Filter the samples of a read, in place.
+    *
+    *   \param samples Output registers of the samples (LIS3DH_SAMPLE_SIZE
+    *          bytes each, X first), left-justified as read.
+    *   \param sample_count Number of samples.
+    *   \param axes Axes to be filtered (the enabled ones, see LIS3DH_GetAxes()).
+    */
+    void Filter_Process(uint8_t* samples, uint8_t sample_count, uint8_t axes);
+
+#endif // Filter_H
+/* [] END OF FILE */
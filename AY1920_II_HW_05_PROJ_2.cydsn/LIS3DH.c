@@ -0,0 +1,204 @@
+/*
+* This file includes all the required source code to acquire
+* samples from the LIS3DH accelerometer.
+*/
+
+#include "LIS3DH.h"
+#include "LIS3DH_Config.h"
+#include "LIS3DH_Profile.h"
+#include "string.h"
+
+static uint8_t axis_mask = ACC_AXES;                // Axes enabled in the Control register 1
+static uint8_t burst_first = LIS3DH_STATUS_REG;     // First register of the sample burst
+static uint8_t burst_size = LIS3DH_SAMPLE_BURST_SIZE;
+static uint32_t overruns = 0;                       // Samples lost (overwritten or torn)
+#if (!USE_INT1)
+static uint8_t last_sample[LIS3DH_SAMPLE_SIZE];     // Data bytes of the last accepted sample
+#endif
+
+    ErrorCode LIS3DH_ReadSampleAsync(uint8_t* burst)
+    {
+#if (USE_INT1)
+        /* INT1 (data ready) replaces ZYXDA: the burst starts at the first 
+        enabled axis, in low power mode at its high byte (8-bit data) */
+        burst[0] = (1 << ZYXDA);
+#endif
+        /* STATUS_REG and OUT_X_L..OUT_Z_H are adjacent: one auto-increment 
+        burst. The registers keep their place in the burst (burst[1] is 
+        OUT_X_L), the others are not read */
+        return I2C_Peripheral_ReadRegisterMultiAsync(LIS3DH_DEVICE_ADDRESS,
+                                                     burst_first,
+                                                     burst_size,
+                                                     &burst[burst_first - LIS3DH_STATUS_REG],
+                                                     NULL);
+    }
+    
+    
+    
+    ErrorCode LIS3DH_SetAxes(uint8_t axes)
+    {
+        uint8_t ctrl_reg1;
+        uint8_t last_axis;
+        
+        axes &= LIS3DH_CTRL_REG1_AXES;
+        if (axes == 0)
+        {
+            return ERROR;
+        }
+        
+        // Keep the data rate and the LPen bit (no bus read if shadowed, no write if unchanged)
+        ErrorCode error = LIS3DH_Config_Read(LIS3DH_CTRL_REG1, &ctrl_reg1);
+        if (error == NO_ERROR)
+        {
+            error = LIS3DH_Config_Write(LIS3DH_CTRL_REG1,
+                                        (ctrl_reg1 & ~LIS3DH_CTRL_REG1_AXES) | axes);
+        }
+        if (error == NO_ERROR)
+        {
+            axis_mask = axes;
+            last_axis = (axes & ACC_AXIS_Z) ? 2 : (axes & ACC_AXIS_Y) ? 1 : 0;
+            
+            // From the Status register (or the first enabled axis) up to OUT_H of the last enabled axis
+#if (USE_INT1)
+            uint8_t first_axis = (axes & ACC_AXIS_X) ? 0 : (axes & ACC_AXIS_Y) ? 1 : 2;
+            
+            burst_first = LIS3DH_OUT_X_L + 2 * first_axis + LIS3DH_PROFILE_HIGH_BYTES;
+#else
+            burst_first = LIS3DH_STATUS_REG;
+#endif
+            burst_size = LIS3DH_OUT_X_L + 2 * last_axis + 2 - burst_first;
+        }
+        return error;
+    }
+    
+    
+    
+    uint8_t LIS3DH_GetAxes(void)
+    {
+        return axis_mask;
+    }
+    
+    
+    
+    uint8_t LIS3DH_IsNewSample(const uint8_t* burst)
+    {
+#if (USE_INT1)
+        return (burst[0] & (1 << ZYXDA)) != 0;
+#else
+        uint8_t data_size = burst_size - 1; // The burst starts at the Status register
+        
+        /* XDA, YDA, ZDA (bits 0-2) stand for ZYXDA when not all axes are 
+        enabled. The data read clears them: a sample updated between the
+        status byte and OUT_X_L would be lost, so changed data is new too 
+        (BDU holds the output registers from the first data byte to the 
+        last one, the burst never mixes two samples) */
+        if (!(burst[0] & ((1 << ZYXDA) | axis_mask)) && !memcmp(&burst[1], last_sample, data_size))
+        {
+            // Stale data: same sample already accepted
+            return 0;
+        }
+        
+        // XOR, YOR, ZOR (bits 4-6) stand for ZYXOR when not all axes are enabled
+        if (burst[0] & ((1 << ZYXOR) | (axis_mask << 4)))
+        {
+            overruns++;
+        }
+        memcpy(last_sample, &burst[1], data_size);
+        return 1;
+#endif
+    }
+    
+    
+    
+    ErrorCode LIS3DH_FifoStart(uint8_t watermark)
+    {
+        uint8_t ctrl_reg5;
+        
+        // Keep the other bits of the Control register 5 (no bus read if shadowed)
+        ErrorCode error = LIS3DH_Config_Read(LIS3DH_CTRL_REG5, &ctrl_reg5);
+        if (error == NO_ERROR)
+        {
+            error = LIS3DH_Config_Write(LIS3DH_CTRL_REG5,
+                                        ctrl_reg5 | LIS3DH_CTRL_REG5_FIFO_EN);
+        }
+        if (error == NO_ERROR)
+        {
+            error = LIS3DH_Config_Write(LIS3DH_FIFO_CTRL_REG,
+                                        LIS3DH_FIFO_CTRL_REG_STREAM | 
+                                        (watermark & LIS3DH_FIFO_SRC_REG_FSS_MASK));
+        }
+        return error;
+    }
+    
+    
+    
+    ErrorCode LIS3DH_FifoRead(uint8_t* data, uint8_t* sample_count)
+    {
+        uint8_t fifo_src;
+        
+        *sample_count = 0;
+        
+        ErrorCode error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
+                                                      LIS3DH_FIFO_SRC_REG,
+                                                      &fifo_src);
+        if (error == NO_ERROR && (fifo_src & (1 << WTM)))
+        {
+            // A full FIFO holds 32 samples, more than FSS4-FSS0 can count
+            uint8_t full = (fifo_src & (1 << OVRN_FIFO)) != 0;
+            uint8_t level = full ? LIS3DH_FIFO_SIZE : (fifo_src & LIS3DH_FIFO_SRC_REG_FSS_MASK);
+            uint8_t after;
+            
+            if (full)
+            {
+                // Stream mode: the oldest samples are being overwritten
+                overruns++;
+            }
+            
+            error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
+                                                     LIS3DH_OUT_X_L,
+                                                     (uint16_t)level * LIS3DH_SAMPLE_SIZE,
+                                                     data);
+            
+            // Level after the burst: the samples which came while it was read
+            if (error == NO_ERROR)
+            {
+                error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
+                                                    LIS3DH_FIFO_SRC_REG,
+                                                    &fifo_src);
+            }
+            if (error == NO_ERROR)
+            {
+                after = (fifo_src & (1 << OVRN_FIFO)) ? LIS3DH_FIFO_SIZE :
+                        (fifo_src & LIS3DH_FIFO_SRC_REG_FSS_MASK);
+                
+                /* A sample which comes while the FIFO is full overwrites the 
+                oldest one, the one being read: the burst holds parts of both.
+                Full at the start, the oldest sample is refused (the loss is 
+                already counted). Full again later in the burst, the level 
+                after it is the room left by the samples read before, at least:
+                the overwritten samples cannot be told apart, the whole burst 
+                is refused */
+                if (after + level > LIS3DH_FIFO_SIZE + full)
+                {
+                    overruns++;
+                    level = 0;
+                }
+                else if (full)
+                {
+                    level--;
+                    memmove(data, &data[LIS3DH_SAMPLE_SIZE], (uint16_t)level * LIS3DH_SAMPLE_SIZE);
+                }
+                *sample_count = level;
+            }
+        }
+        return error;
+    }
+    
+    
+    
+    uint32_t LIS3DH_GetOverruns(void)
+    {
+        return overruns;
+    }
+
+/* [] END OF FILE */
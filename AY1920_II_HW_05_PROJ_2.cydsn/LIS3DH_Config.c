@@ -0,0 +1,221 @@
+/*
+* This file includes all the required source code to keep
+* the shadow of the LIS3DH configuration registers.
+*/
+
+#include "LIS3DH_Config.h"
+#include "I2C_Interface.h"
+#include "macro_definition.h"
+#include "string.h"
+
+/**
+*   \brief Registers from LIS3DH_CONFIG_FIRST_REG (0x1F) to INT1_CFG (0x30).
+*/
+#define LIS3DH_CONFIG_SHADOW_SIZE 18
+
+/**
+*   \brief Bit i set if register LIS3DH_CONFIG_FIRST_REG + i is a configuration
+*   register: TEMP_CFG_REG..CTRL_REG6 (0x1F..0x25), FIFO_CTRL_REG (0x2E) and 
+*   INT1_CFG (0x30). The others are read-only or not to be rewritten.
+*/
+#define LIS3DH_CONFIG_SHADOW_MASK 0x0002807F
+
+/**
+*   \brief Unchanged registers a burst can cover: a new transaction costs 2 bytes
+*   (device address and register address), rewriting a register costs 1 byte.
+*/
+#define LIS3DH_CONFIG_MAX_GAP 2
+
+static uint8_t shadow[LIS3DH_CONFIG_SHADOW_SIZE]; // Last value written to (or read from) each register
+static uint32_t shadow_valid = 0; // Bit i set when shadow[i] matches the device
+static uint32_t skipped_writes = 0;
+
+    /* Index of a register in the shadow, LIS3DH_CONFIG_SHADOW_SIZE if it is not shadowed */
+    static uint8_t LIS3DH_Config_Index(uint8_t register_address)
+    {
+        uint8_t index = register_address - LIS3DH_CONFIG_FIRST_REG;
+        
+        if (index < LIS3DH_CONFIG_SHADOW_SIZE && (LIS3DH_CONFIG_SHADOW_MASK & (1UL << index)))
+        {
+            return index;
+        }
+        return LIS3DH_CONFIG_SHADOW_SIZE;
+    }
+    
+    
+    
+    ErrorCode LIS3DH_Config_Load(void)
+    {
+        uint32_t block = (1UL << LIS3DH_CONFIG_REG_COUNT) - 1; // TEMP_CFG_REG..CTRL_REG6
+        
+        ErrorCode error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
+                                                           LIS3DH_CONFIG_FIRST_REG,
+                                                           LIS3DH_CONFIG_REG_COUNT,
+                                                           shadow);
+        shadow_valid = (error == NO_ERROR) ? (shadow_valid | block) : (shadow_valid & ~block);
+        return error;
+    }
+    
+    
+    
+    ErrorCode LIS3DH_Config_Read(uint8_t register_address, uint8_t* data)
+    {
+        uint8_t index = LIS3DH_Config_Index(register_address);
+        
+        if (index < LIS3DH_CONFIG_SHADOW_SIZE && (shadow_valid & (1UL << index)))
+        {
+            *data = shadow[index];
+            return NO_ERROR;
+        }
+        
+        ErrorCode error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
+                                                      register_address,
+                                                      data);
+        if (error == NO_ERROR && index < LIS3DH_CONFIG_SHADOW_SIZE)
+        {
+            shadow[index] = *data;
+            shadow_valid |= (1UL << index);
+        }
+        return error;
+    }
+    
+    
+    
+    ErrorCode LIS3DH_Config_Write(uint8_t register_address, uint8_t data)
+    {
+        uint8_t index = LIS3DH_Config_Index(register_address);
+        
+        if (index < LIS3DH_CONFIG_SHADOW_SIZE)
+        {
+            // Nothing to do if the register already holds the value
+            if ((shadow_valid & (1UL << index)) && shadow[index] == data)
+            {
+                skipped_writes++;
+                return NO_ERROR;
+            }
+            
+            // A failed write leaves the register in an unknown state
+            shadow_valid &= ~(1UL << index);
+        }
+        
+        ErrorCode error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
+                                                       register_address,
+                                                       data);
+        if (error == NO_ERROR && index < LIS3DH_CONFIG_SHADOW_SIZE)
+        {
+            shadow[index] = data;
+            shadow_valid |= (1UL << index);
+        }
+        return error;
+    }
+    
+    
+    
+    ErrorCode LIS3DH_Config_Apply(const LIS3DH_Config_Entry* table, uint8_t entry_count)
+    {
+        uint8_t target[LIS3DH_CONFIG_SHADOW_SIZE]; // Value of each register after the apply
+        uint32_t known = shadow_valid;  // Registers whose value after the apply is known
+        uint32_t dirty = 0;             // Registers which must be written
+        ErrorCode error = NO_ERROR;
+        
+        memcpy(target, shadow, LIS3DH_CONFIG_SHADOW_SIZE);
+        
+        for (uint8_t e = 0; e < entry_count; e++)
+        {
+            uint8_t index = LIS3DH_Config_Index(table[e].register_address);
+            
+            if (index == LIS3DH_CONFIG_SHADOW_SIZE)
+            {
+                return ERROR;
+            }
+            if ((shadow_valid & (1UL << index)) && shadow[index] == table[e].value)
+            {
+                skipped_writes++;
+            }
+            else
+            {
+                dirty |= (1UL << index);
+            }
+            target[index] = table[e].value;
+            known |= (1UL << index);
+        }
+        
+        uint8_t first = 0;
+        while (dirty != 0 && error == NO_ERROR)
+        {
+            // First register of the run
+            while (!(dirty & (1UL << first)))
+            {
+                first++;
+            }
+            
+            // Extend the run over short gaps of registers with a known value
+            uint8_t last = first;
+            uint8_t next = first + 1;
+            while (next < LIS3DH_CONFIG_SHADOW_SIZE && (known & (1UL << next)) &&
+                   next - last <= LIS3DH_CONFIG_MAX_GAP + 1)
+            {
+                if (dirty & (1UL << next))
+                {
+                    last = next;
+                }
+                next++;
+            }
+            
+            uint8_t count = last - first + 1;
+            uint32_t run = ((1UL << count) - 1) << first;
+            
+            error = I2C_Peripheral_WriteRegisterMulti(LIS3DH_DEVICE_ADDRESS,
+                                                      LIS3DH_CONFIG_FIRST_REG + first,
+                                                      count,
+                                                      &target[first]);
+            if (error == NO_ERROR)
+            {
+                memcpy(&shadow[first], &target[first], count);
+                shadow_valid |= run;
+            }
+            else
+            {
+                // Part of the burst may have been written
+                shadow_valid &= ~run;
+            }
+            dirty &= ~run;
+        }
+        return error;
+    }
+    
+    
+    
+    ErrorCode LIS3DH_Config_Verify(uint8_t* data)
+    {
+        ErrorCode error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
+                                                           LIS3DH_CONFIG_FIRST_REG,
+                                                           LIS3DH_CONFIG_REG_COUNT,
+                                                           data);
+        if (error != NO_ERROR)
+        {
+            return error;
+        }
+        
+        for (uint8_t i = 0; i < LIS3DH_CONFIG_REG_COUNT; i++)
+        {
+            if ((shadow_valid & (1UL << i)) && shadow[i] != data[i])
+            {
+                error = ERROR;
+            }
+        }
+        
+        // From now on the shadow holds what the device really contains
+        memcpy(shadow, data, LIS3DH_CONFIG_REG_COUNT);
+        shadow_valid |= (1UL << LIS3DH_CONFIG_REG_COUNT) - 1;
+        return error;
+    }
+    
+    
+    
+    uint32_t LIS3DH_Config_GetSkippedWrites(void)
+    {
+        return skipped_writes;
+    }
+
+/* [] END OF FILE */
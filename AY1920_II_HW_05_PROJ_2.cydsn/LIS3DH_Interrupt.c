@@ -0,0 +1,144 @@
+/*
+* This file includes all the required source code to handle
+* the INT1 events of the LIS3DH accelerometer.
+*/
+
+#include "LIS3DH_Interrupt.h"
+#include "CycleCounter.h"
+#include "LIS3DH_Config.h"
+#include "macro_definition.h"
+#include "project.h"
+
+static volatile uint8_t event_pending = 0;
+static volatile uint32_t event_timestamp;
+static LIS3DH_Interrupt_Stats interrupt_stats = {0, 0, 0, 0, 0xFFFFFFFF, 0, 0};
+
+#if (USE_INT1)
+    CY_ISR(LIS3DH_INT1_ISR)
+    {
+        uint32_t timestamp = CycleCounter_Get();
+        
+        // Clear the pin interrupt to be ready for the next edge
+        Pin_INT1_ClearInterrupt();
+        LIS3DH_Interrupt_Event(timestamp);
+    }
+#endif
+    
+    
+    
+    ErrorCode LIS3DH_Interrupt_Start(void)
+    {
+#if (ACQUISITION_MODE == ACQ_MODE_FIFO)
+        uint8_t ctrl_reg3 = LIS3DH_CTRL_REG3_I1_WTM;
+#else
+        uint8_t ctrl_reg3 = LIS3DH_CTRL_REG3_I1_ZYXDA;
+#endif
+        
+        ErrorCode error = LIS3DH_Config_Write(LIS3DH_CTRL_REG3, ctrl_reg3);
+#if (USE_INT1)
+        CycleCounter_Start();
+        isr_INT1_StartEx(LIS3DH_INT1_ISR);
+#endif
+        return error;
+    }
+    
+    
+    
+    void LIS3DH_Interrupt_Event(uint32_t timestamp)
+    {
+        // Latency is measured from the first event not consumed yet
+        if (!event_pending)
+        {
+            event_timestamp = timestamp;
+            event_pending = 1;
+        }
+    }
+    
+    
+    
+    uint8_t LIS3DH_Interrupt_Consume(uint32_t now)
+    {
+        uint8_t interrupt_state = CyEnterCriticalSection();
+        uint8_t pending = event_pending;
+        uint32_t latency = now - event_timestamp;
+        
+        event_pending = 0;
+        CyExitCriticalSection(interrupt_state);
+        
+        interrupt_stats.wakes++;
+        if (pending)
+        {
+            interrupt_stats.events++;
+            interrupt_stats.latency_sum += latency;
+            if (latency < interrupt_stats.latency_min)
+            {
+                interrupt_stats.latency_min = latency;
+            }
+            if (latency > interrupt_stats.latency_max)
+            {
+                interrupt_stats.latency_max = latency;
+            }
+        }
+        return pending;
+    }
+    
+    
+    
+    void LIS3DH_Interrupt_Wait(uint8_t (*idle)(void))
+    {
+#if (USE_INT1)
+        /* INT1 stays high while data is unread: an edge which came during the 
+        previous read is not seen again, hence the level is checked too */
+        while (!event_pending && !Pin_INT1_Read())
+        {
+            // No sleep while there is work: the event is not served later than a call
+            if (idle != NULL && idle())
+            {
+                continue;
+            }
+            
+            // WFI wakes up on a pending interrupt even if interrupts are masked
+            uint8_t interrupt_state = CyEnterCriticalSection();
+            if (!event_pending)
+            {
+                CY_PM_WFI;
+            }
+            CyExitCriticalSection(interrupt_state);
+        }
+        
+        LIS3DH_Interrupt_Consume(CycleCounter_Get());
+#else
+        (void)idle;
+#endif
+    }
+    
+    
+    
+    void LIS3DH_Interrupt_CountSamples(uint8_t sample_count)
+    {
+        interrupt_stats.samples += sample_count;
+    }
+    
+    
+    
+    uint8_t LIS3DH_Interrupt_Updated(void)
+    {
+#if (USE_INT1)
+        // A data ready bit set again by a sample which came after its axis was read
+        if (Pin_INT1_Read())
+        {
+            interrupt_stats.torn++;
+            return 1;
+        }
+#endif
+        return 0;
+    }
+    
+    
+    
+    void LIS3DH_Interrupt_GetStats(LIS3DH_Interrupt_Stats* stats)
+    {
+        *stats = interrupt_stats;
+    }
+
+/* [] END OF FILE */
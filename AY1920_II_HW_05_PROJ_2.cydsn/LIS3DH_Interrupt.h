@@ -0,0 +1,99 @@
+/** 
+ * \file LIS3DH_Interrupt.h
+ * \brief LIS3DH INT1 event handling.
+ *
+ * The INT1 pin of the LIS3DH signals new data (I1_ZYXDA) or the FIFO 
+ * watermark (I1_WTM). Its PSoC pin interrupt wakes the CPU up, which sleeps
+ * between the events instead of polling the Status register. The event
+ * bookkeeping is kept apart from the interrupt component, so any source 
+ * can drive it through LIS3DH_Interrupt_Event().
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef LIS3DH_Interrupt_H
+    #define LIS3DH_Interrupt_H
+    
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+    
+    /**
+    *   \brief INT1 instrumentation.
+    *
+    *   Latencies are measured in CPU cycles from the INT1 interrupt to the 
+    *   moment the acquisition loop starts reading the data.
+    */
+    typedef struct {
+        uint32_t wakes;         ///< Times the acquisition loop was released by INT1
+        uint32_t events;        ///< Wakes caused by an interrupt (the others found INT1 still high)
+        uint32_t samples;       ///< Samples read after the wakes
+        uint32_t torn;          ///< Samples refused: INT1 high again after their data was read
+        uint32_t latency_min;   ///< Minimum wake latency
+        uint32_t latency_max;   ///< Maximum wake latency
+        uint64_t latency_sum;   ///< Sum of the latencies (divide by events for the average)
+    } LIS3DH_Interrupt_Stats;
+    
+    /**
+    *   \brief Route the data ready (or FIFO watermark in ACQ_MODE_FIFO) signal
+    *   to INT1 and start the PSoC interrupt.
+    */
+    ErrorCode LIS3DH_Interrupt_Start(void);
+    
+    /**
+    *   \brief Record an INT1 event.
+    *
+    *   Called by the INT1 interrupt service routine.
+    *   \param timestamp Cycle counter value at the interrupt.
+    */
+    void LIS3DH_Interrupt_Event(uint32_t timestamp);
+    
+    /**
+    *   \brief Consume the pending INT1 event.
+    *
+    *   This function updates the instrumentation for a wake of the 
+    *   acquisition loop.
+    *   \param now Cycle counter value when the data read starts.
+    *   \retval Returns true (>0) if an event was pending.
+    */
+    uint8_t LIS3DH_Interrupt_Consume(uint32_t now);
+    
+    /**
+    *   \brief Sleep until INT1 is asserted.
+    *
+    *   The CPU sleeps until the INT1 interrupt fires. If INT1 is still high 
+    *   (data not read yet) this function returns immediately.
+    *   \param idle Work to be done instead of sleeping as long as it returns
+    *          true, one call at a time with INT1 checked in between (e.g.
+    *          TxQueue_Drain(), which feeds the UART without its TX 
+    *          interrupt), or NULL.
+    */
+    void LIS3DH_Interrupt_Wait(uint8_t (*idle)(void));
+    
+    /**
+    *   \brief Add the samples read after the last wake.
+    *
+    *   \param sample_count Number of samples read.
+    */
+    void LIS3DH_Interrupt_CountSamples(uint8_t sample_count);
+    
+    /**
+    *   \brief Check INT1 right after the data of a sample was read.
+    *
+    *   The data ready (I1_ZYXDA) keeps INT1 high until every enabled axis 
+    *   is read: high again after the burst, the sample was updated while it
+    *   was read and the axes read before the update hold the older one. 
+    *   Such a sample, which may be torn, must be discarded by the caller 
+    *   (the newer one is read next time, INT1 being high).
+    *   \retval Returns true (>0) if the sample was updated during the read.
+    */
+    uint8_t LIS3DH_Interrupt_Updated(void);
+    
+    /**
+    *   \brief Get the INT1 instrumentation.
+    *
+    *   \param stats Pointer to a structure where the statistics will be saved.
+    */
+    void LIS3DH_Interrupt_GetStats(LIS3DH_Interrupt_Stats* stats);
+    
+#endif // LIS3DH_Interrupt_H
+/* [] END OF FILE */
@@ -0,0 +1,128 @@
+/** 
+ * \file LIS3DH_Profile.h
+ * \brief LIS3DH acquisition profile.
+ *
+ * The acquisition profile (power mode, full scale, output data rate and 
+ * output unit) is selected in macro_definition.h. Everything that depends 
+ * on it is derived here at compile time: the resolution, the sensitivity, 
+ * the shift of the output registers and the values of the Control 
+ * registers 1 and 4. Scale and configuration can therefore never disagree.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef LIS3DH_Profile_H
+    #define LIS3DH_Profile_H
+    
+    /**
+    *   \brief Power modes (LPen bit of CTRL_REG1, HR bit of CTRL_REG4)
+    */
+    #define LIS3DH_MODE_LOW_POWER 0         ///< 8-bit data, LPen = 1, HR = 0
+    #define LIS3DH_MODE_NORMAL 1            ///< 10-bit data, LPen = 0, HR = 0
+    #define LIS3DH_MODE_HIGH_RESOLUTION 2   ///< 12-bit data, LPen = 0, HR = 1
+    
+    /**
+    *   \brief Full scales (FS1-FS0 bits of CTRL_REG4)
+    */
+    #define LIS3DH_FS_2G 0
+    #define LIS3DH_FS_4G 1
+    #define LIS3DH_FS_8G 2
+    #define LIS3DH_FS_16G 3
+    
+    /**
+    *   \brief Output data rates (ODR3-ODR0 bits of CTRL_REG1)
+    */
+    #define LIS3DH_ODR_1HZ 1
+    #define LIS3DH_ODR_10HZ 2
+    #define LIS3DH_ODR_25HZ 3
+    #define LIS3DH_ODR_50HZ 4
+    #define LIS3DH_ODR_100HZ 5
+    #define LIS3DH_ODR_200HZ 6
+    #define LIS3DH_ODR_400HZ 7
+    #define LIS3DH_ODR_1600HZ_LP 8          ///< Low power mode only
+    #define LIS3DH_ODR_1344HZ 9             ///< 5.376 kHz in low power mode
+    #define LIS3DH_ODR_5376HZ_LP 9          ///< Same code as LIS3DH_ODR_1344HZ, low power mode
+    
+    /**
+    *   \brief Output units of the conversion kernel
+    */
+    #define UNIT_MG 0                       ///< Integer mg
+    #define UNIT_MS2_Q16 1                  ///< m/s2 as Q16.16 fixed-point
+    
+    #include "macro_definition.h"
+    
+    /**
+    *   \brief Resolution (bits) of the samples in the selected power mode
+    */
+    #if (ACC_POWER_MODE == LIS3DH_MODE_LOW_POWER)
+        #define LIS3DH_PROFILE_RESOLUTION_BITS 8
+    #elif (ACC_POWER_MODE == LIS3DH_MODE_NORMAL)
+        #define LIS3DH_PROFILE_RESOLUTION_BITS 10
+    #elif (ACC_POWER_MODE == LIS3DH_MODE_HIGH_RESOLUTION)
+        #define LIS3DH_PROFILE_RESOLUTION_BITS 12
+    #else
+        #error "ACC_POWER_MODE must be one of the LIS3DH_MODE_* values"
+    #endif
+    
+    #if (ACC_FULL_SCALE < LIS3DH_FS_2G || ACC_FULL_SCALE > LIS3DH_FS_16G)
+        #error "ACC_FULL_SCALE must be one of the LIS3DH_FS_* values"
+    #endif
+    
+    #if (ACC_ODR < LIS3DH_ODR_1HZ || ACC_ODR > LIS3DH_ODR_1344HZ)
+        #error "ACC_ODR must be one of the LIS3DH_ODR_* values"
+    #elif (ACC_ODR == LIS3DH_ODR_1600HZ_LP && ACC_POWER_MODE != LIS3DH_MODE_LOW_POWER)
+        #error "The 1.6 kHz output data rate is available in low power mode only"
+    #endif
+    
+    /**
+    *   \brief Output data rate (Hz) of the selected ACC_ODR and power mode
+    */
+    #if (ACC_ODR == LIS3DH_ODR_1344HZ && ACC_POWER_MODE == LIS3DH_MODE_LOW_POWER)
+        #define LIS3DH_PROFILE_ODR_HZ 5376
+    #elif (ACC_ODR == LIS3DH_ODR_1344HZ)
+        #define LIS3DH_PROFILE_ODR_HZ 1344
+    #elif (ACC_ODR == LIS3DH_ODR_1600HZ_LP)
+        #define LIS3DH_PROFILE_ODR_HZ 1600
+    #else
+        #define LIS3DH_PROFILE_ODR_HZ ((ACC_ODR == LIS3DH_ODR_1HZ) ? 1 : (ACC_ODR == LIS3DH_ODR_10HZ) ? 10 : \
+                                       (25 << (ACC_ODR - LIS3DH_ODR_25HZ)))
+    #endif
+    
+    /**
+    *   \brief Right shift that turns the left-justified output registers 
+    *   into a right-justified value.
+    */
+    #define LIS3DH_PROFILE_SHIFT (16 - LIS3DH_PROFILE_RESOLUTION_BITS)
+    
+    /**
+    *   \brief Sensitivity (mg/digit) from the datasheet: 1, 2, 4, 12 mg/digit
+    *   in high resolution mode for ±2, ±4, ±8, ±16 g, 4 times as much in normal
+    *   mode and 16 times as much in low power mode.
+    */
+    #define LIS3DH_PROFILE_SENSITIVITY_MG \
+        (((ACC_FULL_SCALE == LIS3DH_FS_16G) ? 12 : (1 << ACC_FULL_SCALE)) << (12 - LIS3DH_PROFILE_RESOLUTION_BITS))
+    
+    /**
+    *   \brief Control register 1: output data rate, LPen bit, ACC_AXES enabled
+    */
+    #define LIS3DH_PROFILE_CTRL_REG1 \
+        ((ACC_ODR << 4) | ((ACC_POWER_MODE == LIS3DH_MODE_LOW_POWER) ? 0x08 : 0x00) | ACC_AXES)
+    
+    /**
+    *   \brief Only the high byte of each output register pair is meaningful
+    *   (8-bit data in low power mode).
+    */
+    #define LIS3DH_PROFILE_HIGH_BYTES (ACC_POWER_MODE == LIS3DH_MODE_LOW_POWER)
+    
+    /**
+    *   \brief Control register 4: BDU bit, full scale, HR bit. BDU keeps the 
+    *   output registers of a sample together while they are read (the polled
+    *   burst relies on it, see LIS3DH_ReadSampleAsync()); with USE_INT1 and
+    *   8-bit data it is left off so that the high bytes can be read alone.
+    */
+    #define LIS3DH_PROFILE_CTRL_REG4 \
+        ((LIS3DH_PROFILE_HIGH_BYTES && USE_INT1 ? 0x00 : 0x80) | (ACC_FULL_SCALE << 4) | \
+         ((ACC_POWER_MODE == LIS3DH_MODE_HIGH_RESOLUTION) ? 0x08 : 0x00))
+    
+#endif // LIS3DH_Profile_H
+/* [] END OF FILE */
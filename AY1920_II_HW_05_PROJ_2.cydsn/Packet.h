@@ -0,0 +1,77 @@
+/**
+ * \file Packet.h
+ * \brief COBS framed packets with sequence number and CRC16.
+ *
+ * Alternative to the 0xA0/0xC0 header and tail (FRAME_FORMAT_COBS). A
+ * packet holds the index of its first sample (16-bit, it keeps counting
+ * also when samples are dropped), the sample count, the samples and the
+ * CRC16 of all of them. It is then COBS encoded: no 0x00 byte is left
+ * inside, so 0x00 marks the end of every packet and a receiver which lost
+ * synchronisation is aligned again at the next packet. The axes byte tells
+ * which axes each sample holds (see LIS3DH_SetAxes()). The overhead is
+ * fixed: 1 COBS byte + 2 sequence + 1 count + 1 axes + 2 CRC + 1 delimiter.
+ *
+ * Layout of the frame buffer (filled in place, encoded by Packet_Seal()):
+ *   [0] COBS code  [1..2] sequence, LSB first  [3] sample count
+ *   [4] axes (ACC_AXIS_X | ACC_AXIS_Y | ACC_AXIS_Z)
+ *   [5..] samples  [..] CRC16, LSB first  [last] 0x00 delimiter
+ * The top bits of the count byte mark the packets of FRAME_FORMAT_DELTA
+ * (see DeltaCodec.h) and FRAME_FORMAT_PACKED (see BitPack.h); a count byte
+ * of 0 marks the telemetry packets (see Telemetry.h), a packed packet
+ * without samples the log records (see Log.h).
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef Packet_H
+    #define Packet_H
+    
+    #include "cytypes.h"
+    
+    /**
+    *   \brief Bytes before the first sample and after the last one.
+    */
+    #define PACKET_HEADER_SIZE 5
+    #define PACKET_TRAILER_SIZE 3
+    
+    /**
+    *   \brief Flags and sample count in the count byte.
+    */
+    #define PACKET_DELTA 0x80       ///< Samples compressed by DeltaCodec
+    #define PACKET_KEYFRAME 0x40    ///< With PACKET_DELTA: first sample not relative to the previous packet
+    #define PACKET_PACKED 0x40      ///< Without PACKET_DELTA: samples packed by BitPack
+    #define PACKET_COUNT_MASK 0x3F
+    #define PACKET_TELEMETRY 0x00   ///< Count byte of the telemetry packets (no samples, see Telemetry.h)
+    #define PACKET_LOG 0x40         ///< Count byte of the log records (LOG_FORMAT_BINARY, see Log.h)
+    
+    /**
+    *   \brief Compute the CRC16 (CCITT polynomial 0x1021, initial value 0xFFFF).
+    *
+    *   \param data Bytes to be checked.
+    *   \param length Number of bytes.
+    */
+    uint16_t Packet_Crc16(const uint8_t* data, uint16_t length);
+    
+    /**
+    *   \brief Write the header of a packet.
+    *
+    *   \param frame Frame buffer.
+    *   \param sequence Index of the first sample of the packet.
+    *   \param sample_count Number of samples of the packet, with the PACKET_DELTA
+    *          and PACKET_KEYFRAME flags.
+    *   \param axes Axes of the samples.
+    */
+    void Packet_Start(uint8_t* frame, uint16_t sequence, uint8_t sample_count, uint8_t axes);
+    
+    /**
+    *   \brief Append the CRC16 and encode the packet in place.
+    *
+    *   \param frame Frame buffer holding the header and the samples.
+    *   \param sample_bytes Number of bytes after the axes byte (max 247, i.e.
+    *          255 bytes for the whole packet).
+    *   \retval Number of bytes of the encoded packet, delimiter included.
+    */
+    uint8_t Packet_Seal(uint8_t* frame, uint8_t sample_bytes);
+
+#endif // Packet_H
+/* [] END OF FILE */
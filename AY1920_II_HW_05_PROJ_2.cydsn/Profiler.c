@@ -0,0 +1,178 @@
+/*
+* This file includes all the required source code to profile
+* the stages of the acquisition loop.
+*/
+
+#include "Profiler.h"
+#include "CycleCounter.h"
+#include "Log.h"
+#include "TxQueue.h"
+#include "project.h"
+
+#if (USE_PROFILER)
+
+/**
+*   \brief No stage running (before the first iteration and after a dump).
+*/
+#define PROFILER_STAGE_NONE 0xFF
+
+static Profiler_Entry table[PROFILER_STAGES + 1];   // Stages, then the whole iteration
+static uint32_t stage_cycles[PROFILER_STAGES];      // Cycles of each stage in the current iteration
+static uint8_t stages_run = 0;                      // Stages which ran in the current iteration (bit mask)
+static uint8_t stage_current = PROFILER_STAGE_NONE;
+static uint32_t stage_start;                        // Cycle counter at the start of the current stage
+
+// Message of each stage line, then of the whole iteration (the IDs follow the order of LogMessages.h)
+static const uint8_t stage_messages[PROFILER_STAGES + 1] = {
+    [PROFILER_STAGE_WAIT] = LOG_PROFILER_WAIT,
+    [PROFILER_STAGE_READ] = LOG_PROFILER_READ,
+    [PROFILER_STAGE_CONVERT] = LOG_PROFILER_CONVERT,
+    [PROFILER_STAGE_SEND] = LOG_PROFILER_SEND,
+    [PROFILER_STAGE_FILTER] = LOG_PROFILER_FILTER,
+    [PROFILER_STAGE_DECIMATE] = LOG_PROFILER_DECIMATE,
+    [PROFILER_STAGES] = LOG_PROFILER_LOOP,
+};
+
+    static void Profiler_Clear(void)
+    {
+        for (uint8_t i = 0; i <= PROFILER_STAGES; i++)
+        {
+            table[i].count = 0;
+            table[i].min = 0xFFFFFFFF;
+            table[i].max = 0;
+            table[i].sum = 0;
+            for (uint8_t b = 0; b < PROFILER_BINS; b++)
+            {
+                table[i].bins[b] = 0;
+            }
+        }
+        for (uint8_t i = 0; i < PROFILER_STAGES; i++)
+        {
+            stage_cycles[i] = 0;
+        }
+        stages_run = 0;
+        stage_current = PROFILER_STAGE_NONE;
+    }
+    
+    
+    
+    static void Profiler_Record(Profiler_Entry* entry, uint32_t cycles)
+    {
+        // Bin of the highest bit set (CLZ instruction)
+        uint8_t bin = cycles ? 32 - __builtin_clz(cycles) : 0;
+        
+        entry->count++;
+        entry->sum += cycles;
+        if (cycles < entry->min)
+        {
+            entry->min = cycles;
+        }
+        if (cycles > entry->max)
+        {
+            entry->max = cycles;
+        }
+        entry->bins[(bin < PROFILER_BINS) ? bin : PROFILER_BINS - 1]++;
+    }
+    
+    
+    
+    void Profiler_Start(void)
+    {
+        CycleCounter_Start();
+        Profiler_Clear();
+    }
+    
+    
+    
+    void Profiler_Enter(uint8_t stage)
+    {
+        uint32_t now = CycleCounter_Get();
+        
+        if (stage_current != PROFILER_STAGE_NONE)
+        {
+            stage_cycles[stage_current] += now - stage_start;
+            stages_run |= 1 << stage_current;
+        }
+        stage_current = stage;
+        stage_start = now;
+    }
+    
+    
+    
+    void Profiler_Loop(void)
+    {
+        uint8_t closing = (stage_current != PROFILER_STAGE_NONE); // The first iteration has no previous one
+        uint32_t total = 0;
+        
+        Profiler_Enter(PROFILER_STAGE_WAIT);
+        if (closing)
+        {
+            for (uint8_t i = 0; i < PROFILER_STAGES; i++)
+            {
+                if (stages_run & (1 << i))
+                {
+                    Profiler_Record(&table[i], stage_cycles[i]);
+                    total += stage_cycles[i];
+                }
+                stage_cycles[i] = 0;
+            }
+            Profiler_Record(&table[PROFILER_STAGES], total);
+            stages_run = 0;
+        }
+    }
+    
+    
+    
+    void Profiler_Poll(void)
+    {
+        if (UART_Debug_GetChar() == PROFILER_DUMP_COMMAND)
+        {
+            Profiler_Dump();
+        }
+    }
+    
+    
+    
+    void Profiler_Dump(void)
+    {
+        // Whole frames only: the text goes between two of them
+        TxQueue_Flush();
+        
+        Log_Print(LOG_PROFILER_HEADER);
+        for (uint8_t i = 0; i <= PROFILER_STAGES; i++)
+        {
+            const Profiler_Entry* entry = &table[i];
+            
+            // A message per stage, in the same order
+            Log_Print(stage_messages[i], entry->count);
+            if (entry->count)
+            {
+                Log_Print(LOG_PROFILER_TIMES, entry->min, (uint32_t)(entry->sum / entry->count), entry->max);
+            }
+            for (uint8_t b = 0; b < PROFILER_BINS; b++)
+            {
+                if (entry->bins[b])
+                {
+                    Log_Print(LOG_PROFILER_BIN, b, entry->bins[b]);
+                }
+            }
+            Log_Print(LOG_PROFILER_END);
+        }
+#if (FRAME_FORMAT != FRAME_FORMAT_HEADER_TAIL && LOG_FORMAT == LOG_FORMAT_TEXT)
+        UART_Debug_PutChar(0); //Delimiter: the text is not part of the next packet
+#endif
+
+        // The iteration in progress is not counted: the dump took part of it
+        Profiler_Clear();
+    }
+    
+    
+    
+    void Profiler_GetEntry(uint8_t stage, Profiler_Entry* entry)
+    {
+        *entry = table[stage];
+    }
+
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,137 @@
+/*
+* This file includes all the required source code to send
+* the sample loss and loop telemetry.
+*/
+
+#include "Telemetry.h"
+#include "CycleCounter.h"
+#include "I2C_Interface.h"
+#include "LIS3DH.h"
+#include "Packet.h"
+#include "TxQueue.h"
+#include "macro_definition.h"
+
+/**
+*   \brief Bytes of the counters after the packet header.
+*/
+#define TELEMETRY_PAYLOAD_SIZE (8 * 4)
+
+#if (TELEMETRY_FRAME_SIZE != PACKET_HEADER_SIZE + TELEMETRY_PAYLOAD_SIZE + PACKET_TRAILER_SIZE)
+    #error "TELEMETRY_FRAME_SIZE does not match the telemetry packet"
+#endif
+
+static uint32_t samples = 0;            // Samples read since boot
+static uint32_t window_samples = 0;     // Samples read since the previous telemetry packet
+static uint32_t loops = 0;              // Iterations timed since the previous telemetry packet
+static uint32_t loop_min = 0xFFFFFFFF;
+static uint32_t loop_max = 0;
+static uint64_t loop_sum = 0;           // 64 bits: the packet may be delayed by a full ring
+static uint32_t loop_start;             // Cycle counter at the previous iteration
+static uint8_t loop_started = 0;
+
+    // Append a counter, LSB first
+    static uint8_t* Telemetry_Put(uint8_t* out, uint32_t value)
+    {
+        out[0] = (uint8_t)value;
+        out[1] = (uint8_t)(value >> 8);
+        out[2] = (uint8_t)(value >> 16);
+        out[3] = (uint8_t)(value >> 24);
+        return out + 4;
+    }
+    
+    
+    
+    void Telemetry_Start(void)
+    {
+        CycleCounter_Start();
+    }
+    
+    
+    
+    void Telemetry_Loop(uint8_t sample_count)
+    {
+        uint32_t now = CycleCounter_Get();
+        uint32_t duration = now - loop_start;
+        
+        if (loop_started)
+        {
+            loops++;
+            loop_sum += duration;
+            if (duration < loop_min)
+            {
+                loop_min = duration;
+            }
+            if (duration > loop_max)
+            {
+                loop_max = duration;
+            }
+        }
+        loop_started = 1;
+        loop_start = now;
+        
+        samples += sample_count;
+        window_samples += sample_count;
+    }
+    
+    
+    
+    void Telemetry_Send(uint16_t sequence)
+    {
+        Telemetry_Stats stats;
+        uint8_t* frame;
+        uint8_t* out;
+        
+        if (window_samples < TELEMETRY_SAMPLES)
+        {
+            return;
+        }
+        
+        // Ring full: tried again after the next data packet (postponed, not dropped)
+        if (TxQueue_IsFull())
+        {
+            return;
+        }
+        frame = TxQueue_GetFrame();
+        
+        Telemetry_GetStats(&stats);
+        Packet_Start(frame, sequence, PACKET_TELEMETRY, LIS3DH_GetAxes());
+        out = &frame[PACKET_HEADER_SIZE];
+        out = Telemetry_Put(out, stats.samples);
+        out = Telemetry_Put(out, stats.overruns);
+        out = Telemetry_Put(out, stats.i2c_errors);
+        out = Telemetry_Put(out, stats.tx_dropped);
+        out = Telemetry_Put(out, stats.loops);
+        out = Telemetry_Put(out, stats.loop_min);
+        out = Telemetry_Put(out, stats.loop_max);
+        Telemetry_Put(out, stats.loop_avg);
+        TxQueue_Push(Packet_Seal(frame, TELEMETRY_PAYLOAD_SIZE));
+        
+        // The loop durations restart from here, the counters keep counting
+        window_samples = 0;
+        loops = 0;
+        loop_min = 0xFFFFFFFF;
+        loop_max = 0;
+        loop_sum = 0;
+    }
+    
+    
+    
+    void Telemetry_GetStats(Telemetry_Stats* stats)
+    {
+        I2C_Peripheral_BusCounters bus;
+        TxQueue_Stats tx;
+        
+        I2C_Peripheral_GetBusCounters(&bus);
+        TxQueue_GetStats(&tx);
+        
+        stats->samples = samples;
+        stats->overruns = LIS3DH_GetOverruns();
+        stats->i2c_errors = bus.errors;
+        stats->tx_dropped = tx.frames_dropped;
+        stats->loops = loops;
+        stats->loop_min = loops ? loop_min : 0;
+        stats->loop_max = loop_max;
+        stats->loop_avg = loops ? (uint32_t)(loop_sum / loops) : 0;
+    }
+
+/* [] END OF FILE */
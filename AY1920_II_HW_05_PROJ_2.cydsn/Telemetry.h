@@ -0,0 +1,75 @@
+/**
+ * \file Telemetry.h
+ * \brief Sample loss and acquisition loop telemetry (USE_TELEMETRY).
+ *
+ * Every TELEMETRY_SAMPLES samples read a telemetry packet is queued between
+ * two data packets: a packet of Packet.h whose count byte is
+ * PACKET_TELEMETRY (no samples), whose sequence number is the one of the
+ * next sample and whose body holds the counters of Telemetry_Stats, 4 bytes
+ * each, LSB first, in their order. The counters since boot let the host
+ * tell where samples were lost:
+ *   - overruns: the sensor overwrote samples before they were read (the
+ *     loop was late, see LIS3DH_GetOverruns());
+ *   - I2C errors: samples not read (see I2C_Peripheral_BusCounters);
+ *   - frames dropped: samples read but not sent, the UART could not keep
+ *     up (see TxQueue_Stats);
+ * and the duration of the loop iterations since the previous telemetry
+ * packet shows how close the loop is to the sample period. Durations are
+ * in CPU cycles (see CycleCounter.h), which stop while the CPU sleeps: with
+ * USE_INT1 or USE_POLL_TIMER they are the busy time of an iteration.
+ * A packet which finds the transmit ring full is sent after the next data
+ * packet.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef Telemetry_H
+    #define Telemetry_H
+    
+    #include "cytypes.h"
+    
+    /**
+    *   \brief Counters of a telemetry packet, in the order they are sent.
+    */
+    typedef struct {
+        uint32_t samples;       ///< Samples read from the accelerometer
+        uint32_t overruns;      ///< Reads which found samples overwritten
+        uint32_t i2c_errors;    ///< I2C transactions which returned ERROR
+        uint32_t tx_dropped;    ///< Data frames given up because the transmit ring was full (one per frame)
+        uint32_t loops;         ///< Loop iterations since the previous telemetry packet
+        uint32_t loop_min;      ///< Minimum duration of these iterations
+        uint32_t loop_max;      ///< Maximum duration of these iterations
+        uint32_t loop_avg;      ///< Average duration of these iterations
+    } Telemetry_Stats;
+    
+    /**
+    *   \brief Start the cycle counter which times the loop.
+    */
+    void Telemetry_Start(void);
+    
+    /**
+    *   \brief Time an iteration of the acquisition loop.
+    *
+    *   Called once per iteration, always at the same point of the loop.
+    *   \param sample_count Number of samples read in this iteration.
+    */
+    void Telemetry_Loop(uint8_t sample_count);
+    
+    /**
+    *   \brief Queue a telemetry packet if TELEMETRY_SAMPLES samples were read
+    *   since the previous one.
+    *
+    *   Called when no data frame is being filled (right after TxQueue_Push()).
+    *   \param sequence Index of the next sample.
+    */
+    void Telemetry_Send(uint16_t sequence);
+    
+    /**
+    *   \brief Get the counters of the next telemetry packet.
+    *
+    *   \param stats Pointer to a structure where the counters will be saved.
+    */
+    void Telemetry_GetStats(Telemetry_Stats* stats);
+
+#endif // Telemetry_H
+/* [] END OF FILE */
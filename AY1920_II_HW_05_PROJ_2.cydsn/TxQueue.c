@@ -0,0 +1,211 @@
+/*
+* This file includes all the required source code to send
+* the frames over the UART without blocking.
+*/
+
+#include "TxQueue.h"
+#include "macro_definition.h"
+#include "project.h"
+
+/**
+*   \brief Free-running indexes are reduced with a mask.
+*/
+#if (TX_QUEUE_DEPTH & (TX_QUEUE_DEPTH - 1)) || (TX_QUEUE_DEPTH > 128)
+    #error "TX_QUEUE_DEPTH must be a power of 2 (max 128)"
+#endif
+
+#define TX_QUEUE_MASK (TX_QUEUE_DEPTH - 1)
+
+/**
+*   \brief States of the text (see TxQueue_SetText()).
+*/
+#define TEXT_IDLE 0         ///< Between two lines: frames first
+#define TEXT_LINE 1         ///< Line being sent: the frames wait for its end
+#define TEXT_DELIMITER 2    ///< Line sent, 0x00 delimiter to be sent (packet formats)
+
+/**
+*   \brief Last character of a line and state after it: the log records of
+*   LOG_FORMAT_BINARY (see Log.h) end with their own 0x00 delimiter.
+*/
+#if (LOG_FORMAT == LOG_FORMAT_BINARY)
+    #define TEXT_LINE_LAST 0
+    #define TEXT_LINE_END TEXT_IDLE
+#elif (FRAME_FORMAT != FRAME_FORMAT_HEADER_TAIL)
+    #define TEXT_LINE_LAST '\n'
+    #define TEXT_LINE_END TEXT_DELIMITER
+#else
+    #define TEXT_LINE_LAST '\n'
+    #define TEXT_LINE_END TEXT_IDLE
+#endif
+
+static uint8_t frames[TX_QUEUE_DEPTH][TX_QUEUE_FRAME_SIZE];
+static uint8_t frame_length[TX_QUEUE_DEPTH];
+static volatile uint8_t head = 0;   // Frames handed over (written by the loop only)
+static volatile uint8_t tail = 0;   // Frames sent (written by the drain only)
+static uint8_t sent_bytes = 0;      // Bytes of the frame at the tail already in the TX FIFO
+static TxQueue_Stats tx_stats = {0, 0, 0, 0};
+static const uint8_t* volatile text; // Text not sent yet
+static volatile uint16_t text_length = 0;
+static uint8_t text_state = TEXT_IDLE;
+
+    static void TxQueue_Fill(void)
+    {
+        while (UART_Debug_ReadTxStatus() & UART_Debug_TX_STS_FIFO_NOT_FULL)
+        {
+            if (text_state == TEXT_DELIMITER)
+            {
+                UART_Debug_WriteTxData(0);
+                text_state = TEXT_IDLE;
+            }
+            else if (text_state == TEXT_LINE || (tail == head && text_length))
+            {
+                // Text only when no frame is waiting, then a whole line
+                uint8_t character = *text++;
+                
+                UART_Debug_WriteTxData(character);
+                text_length--;
+                text_state = (character != TEXT_LINE_LAST && text_length) ? TEXT_LINE : TEXT_LINE_END;
+            }
+            else if (tail != head)
+            {
+                uint8_t index = tail & TX_QUEUE_MASK;
+                
+                UART_Debug_WriteTxData(frames[index][sent_bytes++]);
+                if (sent_bytes == frame_length[index])
+                {
+                    // Release the buffer only when its last byte is in the FIFO
+                    sent_bytes = 0;
+                    tx_stats.frames_sent++;
+                    tail++;
+                }
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+    
+    
+    
+    // Frames or text still to be sent
+    static uint8_t TxQueue_Pending(void)
+    {
+        return tail != head || text_length || text_state != TEXT_IDLE;
+    }
+    
+    
+    
+#if (USE_UART_TX_ISR)
+    CY_ISR(TxQueue_ISR)
+    {
+        TxQueue_Fill();
+        
+        // 'FIFO not full' is a level: mute it until the next frame
+        if (!TxQueue_Pending())
+        {
+            isr_UART_TX_Disable();
+        }
+    }
+#endif
+    
+    
+    
+    void TxQueue_Start(void)
+    {
+#if (USE_UART_TX_ISR)
+        isr_UART_TX_StartEx(TxQueue_ISR);
+        isr_UART_TX_Disable();
+#endif
+    }
+    
+    
+    
+    uint8_t* TxQueue_GetFrame(void)
+    {
+        if ((uint8_t)(head - tail) == TX_QUEUE_DEPTH)
+        {
+            // The link cannot keep up: drop the new frame, never wait
+            tx_stats.frames_dropped++;
+            return NULL;
+        }
+        return frames[head & TX_QUEUE_MASK];
+    }
+    
+    
+    
+    uint8_t TxQueue_IsFull(void)
+    {
+        return (uint8_t)(head - tail) == TX_QUEUE_DEPTH;
+    }
+    
+    
+    
+    void TxQueue_Push(uint8_t length)
+    {
+        uint8_t level;
+        
+        frame_length[head & TX_QUEUE_MASK] = length;
+        head++;
+        
+        tx_stats.frames_queued++;
+        level = head - tail;
+        if (level > tx_stats.max_level)
+        {
+            tx_stats.max_level = level;
+        }
+        
+#if (USE_UART_TX_ISR)
+        isr_UART_TX_Enable();
+#else
+        // Start sending at once: the FIFO holds the first bytes
+        TxQueue_Fill();
+#endif
+    }
+    
+    
+    
+    uint8_t TxQueue_Drain(void)
+    {
+#if (!USE_UART_TX_ISR)
+        TxQueue_Fill();
+#endif
+        return TxQueue_Pending();
+    }
+    
+    
+    
+    void TxQueue_Flush(void)
+    {
+        // The text may wait: it is sent in the idle time of the link
+        do
+        {
+            TxQueue_Drain();
+        } while (tail != head);
+    }
+    
+    
+    
+    void TxQueue_SetText(const uint8_t* data, uint16_t length)
+    {
+        // The interrupt (USE_UART_TX_ISR) must see the pointer and the length of the same text
+        uint8_t interrupt_state = CyEnterCriticalSection();
+        text = data;
+        text_length = length;
+        CyExitCriticalSection(interrupt_state);
+        
+#if (USE_UART_TX_ISR)
+        isr_UART_TX_Enable();
+#else
+        TxQueue_Fill();
+#endif
+    }
+    
+    
+    
+    void TxQueue_GetStats(TxQueue_Stats* stats)
+    {
+        *stats = tx_stats;
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,100 @@
+/**
+ * \file TxQueue.h
+ * \brief Non-blocking UART transmission of frames.
+ *
+ * The acquisition loop writes each frame straight into a free buffer of a
+ * ring of TX_QUEUE_DEPTH frames and hands it over: the bytes are moved into
+ * the 4-byte TX FIFO of the UART whenever there is room, either by
+ * TxQueue_Drain() called from the loop or by the UART TX interrupt
+ * (USE_UART_TX_ISR). The loop never waits for the serial port: when the
+ * link cannot keep up the ring fills and the new frames are dropped and
+ * counted. Text (e.g. diagnostics) can be sent at low priority between
+ * the frames, see TxQueue_SetText().
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef TxQueue_H
+    #define TxQueue_H
+    
+    #include "cytypes.h"
+    
+    /**
+    *   \brief Transmission counters.
+    */
+    typedef struct {
+        uint32_t frames_queued;     ///< Frames handed over with TxQueue_Push()
+        uint32_t frames_sent;       ///< Frames completely written into the TX FIFO
+        uint32_t frames_dropped;    ///< Frames lost because the ring was full
+        uint8_t max_level;          ///< Maximum number of frames waiting in the ring
+    } TxQueue_Stats;
+    
+    /**
+    *   \brief Start the transmission (and the UART TX interrupt if used).
+    */
+    void TxQueue_Start(void);
+    
+    /**
+    *   \brief Get the buffer of the next frame.
+    *
+    *   The frame is filled in place (no copy) and sent with TxQueue_Push().
+    *   \retval Pointer to a buffer of TX_QUEUE_FRAME_SIZE bytes, NULL if the
+    *           ring is full: the frame is counted as dropped, so the caller
+    *           gives it up and does not ask again for it (a frame which can
+    *           wait checks TxQueue_IsFull() first).
+    */
+    uint8_t* TxQueue_GetFrame(void);
+    
+    /**
+    *   \brief Check if the ring is full (nothing is counted).
+    *
+    *   \retval Returns true (>0) if TxQueue_GetFrame() would return NULL.
+    */
+    uint8_t TxQueue_IsFull(void);
+    
+    /**
+    *   \brief Hand over the frame returned by TxQueue_GetFrame().
+    *
+    *   \param length Number of bytes of the frame (max TX_QUEUE_FRAME_SIZE).
+    */
+    void TxQueue_Push(uint8_t length);
+    
+    /**
+    *   \brief Move bytes into the TX FIFO while there is room.
+    *
+    *   Without USE_UART_TX_ISR this function must be called often (e.g.
+    *   while waiting for the I2C bus); with the interrupt it does nothing.
+    *   \retval Returns true (>0) while frames or text are waiting to be sent.
+    */
+    uint8_t TxQueue_Drain(void);
+    
+    /**
+    *   \brief Wait until all the frames are in the TX FIFO (not the text).
+    */
+    void TxQueue_Flush(void);
+    
+    /**
+    *   \brief Send text at low priority.
+    *
+    *   A line of text starts only when no frame is waiting and the frames
+    *   wait until its end ('\n'), so frames and lines are never mixed: the
+    *   text takes the idle time of the link. With the packet formats a 0x00
+    *   delimiter follows each line, so the lines should start with '#' (see
+    *   Host_Tools/FrameDecoder); with LOG_FORMAT_BINARY the text is made of
+    *   log records, each one ending with its 0x00 delimiter instead of a
+    *   '\n' (see Log.h). The text is not copied: it must stay
+    *   valid until it is sent (TxQueue_Drain() returns false).
+    *   \param data Text, replacing the text not sent yet.
+    *   \param length Number of bytes.
+    */
+    void TxQueue_SetText(const uint8_t* data, uint16_t length);
+    
+    /**
+    *   \brief Get the transmission counters.
+    *
+    *   \param stats Pointer to a structure where the counters will be saved.
+    */
+    void TxQueue_GetStats(TxQueue_Stats* stats);
+
+#endif // TxQueue_H
+/* [] END OF FILE */
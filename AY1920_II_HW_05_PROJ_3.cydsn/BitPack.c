@@ -0,0 +1,72 @@
+/*
+* This file includes all the required source code to 
+* pack the samples sent in FRAME_FORMAT_PACKED.
+*/
+
+#include "BitPack.h"
+#include "Packet.h"
+#include "Conversion.h"
+
+#define BITPACK_BITS LIS3DH_PROFILE_RESOLUTION_BITS
+#define BITPACK_MASK ((1UL << BITPACK_BITS) - 1)
+
+static uint32_t bit_buffer = 0;     // Bits not written yet, LSB first
+static uint8_t bit_count = 0;       // Number of bits in bit_buffer (less than 8 between samples)
+
+    uint8_t* BitPack_Start(uint8_t* frame, uint16_t sequence, uint8_t sample_count, uint8_t axes)
+    {
+        uint8_t* out = &frame[PACKET_HEADER_SIZE];
+        
+        Packet_Start(frame, sequence, sample_count | PACKET_PACKED, axes);
+        *out++ = LIS3DH_PROFILE_SENSITIVITY_MG;
+        *out++ = BITPACK_BITS;
+        
+        bit_buffer = 0;
+        bit_count = 0;
+        
+        return out;
+    }
+    
+    
+    
+    uint8_t* BitPack_Encode(uint8_t* out, const uint8_t* data, uint8_t axes)
+    {
+        uint8_t axis;
+        
+        // Whole bytes are written after each axis: at most 7 + 12 bits are buffered
+        for (axis = 0; axis < 3; axis++)
+        {
+            if (!(axes & (1 << axis)))
+            {
+                continue;
+            }
+            
+            bit_buffer |= ((uint32_t)Conversion_Raw(&data[2 * axis]) & BITPACK_MASK) << bit_count;
+            bit_count += BITPACK_BITS;
+            
+            while (bit_count >= 8)
+            {
+                *out++ = (uint8_t)bit_buffer;
+                bit_buffer >>= 8;
+                bit_count -= 8;
+            }
+        }
+        
+        return out;
+    }
+    
+    
+    
+    uint8_t* BitPack_Finish(uint8_t* out)
+    {
+        if (bit_count > 0)
+        {
+            *out++ = (uint8_t)bit_buffer;
+            bit_buffer = 0;
+            bit_count = 0;
+        }
+        
+        return out;
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,100 @@
+/** 
+ * \file Conversion.h
+ * \brief Conversion of the accelerometer samples.
+ *
+ * The conversion kernel is specialised at compile time from the acquisition
+ * profile (see LIS3DH_Profile.h): shift, scale and output unit are 
+ * constants, so each axis costs one shift and one integer multiply with no 
+ * runtime branching. The Cortex-M3 has no FPU, hence no float or double 
+ * arithmetic is used: m/s2 are Q16.16 fixed-point numbers (16 integer bits,
+ * 16 fractional bits).
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef Conversion_H
+    #define Conversion_H
+    
+    #include "cytypes.h"
+    #include "string.h"
+    #include "LIS3DH_Profile.h"
+    
+    /**
+    *   \brief Gravity acceleration (m/s2). Only used in constant expressions.
+    */
+    #define CONVERSION_GRAVITY 9.81
+    
+    /**
+    *   \brief Fractional bits of the m/s2 conversion factor.
+    */
+    #define CONVERSION_FACTOR_BITS 28
+    
+    /**
+    *   \brief Conversion factor from a right-justified sample to m/s2, with 
+    *   CONVERSION_FACTOR_BITS fractional bits.
+    *
+    *   The expression is folded by the compiler: no floating point code is 
+    *   generated. The largest factor (192 mg/digit) fits in int32.
+    */
+    #define CONVERSION_MS2_FACTOR \
+        ((int32_t)(LIS3DH_PROFILE_SENSITIVITY_MG * CONVERSION_GRAVITY / 1000.0 * \
+                   (double)(1UL << CONVERSION_FACTOR_BITS) + 0.5))
+    
+    /**
+    *   \brief Right-justify a sample (digits, before the sensitivity is applied).
+    *
+    *   \param data Pointer to the LSB and MSB output registers of one axis.
+    */
+    static inline int16_t Conversion_Raw(const uint8_t* data)
+    {
+        return (int16_t)(data[0] | (data[1] << 8)) >> LIS3DH_PROFILE_SHIFT;
+    }
+    
+    /**
+    *   \brief Convert a sample into the ACC_OUTPUT_UNIT unit.
+    *
+    *   \param data Pointer to the LSB and MSB output registers of one axis.
+    *   \retval Acceleration in mg (UNIT_MG) or in m/s2, Q16.16 format 
+    *           (UNIT_MS2_Q16).
+    */
+    static inline int32_t Conversion_Sample(const uint8_t* data)
+    {
+        int16_t raw = Conversion_Raw(data);
+        
+#if (ACC_OUTPUT_UNIT == UNIT_MG)
+        // Datasheet sensitivities are whole mg/digit: the result is exact
+        return (int32_t)raw * LIS3DH_PROFILE_SENSITIVITY_MG;
+#elif (ACC_OUTPUT_UNIT == UNIT_MS2_Q16)
+        // 32x32 -> 64 bit product is a single SMULL instruction
+        return (int32_t)(((int64_t)raw * CONVERSION_MS2_FACTOR) >> (CONVERSION_FACTOR_BITS - 16));
+#else
+        #error "ACC_OUTPUT_UNIT must be one of the UNIT_* values"
+#endif
+    }
+    
+#if (ACC_OUTPUT_UNIT == UNIT_MS2_Q16)
+    /**
+    *   \brief Write an acceleration value in m/s2 in the output frame.
+    *
+    *   The value is written in the OUTPUT_FORMAT encoding, LSB first. The 
+    *   float conversion is exact since |value| < 2^24.
+    *   \param out Pointer to the 4 bytes of the frame to be written.
+    *   \param value Acceleration in m/s2, Q16.16 format.
+    */
+    static inline void Conversion_EncodeMs2(uint8_t* out, int32_t value)
+    {
+#if (OUTPUT_FORMAT == OUTPUT_FORMAT_FLOAT)
+        float32 value_f = (float32)value * (1.0f / 65536.0f);
+        
+        memcpy(out, &value_f, sizeof(value_f));
+#else
+        out[0] = (uint8_t)(value & 0xFF);
+        out[1] = (uint8_t)((value >> 8) & 0xFF);
+        out[2] = (uint8_t)((value >> 16) & 0xFF);
+        out[3] = (uint8_t)((value >> 24) & 0xFF);
+#endif
+    }
+#endif
+    
+#endif // Conversion_H
+/* [] END OF FILE */
@@ -0,0 +1,114 @@
+/*
+* This file includes all the required source code to
+* decimate the samples read at a high output data rate.
+*/
+
+#include "Decimator.h"
+#include "Conversion.h"
+#include "macro_definition.h"
+
+/**
+*   \brief Gain of the decimator: DECIMATION_RATIO ^ DECIMATION_ORDER.
+*/
+#define DECIMATION_GAIN ((int32_t)DECIMATION_RATIO * (DECIMATION_ORDER > 1 ? DECIMATION_RATIO : 1) * \
+                         (DECIMATION_ORDER > 2 ? DECIMATION_RATIO : 1))
+
+// 12-bit samples: the outputs of the combs must fit int32
+#if (DECIMATION_RATIO * (DECIMATION_ORDER > 1 ? DECIMATION_RATIO : 1) * \
+     (DECIMATION_ORDER > 2 ? DECIMATION_RATIO : 1) > (1L << 20))
+    #error "DECIMATION_RATIO ^ DECIMATION_ORDER must not exceed 2^20"
+#endif
+
+/**
+*   \brief Range of the output, in digits.
+*/
+#define DECIMATION_OUTPUT_MAX ((1L << (LIS3DH_PROFILE_RESOLUTION_BITS - 1)) - 1)
+#define DECIMATION_OUTPUT_MIN (-(1L << (LIS3DH_PROFILE_RESOLUTION_BITS - 1)))
+
+static uint32_t integrators[3][DECIMATION_ORDER];   // Running sums, modulo 2^32
+static uint32_t combs[3][DECIMATION_ORDER];         // Input of each comb at the previous output
+static uint8_t phase = 0;                           // Samples since the last output
+static uint8_t previous_axes = 0;                   // Axes of the last call
+
+    void Decimator_Start(void)
+    {
+        memset(integrators, 0, sizeof(integrators));
+        memset(combs, 0, sizeof(combs));
+        phase = 0;
+    }
+    
+    
+    
+    uint8_t Decimator_Process(uint8_t* samples, uint8_t sample_count, uint8_t axes)
+    {
+        uint8_t* in = samples;
+        uint8_t* out = samples;
+        uint8_t output_count = 0;
+        
+        // The sums of an axis just enabled would hold old samples
+        if (axes != previous_axes)
+        {
+            Decimator_Start();
+            previous_axes = axes;
+        }
+        
+        for (uint8_t s = 0; s < sample_count; s++, in += LIS3DH_SAMPLE_SIZE)
+        {
+            uint8_t axis;
+            
+            // Integrators at the rate of the sensor
+            for (axis = 0; axis < 3; axis++)
+            {
+                if (axes & (1 << axis))
+                {
+                    uint32_t value = (uint32_t)(int32_t)Conversion_Raw(&in[2 * axis]);
+                    
+                    for (uint8_t k = 0; k < DECIMATION_ORDER; k++)
+                    {
+                        integrators[axis][k] += value;
+                        value = integrators[axis][k];
+                    }
+                }
+            }
+            
+            if (++phase < DECIMATION_RATIO)
+            {
+                continue;
+            }
+            phase = 0;
+            
+            // Combs at the output rate, written over the samples already used (out is never after in)
+            for (axis = 0; axis < 3; axis++)
+            {
+                if (axes & (1 << axis))
+                {
+                    uint32_t value = integrators[axis][DECIMATION_ORDER - 1];
+                    
+                    for (uint8_t k = 0; k < DECIMATION_ORDER; k++)
+                    {
+                        uint32_t difference = value - combs[axis][k];
+                        
+                        combs[axis][k] = value;
+                        value = difference;
+                    }
+                    
+                    // Rounded average (the divisor is a constant: no division instruction)
+                    int32_t sum = (int32_t)value;
+                    int32_t average = (sum + ((sum >= 0) ? DECIMATION_GAIN / 2 : -(DECIMATION_GAIN / 2))) / DECIMATION_GAIN;
+                    
+                    average = (average > DECIMATION_OUTPUT_MAX) ? DECIMATION_OUTPUT_MAX :
+                              (average < DECIMATION_OUTPUT_MIN) ? DECIMATION_OUTPUT_MIN : average;
+                    uint16_t register_value = (uint16_t)((uint32_t)average << LIS3DH_PROFILE_SHIFT);
+                    
+                    out[2 * axis] = (uint8_t)(register_value & 0xFF);
+                    out[2 * axis + 1] = (uint8_t)(register_value >> 8);
+                }
+            }
+            out += LIS3DH_SAMPLE_SIZE;
+            output_count++;
+        }
+        
+        return output_count;
+    }
+
+/* [] END OF FILE */
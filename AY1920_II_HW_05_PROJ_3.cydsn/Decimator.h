@@ -0,0 +1,54 @@
+/**
+ * \file Decimator.h
+ * \brief Decimation of the samples read at a high output data rate (DECIMATION_RATIO).
+ *
+ * The sensor runs at ACC_ODR and one sample every DECIMATION_RATIO is sent:
+ * each axis goes through a CIC decimator (cascaded integrator-comb) of
+ * DECIMATION_ORDER stages, namely the integrators at the rate of the
+ * sensor, then the combs at the output rate. With one stage the output is
+ * the average of the last DECIMATION_RATIO samples (boxcar); every stage
+ * more widens the rejection of the noise above the output Nyquist
+ * frequency, and the droop in the pass band. Integer arithmetic only: the
+ * sums wrap around modulo 2^32 and the combs undo the wrap, the output is
+ * the sum divided by the gain (DECIMATION_RATIO ^ DECIMATION_ORDER),
+ * rounded to the resolution of the profile.
+ * The decimated samples take the place of the samples read, at the start
+ * of the read buffer: the rest of the loop (filter, frames, sequence
+ * numbers) sees DECIMATION_OUTPUT_ODR_HZ. With more stages the first
+ * DECIMATION_ORDER - 1 outputs rise from 0, and so after a change of the
+ * axes (the decimator starts again).
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef Decimator_H
+    #define Decimator_H
+    
+    #include "cytypes.h"
+    #include "LIS3DH_Profile.h"
+    #include "macro_definition.h"
+    
+    /**
+    *   \brief Rate of the samples sent (Hz, rounded).
+    */
+    #define DECIMATION_OUTPUT_ODR_HZ ((LIS3DH_PROFILE_ODR_HZ + DECIMATION_RATIO / 2) / DECIMATION_RATIO)
+    
+    /**
+    *   \brief Clear the integrators and the combs.
+    */
+    void Decimator_Start(void);
+    
+    /**
+    *   \brief Decimate the samples of a read, in place.
+    *
+    *   \param samples Output registers of the samples (LIS3DH_SAMPLE_SIZE
+    *          bytes each, X first), left-justified as read.
+    *   \param sample_count Number of samples.
+    *   \param axes Axes to be decimated (the enabled ones, see LIS3DH_GetAxes()).
+    *   \retval Number of decimated samples, written from the first one on
+    *           (0 until DECIMATION_RATIO samples have been read).
+    */
+    uint8_t Decimator_Process(uint8_t* samples, uint8_t sample_count, uint8_t axes);
+
+#endif // Decimator_H
+/* [] END OF FILE */
@@ -0,0 +1,54 @@
+/**
+ * \file DeltaCodec.h
+ * \brief Lossless compression of the samples (FRAME_FORMAT_DELTA).
+ *
+ * At rest consecutive samples differ by a few digits, so each axis is sent
+ * as the difference from the previous sample: zigzag mapped (0, -1, 1, -2..
+ * become 0, 1, 2, 3..) and written 7 bits per byte, bit 7 set when another
+ * byte follows. A difference within ±63 digits takes one byte instead of 2
+ * (mg) or 4 (m/s2). The right-justified values are encoded: the host applies
+ * the sensitivity, sent in the keyframes, and gets exactly the values of
+ * the uncompressed formats.
+ * Every DELTA_KEYFRAME_PACKETS packets, after samples dropped by the
+ * transmit ring and when the axes change, the first sample is sent relative to zero (keyframe): a
+ * packet is decoded only if it is a keyframe or follows the previous one
+ * without a gap in the sequence numbers, hence after a lost packet the host
+ * resumes at the next keyframe.
+ *
+ * Packet (see Packet.h), before COBS encoding:
+ *   sequence (2)  count | PACKET_DELTA [| PACKET_KEYFRAME]  axes
+ *   [sensitivity in mg/digit, keyframes only]
+ *   enabled axes (X, Y, Z) of each sample (1-3 bytes each)
+ *   CRC16 (2)
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef DeltaCodec_H
+    #define DeltaCodec_H
+    
+    #include "cytypes.h"
+    
+    /**
+    *   \brief Write the header of a packet.
+    *
+    *   \param frame Frame buffer.
+    *   \param sequence Index of the first sample of the packet.
+    *   \param sample_count Number of samples of the packet.
+    *   \param axes Axes of the samples.
+    *   \retval Position of the first sample in the frame.
+    */
+    uint8_t* DeltaCodec_Start(uint8_t* frame, uint16_t sequence, uint8_t sample_count, uint8_t axes);
+    
+    /**
+    *   \brief Encode a sample.
+    *
+    *   \param out Position of the sample in the frame.
+    *   \param data Output registers of the three axes (6 bytes, X first).
+    *   \param axes Axes to be encoded, the same given to DeltaCodec_Start().
+    *   \retval Position of the next sample (at most 9 bytes after out).
+    */
+    uint8_t* DeltaCodec_Encode(uint8_t* out, const uint8_t* data, uint8_t axes);
+
+#endif // DeltaCodec_H
+/* [] END OF FILE */
@@ -0,0 +1,167 @@
+/*
+* This file includes all the required source code to
+* filter the samples with the biquad chains of the axes.
+*/
+
+#include "Filter.h"
+#include "FilterCoefficients.h"
+#include "Conversion.h"
+#include "Decimator.h"
+#include "macro_definition.h"
+
+#if (FILTER_X_SECTIONS > FILTER_MAX_SECTIONS || FILTER_Y_SECTIONS > FILTER_MAX_SECTIONS || \
+     FILTER_Z_SECTIONS > FILTER_MAX_SECTIONS)
+    #error "FilterCoefficients.h has more than FILTER_MAX_SECTIONS sections"
+#endif
+
+#if (USE_FILTER && FILTER_DESIGN_ODR_HZ != DECIMATION_OUTPUT_ODR_HZ)
+    #error "FilterCoefficients.h was designed for another output data rate (see Host_Tools/FilterDesign)"
+#endif
+
+/**
+*   \brief Samples filtered at once (a whole FIFO burst in ACQ_MODE_FIFO).
+*/
+#define FILTER_BATCH (ACC_DATA_SIZE / LIS3DH_SAMPLE_SIZE)
+
+/**
+*   \brief Range of the output, in digits.
+*/
+#define FILTER_OUTPUT_MAX ((1L << (LIS3DH_PROFILE_RESOLUTION_BITS - 1)) - 1)
+#define FILTER_OUTPUT_MIN (-(1L << (LIS3DH_PROFILE_RESOLUTION_BITS - 1)))
+
+/**
+*   \brief Range of the states (Q16.16).
+*/
+#define FILTER_STATE_MAX ((int32_t)0x7FFFFFFF)
+#define FILTER_STATE_MIN (-FILTER_STATE_MAX - 1)
+
+static const Filter_Section table_x[] = FILTER_X_COEFFICIENTS;
+static const Filter_Section table_y[] = FILTER_Y_COEFFICIENTS;
+static const Filter_Section table_z[] = FILTER_Z_COEFFICIENTS;
+
+static const Filter_Chain table_chains[3] = {
+    {FILTER_X_SECTIONS, table_x},
+    {FILTER_Y_SECTIONS, table_y},
+    {FILTER_Z_SECTIONS, table_z},
+};
+
+static const Filter_Chain* chains = table_chains;
+static int32_t states[3][FILTER_MAX_SECTIONS][4];  // x[n-1], x[n-2], y[n-1], y[n-2] of each section, Q16.16
+
+    // Run a section over the batch, in place: the state stays in registers, 5 long multiply-accumulates per sample
+    static void Filter_RunSection(const Filter_Section* section, int32_t* state, int32_t* batch, uint8_t count)
+    {
+        const int32_t b0 = section->b0;
+        const int32_t b1 = section->b1;
+        const int32_t b2 = section->b2;
+        const int32_t a1 = section->a1;
+        const int32_t a2 = section->a2;
+        int32_t x1 = state[0];
+        int32_t x2 = state[1];
+        int32_t y1 = state[2];
+        int32_t y2 = state[3];
+        
+        for (uint8_t s = 0; s < count; s++)
+        {
+            int32_t x0 = batch[s];
+            int64_t sum = (int64_t)1 << (FILTER_COEFFICIENT_BITS - 1);  // Rounding
+            
+            sum += (int64_t)b0 * x0;
+            sum += (int64_t)b1 * x1;
+            sum += (int64_t)b2 * x2;
+            sum += (int64_t)a1 * y1;
+            sum += (int64_t)a2 * y2;
+            sum >>= FILTER_COEFFICIENT_BITS;
+            
+            // Saturation: an unstable or too loud chain does not wrap around
+            int32_t y0 = (sum > FILTER_STATE_MAX) ? FILTER_STATE_MAX : (sum < FILTER_STATE_MIN) ? FILTER_STATE_MIN : (int32_t)sum;
+            
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            batch[s] = y0;
+        }
+        
+        state[0] = x1;
+        state[1] = x2;
+        state[2] = y1;
+        state[3] = y2;
+    }
+    
+    
+    
+    ErrorCode Filter_Start(const Filter_Chain* new_chains)
+    {
+        if (new_chains == NULL)
+        {
+            new_chains = table_chains;
+        }
+        for (uint8_t axis = 0; axis < 3; axis++)
+        {
+            if (new_chains[axis].sections > FILTER_MAX_SECTIONS)
+            {
+                return ERROR;
+            }
+        }
+        
+        chains = new_chains;
+        memset(states, 0, sizeof(states));
+        
+        return NO_ERROR;
+    }
+    
+    
+    
+    void Filter_Process(uint8_t* samples, uint8_t sample_count, uint8_t axes)
+    {
+        int32_t batch[FILTER_BATCH];
+        
+        while (sample_count > 0)
+        {
+            uint8_t count = (sample_count < FILTER_BATCH) ? sample_count : FILTER_BATCH;
+            
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                const Filter_Chain* chain = &chains[axis];
+                uint8_t* data = &samples[2 * axis];
+                uint8_t s;
+                
+                if (!(axes & (1 << axis)) || chain->sections == 0)
+                {
+                    continue;
+                }
+                
+                // Right-justified digits, Q16.16
+                for (s = 0; s < count; s++, data += LIS3DH_SAMPLE_SIZE)
+                {
+                    batch[s] = (int32_t)Conversion_Raw(data) << 16;
+                }
+                
+                // A section at a time over the whole batch
+                for (uint8_t k = 0; k < chain->sections; k++)
+                {
+                    Filter_RunSection(&chain->section[k], states[axis][k], batch, count);
+                }
+                
+                // Back to left-justified output registers, rounded and saturated
+                data = &samples[2 * axis];
+                for (s = 0; s < count; s++, data += LIS3DH_SAMPLE_SIZE)
+                {
+                    int32_t value = ((batch[s] >> 15) + 1) >> 1;
+                    
+                    value = (value > FILTER_OUTPUT_MAX) ? FILTER_OUTPUT_MAX :
+                            (value < FILTER_OUTPUT_MIN) ? FILTER_OUTPUT_MIN : value;
+                    uint16_t out = (uint16_t)((uint32_t)value << LIS3DH_PROFILE_SHIFT);
+                    
+                    data[0] = (uint8_t)(out & 0xFF);
+                    data[1] = (uint8_t)(out >> 8);
+                }
+            }
+            
+            samples += count * LIS3DH_SAMPLE_SIZE;
+            sample_count -= count;
+        }
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,39 @@
+/**
+ * \file FilterCoefficients.h
+ * \brief Biquad chains of the axes (see Filter.h), written by Host_Tools/FilterDesign:
+ *        FilterDesign -o ../AY1920_II_HW_05_PROJ_2.cydsn/FilterCoefficients.h xyz:lowpass:10
+ *
+ *   X: lowpass 10 Hz, Butterworth of order 4
+ *   Y: lowpass 10 Hz, Butterworth of order 4
+ *   Z: lowpass 10 Hz, Butterworth of order 4
+ * Coefficients b0, b1, b2, -a1, -a2 in Q2.30 (see Filter_Section).
+*/
+
+#ifndef FilterCoefficients_H
+    #define FilterCoefficients_H
+    
+    /**
+    *   \brief Output data rate of the design: it must be the one of the profile.
+    */
+    #define FILTER_DESIGN_ODR_HZ 100
+    
+    #define FILTER_X_SECTIONS 2
+    #define FILTER_X_COEFFICIENTS { \
+        {65038882, 130077764, 65038882, 1102036504, -288450209}, /* 10 Hz, Q 0.5098 */ \
+        {68873150, 137746301, 68873150, 1167005387, -368756164}, /* 10 Hz, Q 0.6013 */ \
+    }
+    
+    #define FILTER_Y_SECTIONS 2
+    #define FILTER_Y_COEFFICIENTS { \
+        {65038882, 130077764, 65038882, 1102036504, -288450209}, /* 10 Hz, Q 0.5098 */ \
+        {68873150, 137746301, 68873150, 1167005387, -368756164}, /* 10 Hz, Q 0.6013 */ \
+    }
+    
+    #define FILTER_Z_SECTIONS 2
+    #define FILTER_Z_COEFFICIENTS { \
+        {65038882, 130077764, 65038882, 1102036504, -288450209}, /* 10 Hz, Q 0.5098 */ \
+        {68873150, 137746301, 68873150, 1167005387, -368756164}, /* 10 Hz, Q 0.6013 */ \
+    }
+
+#endif // FilterCoefficients_H
+/* [] END OF FILE */
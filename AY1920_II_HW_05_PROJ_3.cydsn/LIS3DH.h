@@ -0,0 +1,117 @@
+/** 
+ * \file LIS3DH.h
+ * \brief LIS3DH accelerometer driver.
+ *
+ * This is the interface to the LIS3DH accelerometer. It relies on the 
+ * I2C_Interface functions, hence it does not depend on the platform.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef LIS3DH_H
+    #define LIS3DH_H
+    
+    #include "cytypes.h"
+    #include "ErrorCodes.h"
+    #include "I2C_Interface.h"
+    #include "macro_definition.h"
+    
+    /**
+    *   \brief Start the reading of a sample.
+    *
+    *   This function starts a non-blocking burst of up to 
+    *   LIS3DH_SAMPLE_BURST_SIZE registers: STATUS_REG and the output 
+    *   registers (OUT_X_L..OUT_Z_H) are adjacent, so a single auto-increment
+    *   transaction returns the status and the sample together, whether the 
+    *   sample is new or not (see LIS3DH_IsNewSample()). With BDU the output
+    *   registers are not updated while they are read: the burst never mixes
+    *   two samples. Use I2C_Peripheral_AsyncPoll() or 
+    *   I2C_Peripheral_AsyncWait() to know when the read is over.
+    *   The burst ends at the last axis enabled by LIS3DH_SetAxes(). With 
+    *   USE_INT1 the wake on INT1 means new data: the status is set to ZYXDA 
+    *   and a single burst starts at the first enabled axis, in low power 
+    *   mode at its high byte (the 8-bit data). The layout is always the 
+    *   same, the registers which are not read are left as they are.
+    *   \param burst Array of LIS3DH_SAMPLE_BURST_SIZE bytes where the status 
+    *          (burst[0]) and the data (burst[1..6]) will be saved.
+    */
+    ErrorCode LIS3DH_ReadSampleAsync(uint8_t* burst);
+    
+    /**
+    *   \brief Select the axes to be acquired.
+    *
+    *   This function sets the Xen, Yen, Zen bits of the Control register 1
+    *   (through the configuration shadow, see LIS3DH_Config.h) and shortens
+    *   the burst of LIS3DH_ReadSampleAsync() accordingly. The caller sends
+    *   the enabled axes only (see LIS3DH_GetAxes()), starting from the next
+    *   frame. In ACQ_MODE_FIFO the whole samples are still read.
+    *   \param axes ACC_AXIS_X, ACC_AXIS_Y, ACC_AXIS_Z or a combination.
+    *   \retval ERROR if no axis is selected or the I2C communication fails.
+    */
+    ErrorCode LIS3DH_SetAxes(uint8_t axes);
+    
+    /**
+    *   \brief Get the axes enabled by LIS3DH_SetAxes() (ACC_AXES at boot).
+    */
+    uint8_t LIS3DH_GetAxes(void);
+    
+    /**
+    *   \brief Check if a burst contains a new sample.
+    *
+    *   The burst is new when the ZYXDA bit (or the XDA, YDA, ZDA bit of an
+    *   enabled axis) of the Status register is set. Since the Status 
+    *   register is shifted out before the data, whose read clears the data
+    *   ready bits, a sample which is ready right after the status byte is 
+    *   also recognised by comparing the data with the last accepted sample.
+    *   An overrun bit in the status of a new sample is counted (see 
+    *   LIS3DH_GetOverruns()). Stale data must be discarded by the caller.
+    *   \param burst Array filled by LIS3DH_ReadSampleAsync().
+    *   \retval Returns true (>0) if the data bytes hold a new sample.
+    */
+    uint8_t LIS3DH_IsNewSample(const uint8_t* burst);
+    
+    /**
+    *   \brief Enable the FIFO in Stream mode.
+    *
+    *   This function sets the FIFO_EN bit of the Control register 5 and 
+    *   configures the FIFO Control register in Stream mode with the given
+    *   watermark level.
+    *   \param watermark FIFO level (in samples, max 31) that sets the WTM bit.
+    */
+    ErrorCode LIS3DH_FifoStart(uint8_t watermark);
+    
+    /**
+    *   \brief Drain the FIFO.
+    *
+    *   This function reads the FIFO Source register and, if the watermark has 
+    *   been reached, reads all the stored samples in a single burst of up to 
+    *   LIS3DH_FIFO_SIZE * LIS3DH_SAMPLE_SIZE bytes. In FIFO mode the register
+    *   address rolls back to OUT_X_L after OUT_Z_H, so consecutive samples 
+    *   come out one after the other. The FIFO Source register read after 
+    *   the burst tells whether the FIFO was full while it was read: a full 
+    *   FIFO overwrites the sample being read. The oldest sample of a burst
+    *   started on a full FIFO is refused, the whole burst if the FIFO was 
+    *   full again later (an overrun each).
+    *   \param data Array of LIS3DH_FIFO_SIZE * LIS3DH_SAMPLE_SIZE bytes where 
+    *          the samples will be saved.
+    *   \param sample_count Pointer to a variable where the number of samples
+    *          read will be saved (0 if the watermark has not been reached).
+    */
+    ErrorCode LIS3DH_FifoRead(uint8_t* data, uint8_t* sample_count);
+    
+    /**
+    *   \brief Get the number of overruns.
+    *
+    *   An overrun is a read which finds that the sensor overwrote data which
+    *   was never read: ZYXOR (or XOR, YOR, ZOR of an enabled axis) in the
+    *   burst checked by LIS3DH_IsNewSample(), OVRN_FIFO in 
+    *   LIS3DH_FifoRead() (the FIFO was full) or a burst refused by it. Each
+    *   one stands for one sample lost at least.
+    *   With USE_INT1 in ACQ_MODE_POLLING the Status register is not read and
+    *   the overruns are not seen (the torn samples are counted by 
+    *   LIS3DH_Interrupt_Updated()).
+    */
+    uint32_t LIS3DH_GetOverruns(void);
+    
+#endif // LIS3DH_H
+/* [] END OF FILE */
@@ -0,0 +1,277 @@
+/*
+* This file includes all the required source code to poll
+* the LIS3DH accelerometer at the ticks of a timer.
+*/
+
+#include "LIS3DH_Schedule.h"
+#include "LIS3DH.h"
+#include "LIS3DH_Profile.h"
+#include "macro_definition.h"
+#include "project.h"
+
+/**
+*   \brief Nominal period (timer counts per sample), least guard interval
+*   after the data ready, bounds of the margin kept below the sample period and of the
+*   estimated sample period.
+*/
+#define SCHEDULE_PERIOD (POLL_TIMER_CLOCK_HZ / LIS3DH_PROFILE_ODR_HZ)
+#define SCHEDULE_GUARD (SCHEDULE_PERIOD / 8)
+#define SCHEDULE_MARGIN_MIN ((SCHEDULE_PERIOD / 512) ? (SCHEDULE_PERIOD / 512) : 1)
+#define SCHEDULE_MARGIN_MAX (SCHEDULE_PERIOD / 4)
+#define SCHEDULE_PERIOD_MIN (SCHEDULE_PERIOD - SCHEDULE_PERIOD / 8)
+#define SCHEDULE_PERIOD_MAX (SCHEDULE_PERIOD + SCHEDULE_PERIOD / 8)
+
+/**
+*   \brief Fractional bits of the times and of the estimated sample period.
+*/
+#define SCHEDULE_FRACTION 8
+
+/**
+*   \brief Most sample periods between two measured data ready for a new
+*   estimate (the time between them fits int32).
+*/
+#define SCHEDULE_SPAN_MAX (0x7FFFFFFFUL / ((uint32_t)SCHEDULE_PERIOD_MAX << SCHEDULE_FRACTION))
+
+#if (USE_POLL_TIMER && (SCHEDULE_PERIOD_MAX + SCHEDULE_GUARD > 65536 || SCHEDULE_PERIOD < 64))
+    #error "POLL_TIMER_CLOCK_HZ does not fit the output data rate: 64..52428 counts per sample (16-bit timer)"
+#endif
+
+// Times in timer counts with SCHEDULE_FRACTION fractional bits, modulo 2^32
+static volatile uint8_t tick_count = 0;       // Ticks not yet served
+static volatile uint32_t tick_time = 0;       // Time of the last tick
+static volatile uint32_t running = SCHEDULE_PERIOD; // Counts of the interval started at the last tick
+static uint32_t programmed = SCHEDULE_PERIOD; // Period register (+1): interval started at the next tick
+static uint32_t poll_time = 0;                // Time of the current read
+static uint32_t last_poll = 0;                // Time of the previous read
+static uint32_t sample_period = (uint32_t)SCHEDULE_PERIOD << SCHEDULE_FRACTION; // Estimated sample period
+static uint32_t margin = (uint32_t)SCHEDULE_MARGIN_MIN << SCHEDULE_FRACTION; // Kept below the sample period
+static uint32_t next_ready = 0;               // Predicted data ready of the next sample
+static uint32_t anchor = 0;                   // Data ready measured last
+static uint32_t anchor_gap = 0;               // Time between the two reads around it
+static uint32_t anchor_samples = 0;           // Data ready since then, the last one read included
+static uint32_t guard = (uint32_t)SCHEDULE_GUARD << SCHEDULE_FRACTION; // Tick after the predicted data ready
+static uint8_t measurements = 0;              // Data ready measured (up to 2)
+static uint8_t hunting = 1;                   // Reads back to back until a data ready is measured
+static uint8_t bounded = 0;                   // The previous read found no new data
+static LIS3DH_Schedule_Stats schedule_stats = {0, 0, 0, 0, 0, 0};
+
+#if (USE_POLL_TIMER)
+    CY_ISR(LIS3DH_Schedule_ISR)
+    {
+        // Clear the terminal count to be ready for the next tick
+        Timer_Poll_ReadStatusRegister();
+        tick_time += running << SCHEDULE_FRACTION;
+        running = programmed;
+        if (tick_count < 255)
+        {
+            tick_count++;
+        }
+    }
+    
+    
+    
+    // Time of the read: the last tick plus the counts since (the counter goes from the period value down to 0)
+    static uint32_t LIS3DH_Schedule_Now(void)
+    {
+        uint32_t time;
+        uint32_t elapsed;
+        
+        do
+        {
+            time = tick_time;
+            elapsed = running - 1 - Timer_Poll_ReadCounter();
+        } while (time != tick_time); //A tick meanwhile: the counter was reloaded
+        return time + (elapsed << SCHEDULE_FRACTION);
+    }
+#endif
+
+
+    // Data ready between the previous read (no new data) and this one: phase and sample period
+    static void LIS3DH_Schedule_Measure(void)
+    {
+        uint32_t gap = poll_time - last_poll;
+        uint32_t ready = last_poll + gap / 2;
+        
+        if (measurements > 0 && anchor_samples <= SCHEDULE_SPAN_MAX)
+        {
+            // The time since the previous measurement over the data ready counted since, within half
+            // of both gaps: the estimate is kept that much short of it (the ticks drift towards a
+            // stale read, which costs one read, and not towards an overrun, which costs a sample)
+            uint32_t period = (ready - anchor) / anchor_samples;
+            uint32_t error = (gap + anchor_gap) / 2 / anchor_samples;
+            
+            period = (period < ((uint32_t)SCHEDULE_PERIOD_MIN << SCHEDULE_FRACTION)) ?
+                     ((uint32_t)SCHEDULE_PERIOD_MIN << SCHEDULE_FRACTION) :
+                     (period > ((uint32_t)SCHEDULE_PERIOD_MAX << SCHEDULE_FRACTION)) ?
+                     ((uint32_t)SCHEDULE_PERIOD_MAX << SCHEDULE_FRACTION) : period;
+            margin = (error < ((uint32_t)SCHEDULE_MARGIN_MIN << SCHEDULE_FRACTION)) ?
+                     ((uint32_t)SCHEDULE_MARGIN_MIN << SCHEDULE_FRACTION) :
+                     (error > ((uint32_t)SCHEDULE_MARGIN_MAX << SCHEDULE_FRACTION)) ?
+                     ((uint32_t)SCHEDULE_MARGIN_MAX << SCHEDULE_FRACTION) : error;
+            sample_period = period;
+        }
+        anchor = ready;
+        anchor_gap = gap;
+        
+        // The data ready is known within the gap, a read long: the ticks fall at least that much after it,
+        // else the margin outgrows the guard interval and every few ticks find no new data
+        guard = (gap > ((uint32_t)SCHEDULE_GUARD << SCHEDULE_FRACTION)) ? gap :
+                ((uint32_t)SCHEDULE_GUARD << SCHEDULE_FRACTION);
+        anchor_samples = 0;
+        next_ready = ready + sample_period - margin;
+        
+        // The first measurement gives the phase only: the next data ready is measured too
+        if (measurements < 2)
+        {
+            measurements++;
+        }
+        hunting = (measurements < 2);
+    }
+    
+    
+    
+    void LIS3DH_Schedule_Start(void)
+    {
+#if (USE_POLL_TIMER)
+        schedule_stats.period = SCHEDULE_PERIOD;
+        
+        // The counter goes from the period value down to 0: period + 1 counts
+        Timer_Poll_WritePeriod(programmed - 1);
+        Timer_Poll_Start();
+        isr_Poll_StartEx(LIS3DH_Schedule_ISR);
+#endif
+    }
+    
+    
+    
+    void LIS3DH_Schedule_Wait(uint8_t (*idle)(void))
+    {
+#if (USE_POLL_TIMER)
+        uint8_t interrupt_state;
+        
+        // Looking for a data ready: no wait
+        while (!tick_count && !hunting)
+        {
+            // No sleep while there is work: the tick is not served later than a call
+            if (idle != NULL && idle())
+            {
+                continue;
+            }
+            
+            // WFI wakes up on a pending interrupt even if interrupts are masked
+            interrupt_state = CyEnterCriticalSection();
+            if (!tick_count)
+            {
+                CY_PM_WFI;
+            }
+            CyExitCriticalSection(interrupt_state);
+        }
+        
+        interrupt_state = CyEnterCriticalSection();
+        if (!hunting && tick_count > 1)
+        {
+            schedule_stats.late_ticks += tick_count - 1;
+        }
+        tick_count = 0;
+        CyExitCriticalSection(interrupt_state);
+        
+        poll_time = LIS3DH_Schedule_Now();
+#else
+        (void)idle;
+#endif
+    }
+    
+    
+    
+    void LIS3DH_Schedule_Update(uint8_t status)
+    {
+        uint8_t axes = LIS3DH_GetAxes();
+        uint32_t predicted = sample_period - margin;
+        int32_t ahead = (int32_t)(poll_time - next_ready); //Time of the read after the predicted data ready
+        
+        schedule_stats.reads++;
+        
+        // XDA/YDA/ZDA and XOR/YOR/ZOR of the enabled axes stand for ZYXDA and ZYXOR
+        if (status & ((1 << ZYXDA) | axes))
+        {
+            // Data ready since the previous sample: the ones predicted up to the read (more than one
+            // if the loop was late), at least two with an overrun bit (the prediction lags)
+            uint32_t count = (measurements > 0 && ahead >= 0) ? 1 + (uint32_t)ahead / predicted : 1;
+            uint8_t lagging = (ahead < 0);
+            
+            if ((status & ((1 << ZYXOR) | (axes << 4))) && count == 1)
+            {
+                count = 2;
+                lagging = 1;
+            }
+            schedule_stats.samples++;
+            schedule_stats.overruns += count - 1;
+            if (anchor_samples <= SCHEDULE_SPAN_MAX)
+            {
+                anchor_samples += count;
+            }
+            
+            if (bounded)
+            {
+                LIS3DH_Schedule_Measure();
+            }
+            else
+            {
+                next_ready += count * predicted;
+                if (lagging)
+                {
+                    // Data ready earlier than predicted: measure the next one
+                    hunting = 1;
+                }
+            }
+            bounded = 0;
+        }
+        else
+        {
+            schedule_stats.stale_reads++;
+            if (ahead >= 0)
+            {
+                // After the predicted data ready: the data ready is later than predicted, measure it
+                hunting = 1;
+            }
+            bounded = hunting;
+        }
+        last_poll = poll_time;
+        
+        if (!hunting)
+        {
+            // The interval up to the next tick is already loaded: program the one after it to end a
+            // guard interval after the first data ready the next tick does not read
+            uint8_t interrupt_state = CyEnterCriticalSection();
+            uint32_t tick = tick_time + (running << SCHEDULE_FRACTION);
+            CyExitCriticalSection(interrupt_state);
+            uint32_t ready = next_ready;
+            int32_t after = (int32_t)(tick - ready);
+            uint32_t next;
+            
+            predicted = sample_period - margin;
+            if (after >= 0)
+            {
+                ready += ((uint32_t)after / predicted + 1) * predicted;
+            }
+            next = (ready - tick + guard) >> SCHEDULE_FRACTION;
+            if (next > ((sample_period + guard) >> SCHEDULE_FRACTION))
+            {
+                next = (sample_period + guard) >> SCHEDULE_FRACTION;
+            }
+            programmed = next;
+#if (USE_POLL_TIMER)
+            Timer_Poll_WritePeriod(programmed - 1);
+#endif
+        }
+        schedule_stats.period = sample_period >> SCHEDULE_FRACTION;
+    }
+    
+    
+    
+    void LIS3DH_Schedule_GetStats(LIS3DH_Schedule_Stats* stats)
+    {
+        *stats = schedule_stats;
+    }
+
+/* [] END OF FILE */
@@ -0,0 +1,85 @@
+/**
+ * \file LIS3DH_Schedule.h
+ * \brief Timer-scheduled polling of the LIS3DH (USE_POLL_TIMER).
+ *
+ * On boards without the INT1 line a PSoC timer ticks once per output data
+ * period: the acquisition loop sleeps between the ticks and reads the
+ * status and the sample once per tick, instead of polling the Status
+ * register back to back. The sensor and the PSoC run on different clocks,
+ * so the ticks follow the sensor: each tick is placed a guard interval
+ * (1/8 of the period) after the predicted data ready.
+ * The data ready is measured, not guessed from the tick which missed it:
+ * the time of each read is the time of the last tick (kept by the timer
+ * interrupt) plus the counter of the timer. At start, after a read which
+ * finds no new data past the predicted data ready and after a read which
+ * finds a new sample earlier than predicted (or an overwritten one), the
+ * loop reads back to back, without waiting for the ticks, until a new
+ * sample: the data ready is between the last stale read and that read.
+ *   - the sample period is the time between two measured data ready over
+ *     the data ready counted in between, its error half the time between
+ *     the reads around them over the same number;
+ *   - the prediction is kept that error (1/512 to 1/4 of the period)
+ *     short of the sample period: the ticks drift slowly towards a stale
+ *     read, which starts a measurement, and not towards an overrun;
+ *   - the data ready since the previous sample are counted from the
+ *     predicted ones up to the read: the samples missed while the loop was
+ *     late, or overwritten before a tick (ZYXOR), are all counted.
+ * A new period is loaded by the timer at its next terminal count, hence a
+ * prediction applies from the tick after the next one.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef LIS3DH_Schedule_H
+    #define LIS3DH_Schedule_H
+    
+    #include "cytypes.h"
+    
+    /**
+    *   \brief Scheduled polling instrumentation: reads / samples is the
+    *   number of reads per sample (1 at best), overruns the samples missed.
+    */
+    typedef struct {
+        uint32_t reads;         ///< Reads, at the ticks and back to back while measuring a data ready
+        uint32_t samples;       ///< Reads which found a new sample
+        uint32_t stale_reads;   ///< Reads which found no new data
+        uint32_t overruns;      ///< Samples missed: data ready not read before the next one
+        uint32_t late_ticks;    ///< Ticks without a read (the loop was busy for longer than a period)
+        uint16_t period;        ///< Estimated sample period, in timer counts
+    } LIS3DH_Schedule_Stats;
+    
+    /**
+    *   \brief Start the poll timer at the output data rate of the acquisition
+    *   profile (see LIS3DH_Profile.h).
+    */
+    void LIS3DH_Schedule_Start(void);
+    
+    /**
+    *   \brief Sleep until the next tick of the poll timer (no sleep while a
+    *   data ready is measured), then take the time of the read.
+    *
+    *   \param idle Work to be done instead of sleeping as long as it returns
+    *          true, one call at a time with the tick checked in between 
+    *          (e.g. TxQueue_Drain(), which feeds the UART without its TX 
+    *          interrupt), or NULL.
+    */
+    void LIS3DH_Schedule_Wait(uint8_t (*idle)(void));
+    
+    /**
+    *   \brief Count the samples missed, measure the data ready if due and
+    *   program the tick after the next one.
+    *
+    *   \param status Status register read after LIS3DH_Schedule_Wait(), with ZYXDA
+    *          set if the read found a new sample (see LIS3DH_IsNewSample()).
+    */
+    void LIS3DH_Schedule_Update(uint8_t status);
+    
+    /**
+    *   \brief Get the scheduled polling instrumentation.
+    *
+    *   \param stats Pointer to a structure where the statistics will be saved.
+    */
+    void LIS3DH_Schedule_GetStats(LIS3DH_Schedule_Stats* stats);
+
+#endif // LIS3DH_Schedule_H
+/* [] END OF FILE */
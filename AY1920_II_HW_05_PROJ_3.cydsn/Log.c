@@ -0,0 +1,206 @@
+/*
+* This file includes all the required source code to write
+* the diagnostic messages.
+*/
+
+#include "Log.h"
+#include "CycleCounter.h"
+#include "Packet.h"
+#include "macro_definition.h"
+#include "project.h"
+
+// The transmit ring holds the frames queued behind the longest line
+#if (LOG_RECORD_SIZE > TX_QUEUE_LINE_SIZE)
+    #error "LOG_RECORD_SIZE must not exceed TX_QUEUE_LINE_SIZE"
+#endif
+
+#if (LOG_FORMAT == LOG_FORMAT_BINARY)
+    /**
+    *   \brief Number of arguments of each message (the formats stay on the host).
+    */
+    #define LOG_ARGUMENTS(id, arguments, format) arguments,
+    
+    static const uint8_t log_arguments[LOG_MESSAGE_COUNT] = {LOG_MESSAGES(LOG_ARGUMENTS)};
+    
+    static uint16_t record_number = 0;  // Sequence number of the next record
+#else
+    /**
+    *   \brief Format of each message.
+    */
+    #define LOG_FORMAT_STRING(id, arguments, format) format,
+    
+    static const char* const log_formats[LOG_MESSAGE_COUNT] = {LOG_MESSAGES(LOG_FORMAT_STRING)};
+    
+#if (FRAME_FORMAT != FRAME_FORMAT_HEADER_TAIL)
+    static uint8_t line_start = 1;      // Next character starts a line ('#' first)
+#endif
+#endif
+
+static Log_Stats log_stats = {0, 0, 0, 0};
+
+#if (LOG_FORMAT == LOG_FORMAT_BINARY)
+    // Append a value as a base-128 varint, LSB first
+    static uint8_t* Log_Varint(uint8_t* out, uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            *out++ = (uint8_t)value | 0x80;
+            value >>= 7;
+        }
+        *out++ = (uint8_t)value;
+        return out;
+    }
+#else
+    // Append a value in base 10 or 16, padded on the left up to 'width' characters
+    static uint8_t Log_Number(char* out, uint8_t room, uint32_t value, uint8_t base,
+                              const char* digits, char pad, uint8_t width)
+    {
+        char reversed[10];
+        uint8_t count = 0;
+        uint8_t length = 0;
+        
+        do
+        {
+            reversed[count++] = digits[value % base];
+            value /= base;
+        } while (value);
+        
+        for (; width > count && length < room; width--)
+        {
+            out[length++] = pad;
+        }
+        while (count && length < room)
+        {
+            out[length++] = reversed[--count];
+        }
+        return length;
+    }
+#endif
+
+
+
+    uint8_t Log_FormatList(uint8_t* record, uint8_t id, va_list arguments)
+    {
+        uint32_t start = CycleCounter_Get();
+        uint32_t cycles;
+        uint8_t length;
+        
+#if (LOG_FORMAT == LOG_FORMAT_BINARY)
+        // The ID in place of the axes, the arguments in place of the samples
+        uint8_t* out = &record[PACKET_HEADER_SIZE];
+        
+        Packet_Start(record, record_number++, PACKET_LOG, id);
+        for (uint8_t i = log_arguments[id]; i; i--)
+        {
+            out = Log_Varint(out, va_arg(arguments, unsigned int));
+        }
+        length = Packet_Seal(record, out - &record[PACKET_HEADER_SIZE]);
+#else
+        const char* format = log_formats[id];
+        char* out = (char*)record;
+        
+        length = 0;
+        while (*format && length < LOG_RECORD_SIZE)
+        {
+#if (FRAME_FORMAT != FRAME_FORMAT_HEADER_TAIL)
+            // Lines between the packets start with '#' (see TxQueue_SetText())
+            if (line_start && *format != '#')
+            {
+                out[length++] = '#';
+            }
+            line_start = 0;
+#endif
+            if (*format != '%')
+            {
+#if (FRAME_FORMAT != FRAME_FORMAT_HEADER_TAIL)
+                line_start = (*format == '\n');
+#endif
+                if (length < LOG_RECORD_SIZE)
+                {
+                    out[length++] = *format;
+                }
+                format++;
+                continue;
+            }
+            
+            // Conversion: optional 0 flag and width, then u, x or X
+            char pad = ' ';
+            uint8_t width = 0;
+            
+            format++;
+            if (*format == '0')
+            {
+                pad = '0';
+                format++;
+            }
+            while (*format >= '0' && *format <= '9')
+            {
+                width = 10 * width + (*format++ - '0');
+            }
+            if (*format == 'u')
+            {
+                length += Log_Number(&out[length], LOG_RECORD_SIZE - length, va_arg(arguments, unsigned int),
+                                     10, "0123456789", pad, width);
+            }
+            else if (*format == 'x' || *format == 'X')
+            {
+                length += Log_Number(&out[length], LOG_RECORD_SIZE - length, va_arg(arguments, unsigned int),
+                                     16, (*format == 'x') ? "0123456789abcdef" : "0123456789ABCDEF", pad, width);
+            }
+            else if (*format == '%' && length < LOG_RECORD_SIZE)
+            {
+                out[length++] = '%';
+            }
+            if (*format)
+            {
+                format++;
+            }
+        }
+#endif
+        
+        cycles = CycleCounter_Get() - start;
+        log_stats.records++;
+        log_stats.bytes += length;
+        log_stats.cycles += cycles;
+        if (cycles > log_stats.cycles_max)
+        {
+            log_stats.cycles_max = cycles;
+        }
+        return length;
+    }
+    
+    
+    
+    uint8_t Log_Format(uint8_t* record, uint8_t id, ...)
+    {
+        va_list arguments;
+        uint8_t length;
+        
+        va_start(arguments, id);
+        length = Log_FormatList(record, id, arguments);
+        va_end(arguments);
+        return length;
+    }
+    
+    
+    
+    void Log_Print(uint8_t id, ...)
+    {
+        uint8_t record[LOG_RECORD_SIZE];
+        va_list arguments;
+        uint8_t length;
+        
+        va_start(arguments, id);
+        length = Log_FormatList(record, id, arguments);
+        va_end(arguments);
+        UART_Debug_PutArray(record, length);
+    }
+    
+    
+    
+    void Log_GetStats(Log_Stats* stats)
+    {
+        *stats = log_stats;
+    }
+
+/* [] END OF FILE */
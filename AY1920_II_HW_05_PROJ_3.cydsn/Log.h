@@ -0,0 +1,87 @@
+/**
+ * \file Log.h
+ * \brief Diagnostic messages without sprintf.
+ *
+ * A message is an ID of the table in LogMessages.h and its arguments
+ * (unsigned values of 32 bits at most), instead of a string built with
+ * sprintf into a buffer. Log_Format() writes the record of a message:
+ *   - LOG_FORMAT_TEXT: the text of the message, formatted by a small
+ *     formatter which knows %u, %x and %X only, so the printf family of
+ *     the C library is not linked. With the packet formats a line which
+ *     does not start with '#' gets one (see TxQueue_SetText());
+ *   - LOG_FORMAT_BINARY: a COBS packet (see Packet.h) with the count byte
+ *     PACKET_LOG, the message ID in place of the axes, the number of the
+ *     record in place of the sequence number and the arguments as base-128
+ *     varints (7 bits per byte, LSB first, bit 7 set on all the bytes but
+ *     the last one). The format strings stay on the host:
+ *     Host_Tools/FrameDecoder (option -c) expands the records.
+ * The records, their bytes and the CPU cycles spent to write them are
+ * counted (see Log_GetStats()).
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef Log_H
+    #define Log_H
+    
+    #include "cytypes.h"
+    #include "stdarg.h"
+    #include "LogMessages.h"
+    
+    /**
+    *   \brief Maximum size of a record (a longer text is cut).
+    */
+    #define LOG_RECORD_SIZE 96
+    
+    /**
+    *   \brief IDs of the messages, in the order of the table.
+    */
+    #define LOG_ID(id, arguments, format) id,
+    
+    typedef enum {
+        LOG_MESSAGES(LOG_ID)
+        LOG_MESSAGE_COUNT
+    } Log_Message;
+    
+    /**
+    *   \brief Log instrumentation.
+    */
+    typedef struct {
+        uint32_t records;       ///< Records written
+        uint32_t bytes;         ///< Bytes of the records
+        uint32_t cycles;        ///< CPU cycles spent in Log_Format() (see CycleCounter.h)
+        uint32_t cycles_max;    ///< Longest record to write, in CPU cycles
+    } Log_Stats;
+    
+    /**
+    *   \brief Write the record of a message.
+    *
+    *   \param record Buffer of LOG_RECORD_SIZE bytes.
+    *   \param id Message (LOG_MESSAGES).
+    *   \param ... Arguments of the message, as many as in the table.
+    *   \retval Number of bytes of the record.
+    */
+    uint8_t Log_Format(uint8_t* record, uint8_t id, ...);
+    
+    /**
+    *   \brief Write the record of a message, arguments given as a va_list.
+    */
+    uint8_t Log_FormatList(uint8_t* record, uint8_t id, va_list arguments);
+    
+    /**
+    *   \brief Send a message over the UART at once (blocking).
+    *
+    *   \param id Message (LOG_MESSAGES).
+    *   \param ... Arguments of the message, as many as in the table.
+    */
+    void Log_Print(uint8_t id, ...);
+    
+    /**
+    *   \brief Get the log instrumentation.
+    *
+    *   \param stats Pointer to a structure where the statistics will be saved.
+    */
+    void Log_GetStats(Log_Stats* stats);
+
+#endif // Log_H
+/* [] END OF FILE */
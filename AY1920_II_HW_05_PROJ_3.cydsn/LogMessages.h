@@ -0,0 +1,53 @@
+/**
+ * \file LogMessages.h
+ * \brief Format table of the diagnostic messages (see Log.h).
+ *
+ * One X(id, arguments, format) entry per message: the ID is the position
+ * in the table, the arguments are unsigned values of 32 bits at most and
+ * the format takes one %u, %x or %X (with an optional 0 flag and width)
+ * per argument. With LOG_FORMAT_BINARY the format strings are not in the
+ * firmware: Host_Tools/FrameDecoder includes this file to expand the
+ * records. New messages go at the end, so that the IDs of a firmware
+ * already running keep their meaning.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef LogMessages_H
+    #define LogMessages_H
+    
+    /**
+    *   \brief Messages of the boot (main.c, Boot.c), then of the profiler
+    *   (Profiler.c: a line per stage and one for the whole iteration, see
+    *   its stage table), then of the stages added since.
+    */
+    #define LOG_MESSAGES(X) \
+        X(LOG_WHO_AM_I,             2, "WHO AM I REG: 0x%02X [Expected: 0x%02X]\r\n") \
+        X(LOG_WHO_AM_I_ERROR,       0, "Error occurred during I2C comm\r\n") \
+        X(LOG_DEVICE,               1, "Device 0x%02X is connected\r\n") \
+        X(LOG_STATUS_REG,           1, "STATUS REGISTER: 0x%02X\r\n") \
+        X(LOG_STATUS_REG_ERROR,     0, "Error occurred during I2C comm to read status register\r\n") \
+        X(LOG_CONFIG_LOAD_ERROR,    0, "Error occurred during I2C comm to read control registers\r\n") \
+        X(LOG_WRITING,              0, "\r\nWriting new values..\r\n") \
+        X(LOG_CONFIG_APPLY_ERROR,   0, "Error occurred during I2C comm to set control registers\r\n") \
+        X(LOG_AXES_ERROR,           0, "Error occurred during I2C comm to set the axes\r\n") \
+        X(LOG_INTERRUPT_ERROR,      0, "Error occurred during I2C comm to set control register 3\r\n") \
+        X(LOG_CONFIG,               6, "CONTROL REGISTERS 1-6: %02X %02X %02X %02X %02X %02X\r\n") \
+        X(LOG_CONFIG_VERIFY_ERROR,  0, "Error occurred during verification of control registers\r\n") \
+        X(LOG_BOOT_TIMES,           3, "Boot: LIS3DH ready after %u us (%u polls), first sample after %u us\r\n") \
+        X(LOG_BOOT_SCAN,            2, "Boot: %u addresses probed, %u devices found\r\n") \
+        X(LOG_LOG_STATS,            3, "Log: %u messages, %u bytes, %u cycles per message\r\n") \
+        X(LOG_PROFILER_HEADER,      0, "# stage count min avg max bins\r\n") \
+        X(LOG_PROFILER_WAIT,        1, "# wait %u") \
+        X(LOG_PROFILER_READ,        1, "# read %u") \
+        X(LOG_PROFILER_CONVERT,     1, "# convert %u") \
+        X(LOG_PROFILER_SEND,        1, "# send %u") \
+        X(LOG_PROFILER_LOOP,        1, "# loop %u") \
+        X(LOG_PROFILER_TIMES,       3, " %u %u %u") \
+        X(LOG_PROFILER_BIN,         2, " %u:%u") \
+        X(LOG_PROFILER_END,         0, "\r\n") \
+        X(LOG_PROFILER_FILTER,      1, "# filter %u") \
+        X(LOG_PROFILER_DECIMATE,    1, "# decimate %u")
+
+#endif // LogMessages_H
+/* [] END OF FILE */
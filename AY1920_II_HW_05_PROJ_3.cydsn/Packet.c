@@ -0,0 +1,61 @@
+/*
+* This file includes all the required source code to build
+* the COBS framed packets.
+*/
+
+#include "Packet.h"
+
+    uint16_t Packet_Crc16(const uint8_t* data, uint16_t length)
+    {
+        uint16_t crc = 0xFFFF;
+        uint8_t x;
+        
+        // Bytewise form of the polynomial 0x1021: no table, no loop on the bits
+        while (length--)
+        {
+            x = (crc >> 8) ^ *data++;
+            x ^= x >> 4;
+            crc = (crc << 8) ^ ((uint16_t)x << 12) ^ ((uint16_t)x << 5) ^ x;
+        }
+        return crc;
+    }
+    
+    
+    
+    void Packet_Start(uint8_t* frame, uint16_t sequence, uint8_t sample_count, uint8_t axes)
+    {
+        frame[1] = sequence & 0xFF;
+        frame[2] = sequence >> 8;
+        frame[3] = sample_count;
+        frame[4] = axes;
+    }
+    
+    
+    
+    uint8_t Packet_Seal(uint8_t* frame, uint8_t sample_bytes)
+    {
+        uint8_t length = PACKET_HEADER_SIZE - 1 + sample_bytes;     // Sequence, count, axes and samples
+        uint16_t crc = Packet_Crc16(&frame[1], length);
+        uint8_t code_index = 0;
+        uint8_t i;
+        
+        frame[++length] = crc & 0xFF;
+        frame[++length] = crc >> 8;
+        
+        // COBS: each zero (and the code byte in front) holds the distance to the next zero.
+        // Up to 254 bytes the packet is a single COBS block, so no byte has to move.
+        for (i = 1; i <= length; i++)
+        {
+            if (frame[i] == 0)
+            {
+                frame[code_index] = i - code_index;
+                code_index = i;
+            }
+        }
+        frame[code_index] = i - code_index;
+        frame[i] = 0;       // Delimiter
+        
+        return i + 1;
+    }
+
+/* [] END OF FILE */
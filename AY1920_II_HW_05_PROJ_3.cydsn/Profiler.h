@@ -0,0 +1,118 @@
+/**
+ * \file Profiler.h
+ * \brief Cycle counts of the acquisition loop stages (USE_PROFILER).
+ *
+ * The acquisition loop marks the start of each stage with PROFILER_ENTER():
+ * the cycles (see CycleCounter.h) up to the next mark are added to the
+ * stage, and at the end of each iteration (PROFILER_LOOP()) the cycles of
+ * every stage which ran and of the whole iteration go into a table in SRAM:
+ * count, minimum, maximum, sum and a histogram with a bin per power of 2
+ * (bin b holds the iterations of 2^(b-1) to 2^b - 1 cycles, bin 0 those of
+ * 0 cycles, the last bin also the longer ones).
+ * Receiving PROFILER_DUMP_COMMAND on the UART (PROFILER_POLL()) sends the
+ * table as log messages (text lines starting with '#', see Log.h), then
+ * clears it (see Profiler_Dump()).
+ * The cycle counter stops while the CPU sleeps: with USE_INT1 or
+ * USE_POLL_TIMER the wait stage is the time spent awake in it.
+ * With USE_PROFILER 0 the macros expand to nothing and no table is kept.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef Profiler_H
+    #define Profiler_H
+    
+    #include "cytypes.h"
+    #include "macro_definition.h"
+    
+    /**
+    *   \brief Stages of the acquisition loop.
+    */
+    #define PROFILER_STAGE_WAIT 0       ///< Flush, sleep and TX drain before the read
+    #define PROFILER_STAGE_READ 1       ///< Status and data read (TX drain while the bus is busy included)
+    #define PROFILER_STAGE_CONVERT 2    ///< Conversion or encoding of the samples into the frame
+    #define PROFILER_STAGE_SEND 3       ///< Sealing and queueing of the frame (telemetry included)
+    #define PROFILER_STAGE_FILTER 4     ///< Filter of the samples read (USE_FILTER, see Filter.h)
+    #define PROFILER_STAGE_DECIMATE 5   ///< Decimation of the samples read (DECIMATION_RATIO, see Decimator.h)
+    #define PROFILER_STAGES 6
+    
+    /**
+    *   \brief Bins of the histograms: the last one holds 2^22 cycles and more.
+    */
+    #define PROFILER_BINS 24
+    
+    /**
+    *   \brief Byte received on the UART which requests the dump of the table.
+    */
+    #define PROFILER_DUMP_COMMAND 'p'
+    
+    /**
+    *   \brief Statistics of a stage (or of the whole iteration), in cycles.
+    */
+    typedef struct {
+        uint32_t count;                 ///< Iterations in which the stage ran
+        uint32_t min;
+        uint32_t max;
+        uint64_t sum;                   ///< Divide by count for the average
+        uint32_t bins[PROFILER_BINS];   ///< Histogram of the cycles per iteration
+    } Profiler_Entry;
+
+#if (USE_PROFILER)
+    #define PROFILER_START() Profiler_Start()
+    #define PROFILER_LOOP() Profiler_Loop()
+    #define PROFILER_ENTER(stage) Profiler_Enter(stage)
+    #define PROFILER_POLL() Profiler_Poll()
+#else
+    #define PROFILER_START()
+    #define PROFILER_LOOP()
+    #define PROFILER_ENTER(stage)
+    #define PROFILER_POLL()
+#endif
+
+    /**
+    *   \brief Start the cycle counter and clear the table.
+    */
+    void Profiler_Start(void);
+    
+    /**
+    *   \brief End the current iteration and start the wait stage of the next one.
+    */
+    void Profiler_Loop(void);
+    
+    /**
+    *   \brief End the current stage and start the given one.
+    *
+    *   \param stage PROFILER_STAGE_WAIT .. PROFILER_STAGE_DECIMATE.
+    */
+    void Profiler_Enter(uint8_t stage);
+    
+    /**
+    *   \brief Dump the table if PROFILER_DUMP_COMMAND was received.
+    *
+    *   Called between two iterations: the dump blocks the loop until it is
+    *   sent (about 0.5 s at 9600 bps) and is not counted.
+    */
+    void Profiler_Poll(void);
+    
+    /**
+    *   \brief Send the table over the UART and clear it.
+    *
+    *   The queued frames are sent first. A line per stage and one for the
+    *   whole iteration ('loop'):
+    *       # <stage> <count> <min> <avg> <max> <bin>:<iterations> ...
+    *   with the non-empty bins only. With the packet formats a 0x00
+    *   delimiter follows the text, so the next packet is aligned.
+    */
+    void Profiler_Dump(void);
+    
+    /**
+    *   \brief Get the statistics of a stage.
+    *
+    *   \param stage PROFILER_STAGE_WAIT .. PROFILER_STAGE_DECIMATE, or
+    *          PROFILER_STAGES for the whole iteration.
+    *   \param entry Pointer to a structure where the statistics will be saved.
+    */
+    void Profiler_GetEntry(uint8_t stage, Profiler_Entry* entry);
+
+#endif // Profiler_H
+/* [] END OF FILE */
@@ -24,6 +24,11 @@
     */
     #define LIS3DH_WHO_AM_I_REG_ADDR 0x0F
 
+    /**
+    *   \brief Value of the WHO AM I register of the LIS3DH
+    */
+    #define LIS3DH_WHO_AM_I_VALUE 0x33
+
     /**
     *   \brief Address of the Status register
     */
@@ -35,13 +40,26 @@
     #define LIS3DH_CTRL_REG1 0x20
 
     /**
-    *   \brief Hex value to set high resolution mode to the accelerator.
-    *    In order to achieve that aim, we need the 'LPen' bit (of the 
-    *    Temperature Sensor Configuration register) set to 0 and then, at 
-    *    the same time, the 'HR' bit (of the Control register 4) set to 1  
-    *    (see below for these 2 specific bits configuration).
+    *   \brief Acquisition profile: High resolution mode (12-bit), ±4g, 100 Hz, output in m/s2.
+    *    The values of the Control registers 1 and 4 and the conversion of the
+    *    samples are derived from it (see LIS3DH_Profile.h).
+    *    LIS3DH_MODE_LOW_POWER gives 8-bit samples and the LIS3DH_ODR_1600HZ_LP
+    *    and LIS3DH_ODR_5376HZ_LP rates: with USE_INT1 only the high bytes are
+    *    read (8 bus bytes per sample instead of 10). These rates need
+    *    ACQ_MODE_FIFO (5.376 kHz also the I2C at 400 kbit/s) and, on the UART,
+    *    FRAME_FORMAT_PACKED or FRAME_FORMAT_DELTA (or DECIMATION_RATIO).
+    *    A host build may set them on the command line (see Host_Tools/AcquisitionSim.c).
     */
-    #define LIS3DH_NORMAL_MODE_CTRL_REG1 0x57 //set high resolution mode 100 Hz (according to datasheet related information)
+    #ifndef ACC_POWER_MODE
+        #define ACC_POWER_MODE LIS3DH_MODE_HIGH_RESOLUTION
+    #endif
+    #ifndef ACC_FULL_SCALE
+        #define ACC_FULL_SCALE LIS3DH_FS_4G
+    #endif
+    #ifndef ACC_ODR
+        #define ACC_ODR LIS3DH_ODR_100HZ
+    #endif
+    #define ACC_OUTPUT_UNIT UNIT_MS2_Q16
 
     /**
     *   \brief  Address of the Temperature Sensor Configuration register
@@ -52,14 +70,9 @@
 
     /**
     *   \brief Address of the Control register 4
-    *    In order to have a full scale FS of ±4g, we need a specific combination of
-    *    bit setting in this register. In particular, the bit named 'FS1' must be set
-    *    to 1, while the bit named 'Fs0' must be set to 0.
     */
     #define LIS3DH_CTRL_REG4 0x23
 
-    #define LIS3DH_CTRL_REG4_BDU_ACTIVE 0x98 // in this way also 'HR' bit is set to 1, FS0 and FS1 are set to 1 and 0 respectively
-
     /**
     *   \brief Address of the ADC output LSB register
     */
@@ -86,11 +99,464 @@
     */           
     #define ZYXDA 3
     
+    /**
+    *   \brief bit of the STATUS REGISTER set when a new set of data has 
+    *   overwritten the previous one before it was read (a sample was missed)
+    */
+    #define ZYXOR 7
+    
+    /**
+    *   \brief Number of registers read in a single burst starting from the 
+    *   Status register: STATUS_REG (0x27) is adjacent to OUT_X_L (0x28), so
+    *   the status and the 6 output registers come in the same transaction
+    *   (one transaction per sample, whether the sample is new or not: with
+    *   BDU the output registers are not updated while they are read).
+    */
+    #define LIS3DH_SAMPLE_BURST_SIZE 7
+    
+    /**
+    *   \brief Number of bytes of a XYZ sample (OUT_X_L..OUT_Z_H)
+    */
+    #define LIS3DH_SAMPLE_SIZE 6
+    
+    /**
+    *   \brief Axes acquired and sent (Xen, Yen, Zen bits of the Control 
+    *    register 1, also XDA, YDA, ZDA of the Status register): ACC_AXES at 
+    *    boot, then LIS3DH_SetAxes(). Only the output registers up to the last
+    *    enabled axis are read (from the first one with USE_INT1) and the 
+    *    frames hold the enabled axes only, in X, Y, Z order: with one axis a
+    *    frame of FRAME_SAMPLES 1 is 6 bytes instead of 14, 320 Hz at 19200 bps.
+    *    With polling the Status register comes first: X alone saves 4 bus 
+    *    bytes per sample, Z alone none.
+    */
+    #define ACC_AXIS_X 0x01
+    #define ACC_AXIS_Y 0x02
+    #define ACC_AXIS_Z 0x04
+    
+    #define LIS3DH_CTRL_REG1_AXES (ACC_AXIS_X | ACC_AXIS_Y | ACC_AXIS_Z)
+    
+    #define ACC_AXES (ACC_AXIS_X | ACC_AXIS_Y | ACC_AXIS_Z)
+    
+    /**
+    *   \brief Address of the Control register 5 and FIFO enable bit
+    */
+    #define LIS3DH_CTRL_REG5 0x24
+    
+    #define LIS3DH_CTRL_REG5_FIFO_EN 0x40
+    
+    /**
+    *   \brief Address of the FIFO Control register.
+    *    Bits FM1-FM0 select the FIFO mode ('10' is Stream mode: when the FIFO
+    *    is full the oldest sample is overwritten), bits FTH4-FTH0 set the 
+    *    watermark level.
+    */
+    #define LIS3DH_FIFO_CTRL_REG 0x2E
+    
+    #define LIS3DH_FIFO_CTRL_REG_STREAM 0x80
+    
+    /**
+    *   \brief Address of the FIFO Source register and its bits: WTM is set when
+    *    the FIFO level is above the watermark, OVRN_FIFO when the FIFO is full
+    *    (32 unread samples), FSS4-FSS0 hold the number of unread samples.
+    */
+    #define LIS3DH_FIFO_SRC_REG 0x2F
+    
+    #define WTM 7
+    #define OVRN_FIFO 6
+    #define LIS3DH_FIFO_SRC_REG_FSS_MASK 0x1F
+    
+    /**
+    *   \brief Number of samples stored in the FIFO when it is full
+    */
+    #define LIS3DH_FIFO_SIZE 32
+    
+    /**
+    *   \brief Acquisition modes: 
+    *    - ACQ_MODE_POLLING reads one sample per Status register poll;
+    *    - ACQ_MODE_FIFO lets the sensor buffer samples in its FIFO (Stream 
+    *      mode) and drains them in a single burst once the watermark is reached,
+    *      so that no sample is lost while the loop is busy on the UART.
+    *    A host build may set it on the command line.
+    */
+    #define ACQ_MODE_POLLING 0
+    #define ACQ_MODE_FIFO 1
+    
+    #ifndef ACQUISITION_MODE
+        #define ACQUISITION_MODE ACQ_MODE_POLLING
+    #endif
+    
+    /**
+    *   \brief FIFO watermark level (in samples, max 31) used in ACQ_MODE_FIFO
+    */
+    #define FIFO_WATERMARK 16
+    
+    /**
+    *   \brief Set to 1 when the LIS3DH INT1 pin is wired to the PSoC: a digital 
+    *    input pin named 'Pin_INT1' (rising edge interrupt) connected to an 
+    *    interrupt component named 'isr_INT1' must be placed in the TopDesign.
+    *    The CPU then sleeps until INT1 signals new data (I1_ZYXDA) or, in 
+    *    ACQ_MODE_FIFO, the FIFO watermark (I1_WTM). A host build may set it on
+    *    the command line.
+    */
+    #ifndef USE_INT1
+        #define USE_INT1 0
+    #endif
+    
+    /**
+    *   \brief Set to 1 on boards without INT1 to poll the accelerometer at 
+    *    the ticks of a timer (see LIS3DH_Schedule.h) instead of back to back:
+    *    a Timer component named 'Timer_Poll' (16-bit, clocked at 
+    *    POLL_TIMER_CLOCK_HZ) with an interrupt component named 'isr_Poll' on 
+    *    its 'interrupt' terminal (interrupt on terminal count) must be placed 
+    *    in the TopDesign. The CPU sleeps between the ticks and reads one 
+    *    sample per tick (ACQ_MODE_POLLING only): the reads per sample and the 
+    *    samples missed are counted by LIS3DH_Schedule_GetStats(). A host
+    *    build may set it on the command line.
+    */
+    #ifndef USE_POLL_TIMER
+        #define USE_POLL_TIMER 0
+    #endif
+    
+    #define POLL_TIMER_CLOCK_HZ 1000000
+    
+    #if (USE_POLL_TIMER && (USE_INT1 || ACQUISITION_MODE != ACQ_MODE_POLLING))
+        #error "USE_POLL_TIMER needs ACQ_MODE_POLLING and USE_INT1 0"
+    #endif
+    
+    /**
+    *   \brief Address of the Control register 3 and its INT1 routing bits
+    */
+    #define LIS3DH_CTRL_REG3 0x22
+    
+    #define LIS3DH_CTRL_REG3_I1_ZYXDA 0x10
+    #define LIS3DH_CTRL_REG3_I1_WTM 0x04
+    
+    /**
+    *   \brief Address of the Control registers 2 and 6 and of the INT1 
+    *    Configuration register (left at their default value)
+    */
+    #define LIS3DH_CTRL_REG2 0x21
+    #define LIS3DH_CTRL_REG6 0x25
+    #define LIS3DH_INT1_CFG 0x30
+    
+    /**
+    *   \brief Values of the Control registers 3 and 5 and of the FIFO Control 
+    *    register required by ACQUISITION_MODE and USE_INT1 (see the 
+    *    configuration table in main.c).
+    */
+    #if (ACQUISITION_MODE == ACQ_MODE_FIFO)
+        #define LIS3DH_CONFIG_CTRL_REG5 LIS3DH_CTRL_REG5_FIFO_EN
+        #define LIS3DH_CONFIG_FIFO_CTRL_REG (LIS3DH_FIFO_CTRL_REG_STREAM | FIFO_WATERMARK)
+    #else
+        #define LIS3DH_CONFIG_CTRL_REG5 0x00
+        #define LIS3DH_CONFIG_FIFO_CTRL_REG 0x00
+    #endif
+    
+    #if (USE_INT1 && ACQUISITION_MODE == ACQ_MODE_FIFO)
+        #define LIS3DH_CONFIG_CTRL_REG3 LIS3DH_CTRL_REG3_I1_WTM
+    #elif (USE_INT1)
+        #define LIS3DH_CONFIG_CTRL_REG3 LIS3DH_CTRL_REG3_I1_ZYXDA
+    #else
+        #define LIS3DH_CONFIG_CTRL_REG3 0x00
+    #endif
+    
+    /**
+    *   \brief Configuration registers kept in the shadow (see LIS3DH_Config.h):
+    *    the Temperature Sensor Configuration register and the Control registers
+    *    1-6 are adjacent (0x1F..0x25), so they are read back in a single burst.
+    */
+    #define LIS3DH_CONFIG_FIRST_REG LIS3DH_TEMP_CFG_REG
+    #define LIS3DH_CONFIG_REG_COUNT 7
+    
+    /**
+    *   \brief Size of the array storing the data read from the accelerometer:
+    *    the whole FIFO in ACQ_MODE_FIFO, a single status + sample burst otherwise.
+    */
+    #if (ACQUISITION_MODE == ACQ_MODE_FIFO)
+        #define ACC_DATA_SIZE (LIS3DH_FIFO_SIZE * LIS3DH_SAMPLE_SIZE)
+    #else
+        #define ACC_DATA_SIZE LIS3DH_SAMPLE_BURST_SIZE
+    #endif
+    
+    /**
+    *   \brief Set to 1 to filter the samples on the PSoC (see Filter.h): a
+    *    chain of biquads per axis (low pass, high pass or band pass), from
+    *    the table of FilterCoefficients.h written by Host_Tools/FilterDesign
+    *    for the rate of the samples sent (ACC_ODR, divided by
+    *    DECIMATION_RATIO). Every frame format sends the filtered values. About 30
+    *    cycles per axis and 50 per section and axis for each sample (the
+    *    'filter' stage of the profiler): 2 sections on 3 axes at 100 Hz take
+    *    0.2% of the CPU.
+    *    A host build may set it on the command line.
+    */
+    #ifndef USE_FILTER
+        #define USE_FILTER 0
+    #endif
+    
+    #define FILTER_MAX_SECTIONS 4 //Sections of the longest chain (8th order)
+    
+    /**
+    *   \brief Set DECIMATION_RATIO to 2 or more to sample at a high ACC_ODR
+    *    and send one sample every DECIMATION_RATIO (see Decimator.h), e.g.
+    *    LIS3DH_ODR_1344HZ and 13 for 103 Hz, LIS3DH_ODR_400HZ and 4 for
+    *    100 Hz. Each axis goes through a CIC decimator of DECIMATION_ORDER
+    *    stages: 1 is the plain average of the DECIMATION_RATIO samples
+    *    (boxcar), 2 and 3 reject more of the noise above the output Nyquist
+    *    frequency. The filter (USE_FILTER) runs on the decimated samples.
+    *    Best with ACQ_MODE_FIFO (whole bursts, the I2C at 400 kbit/s above
+    *    400 Hz) and LIS3DH_MODE_HIGH_RESOLUTION: the average is rounded to
+    *    the resolution of the profile.
+    *    A host build may set them on the command line.
+    */
+    #ifndef DECIMATION_RATIO
+        #define DECIMATION_RATIO 1
+    #endif
+    #ifndef DECIMATION_ORDER
+        #define DECIMATION_ORDER 1
+    #endif
+    
+    #if (DECIMATION_RATIO < 1 || DECIMATION_RATIO > 255 || DECIMATION_ORDER < 1 || DECIMATION_ORDER > 3)
+        #error "DECIMATION_RATIO must be 1 to 255, DECIMATION_ORDER 1 to 3"
+    #endif
+    
+    /**
+    *   \brief Output formats of the acceleration values (4 bytes per axis):
+    *    - OUTPUT_FORMAT_FLOAT sends float numbers in m/s2 ('float' type with
+    *      scale 1 in the Bridge Control Panel);
+    *    - OUTPUT_FORMAT_Q16_16 sends the fixed-point values (signed 'int' type
+    *      with scale 0.0000152587890625, namely 1/65536).
+    *    A host build may set it on the command line.
+    */
+    #define OUTPUT_FORMAT_FLOAT 0
+    #define OUTPUT_FORMAT_Q16_16 1
+    
+    #ifndef OUTPUT_FORMAT
+        #define OUTPUT_FORMAT OUTPUT_FORMAT_FLOAT
+    #endif
+    
     /**
     *   \brief number of bytes to be sent definition
     */  
-    #define BYTE_TO_SEND 12 //We know EXACTLY the number of bytes to be sent
-    #define TRANSMIT_BUFFER_SIZE 1+ BYTE_TO_SEND +1 //Contains 1 header byte and 1 tail byte
+    #define BYTE_TO_SEND 12 //We know EXACTLY the number of bytes to be sent for each sample
+    #define AXIS_BYTES (BYTE_TO_SEND / 3) //Bytes of each axis (a sample holds the enabled axes only)
+    
+    /**
+    *   \brief Samples sent in each frame (max 21, 20 with COBS, 27 with DELTA, 49 with PACKED:
+    *    the frame must fit 255 bytes).
+    *    With 1 the frame is the original one: header, one sample and tail. 
+    *    With N > 1 the header is followed by a byte holding the sample count and
+    *    by N samples, then the tail: the framing overhead is paid once every N
+    *    samples (see the *_Batch4 files in 'Bridge Control Panel' and Host_Tools).
+    *    Maximum sustainable ODR (10 bits per byte on the UART):
+    *       N   frame   9600   19200   57600   115200 bps
+    *       1    14 B     69     137     411      823 Hz
+    *       2    27 B     71     142     427      853 Hz
+    *       4    51 B     75     151     452      904 Hz
+    *       8    99 B     78     155     465      931 Hz
+    *      16   195 B     79     158     473      945 Hz
+    *    A host build may set it on the command line.
+    */
+    #ifndef FRAME_SAMPLES
+        #define FRAME_SAMPLES 1
+    #endif
+    
+    /**
+    *   \brief Framing of the samples:
+    *    - FRAME_FORMAT_HEADER_TAIL: 0xA0 header and 0xC0 tail, as expected by
+    *      the Bridge Control Panel;
+    *    - FRAME_FORMAT_COBS: COBS packets with sequence number and CRC16 (see
+    *      Packet.h), decoded by Host_Tools/FrameDecoder with option -c. Lost
+    *      samples are counted exactly and a corrupted packet is discarded
+    *      instead of being decoded, for 6 more bytes per frame;
+    *    - FRAME_FORMAT_DELTA: the same packets with the samples compressed
+    *      without loss (see DeltaCodec.h), about 3 bytes per sample at rest.
+    *      Use FRAME_SAMPLES > 1: the packet overhead is 8 bytes;
+    *    - FRAME_FORMAT_PACKED: the same packets with the samples packed at
+    *      the resolution of ACC_POWER_MODE (see BitPack.h), 10 bytes of
+    *      overhead. Bytes per sample and maximum ODR with FRAME_SAMPLES 16:
+    *         bits/axis   bytes   9600   19200   57600   115200 bps
+    *         12 (HR)      5.13    187     374    1123     2247 Hz
+    *         10 (normal)  4.38    219     438    1316     2633 Hz
+    *          8 (LP)      3.63    264     529    1588     3177 Hz
+    *         10, 1 axis   1.88    512    1024    3072     6144 Hz
+    *    A host build may set it on the command line.
+    */
+    #define FRAME_FORMAT_HEADER_TAIL 0
+    #define FRAME_FORMAT_COBS 1
+    #define FRAME_FORMAT_DELTA 2
+    #define FRAME_FORMAT_PACKED 3
+    
+    #ifndef FRAME_FORMAT
+        #define FRAME_FORMAT FRAME_FORMAT_HEADER_TAIL
+    #endif
+    
+    /**
+    *   \brief FRAME_FORMAT_DELTA: a packet every DELTA_KEYFRAME_PACKETS can be
+    *    decoded alone, the others need the previous one.
+    */
+    #define DELTA_KEYFRAME_PACKETS 16
+    
+    #if (FRAME_FORMAT == FRAME_FORMAT_DELTA)
+        #define FRAME_HEADER_SIZE 6 //COBS code, sequence number, sample count, axes and sensitivity (keyframes only)
+        #define FRAME_TRAILER_SIZE 3 //CRC16 and delimiter
+        #define FRAME_SAMPLE_SIZE 9 //Largest compressed sample
+    #elif (FRAME_FORMAT == FRAME_FORMAT_PACKED)
+        #define FRAME_HEADER_SIZE 7 //COBS code, sequence number, sample count, axes, sensitivity and resolution
+        #define FRAME_TRAILER_SIZE 3 //CRC16 and delimiter
+        #define FRAME_SAMPLE_SIZE 5 //Up to 36 bits (high resolution mode)
+    #elif (FRAME_FORMAT == FRAME_FORMAT_COBS)
+        #define FRAME_HEADER_SIZE 5 //COBS code, sequence number, sample count and axes
+        #define FRAME_TRAILER_SIZE 3 //CRC16 and delimiter
+        #define FRAME_SAMPLE_SIZE BYTE_TO_SEND
+    #elif (FRAME_SAMPLES > 1)
+        #define FRAME_HEADER_SIZE 2 //Header byte and sample count
+        #define FRAME_TRAILER_SIZE 1 //Tail byte
+        #define FRAME_SAMPLE_SIZE BYTE_TO_SEND
+    #else
+        #define FRAME_HEADER_SIZE 1 //Header byte only
+        #define FRAME_TRAILER_SIZE 1 //Tail byte
+        #define FRAME_SAMPLE_SIZE BYTE_TO_SEND
+    #endif
+    
+    #define TRANSMIT_BUFFER_SIZE (FRAME_HEADER_SIZE + FRAME_SAMPLES * FRAME_SAMPLE_SIZE + FRAME_TRAILER_SIZE) //Contains the header bytes, the samples and the trailer bytes (largest frame, all the axes)
+    
+    #if (TRANSMIT_BUFFER_SIZE > 255)
+        #error "FRAME_SAMPLES too large: the frame length must fit a byte"
+    #endif
+    
+    /**
+    *   \brief Set to 1 to send a telemetry packet (see Telemetry.h) between
+    *    the data packets every TELEMETRY_SAMPLES samples read (once per
+    *    second at 100 Hz): samples read, overruns (ZYXOR), I2C errors, frames
+    *    dropped by the transmit ring and duration of the acquisition loop.
+    *    Packet formats only: Host_Tools/FrameDecoder (option -c) prints the
+    *    counters. 40 bytes each, 4% of the link at 9600 bps.
+    *    A host build may set it on the command line.
+    */
+    #ifndef USE_TELEMETRY
+        #define USE_TELEMETRY 0
+    #endif
+    
+    #define TELEMETRY_SAMPLES 100
+    
+    #define TELEMETRY_FRAME_SIZE 40 //Packet header, 8 counters of 4 bytes, CRC16 and delimiter
+    
+    #if (USE_TELEMETRY && FRAME_FORMAT == FRAME_FORMAT_HEADER_TAIL)
+        #error "USE_TELEMETRY needs FRAME_FORMAT_COBS, FRAME_FORMAT_DELTA or FRAME_FORMAT_PACKED"
+    #endif
+    
+    /**
+    *   \brief Boot (see Boot.h): the WHO AM I register is polled every
+    *    BOOT_POLL_INTERVAL_US until the LIS3DH answers (BOOT_TIMEOUT_US at
+    *    most) instead of waiting 5 ms. Bus scan before the acquisition:
+    *    - BOOT_SCAN_KNOWN: LIS3DH_DEVICE_ADDRESS and the devices found by
+    *      the previous scan (remembered across a reset, not a power cycle);
+    *    - BOOT_SCAN_FULL: all the addresses but the reserved ones (0x08 to
+    *      0x77, 112 probes).
+    *    With BOOT_DEFERRED_MESSAGES 1 the boot messages (BOOT_LOG_SIZE bytes
+    *    at most) are sent after the first sample, between the frames.
+    */
+    #define BOOT_SCAN_KNOWN 0
+    #define BOOT_SCAN_FULL 1
+    
+    #define BOOT_SCAN BOOT_SCAN_KNOWN
+    
+    #define BOOT_DEFERRED_MESSAGES 1
+    
+    #define BOOT_POLL_INTERVAL_US 100
+    #define BOOT_TIMEOUT_US 10000
+    #define BOOT_LOG_SIZE 512
+    
+    /**
+    *   \brief Diagnostic messages (see Log.h), no sprintf in both cases:
+    *    - LOG_FORMAT_TEXT: lines of text formatted on the PSoC;
+    *    - LOG_FORMAT_BINARY: message ID and arguments only, in a packet
+    *      between the data packets, expanded by Host_Tools/FrameDecoder
+    *      (option -c) with the table of LogMessages.h. Packet formats only.
+    *    A host build may set it on the command line.
+    */
+    #define LOG_FORMAT_TEXT 0
+    #define LOG_FORMAT_BINARY 1
+    
+    #ifndef LOG_FORMAT
+        #define LOG_FORMAT LOG_FORMAT_TEXT
+    #endif
+    
+    #if (LOG_FORMAT == LOG_FORMAT_BINARY && FRAME_FORMAT == FRAME_FORMAT_HEADER_TAIL)
+        #error "LOG_FORMAT_BINARY needs FRAME_FORMAT_COBS, FRAME_FORMAT_DELTA or FRAME_FORMAT_PACKED"
+    #endif
+    
+    /**
+    *   \brief Set to 1 to count the CPU cycles of each stage of the acquisition
+    *    loop (see Profiler.h): sending 'p' to the UART dumps the table. The
+    *    UART_Debug component needs its RX enabled. With 0 nothing is compiled
+    *    in. A host build may set it on the command line.
+    */
+    #ifndef USE_PROFILER
+        #define USE_PROFILER 0
+    #endif
+    
+    /**
+    *   \brief Frames queued by a single read at most: a whole FIFO burst of
+    *    LIS3DH_FIFO_SIZE samples (more than FIFO_WATERMARK + 1 once the loop
+    *    is late) in ACQ_MODE_FIFO, one sample otherwise, then a telemetry
+    *    packet.
+    */
+    #if (ACQUISITION_MODE == ACQ_MODE_FIFO)
+        #define TX_QUEUE_READ_FRAMES ((LIS3DH_FIFO_SIZE + FRAME_SAMPLES - 1) / FRAME_SAMPLES + 1)
+    #else
+        #define TX_QUEUE_READ_FRAMES 2
+    #endif
+    
+    /**
+    *   \brief Frames queued while a line of text is sent (see TxQueue_SetText()):
+    *    the frames wait for the end of the line, a log record at most
+    *    (LOG_RECORD_SIZE, see Log.h), as many as the link sends in the time
+    *    of the line when it carries the frames, and one more.
+    */
+    #define TX_QUEUE_LINE_SIZE 96
+    #define TX_QUEUE_TEXT_FRAMES (TX_QUEUE_LINE_SIZE / TRANSMIT_BUFFER_SIZE + 1)
+    
+    /**
+    *   \brief Ring of frames waiting to be sent over the UART (see TxQueue.h):
+    *    number of frames (power of 2, at least 8, the frames of a read and
+    *    the ones queued behind a line of text) and size of each one (a
+    *    telemetry packet fits too). A host build may set the depth on the
+    *    command line.
+    */
+    #ifndef TX_QUEUE_DEPTH
+        #if (TX_QUEUE_READ_FRAMES + TX_QUEUE_TEXT_FRAMES <= 8)
+            #define TX_QUEUE_DEPTH 8
+        #elif (TX_QUEUE_READ_FRAMES + TX_QUEUE_TEXT_FRAMES <= 16)
+            #define TX_QUEUE_DEPTH 16
+        #elif (TX_QUEUE_READ_FRAMES + TX_QUEUE_TEXT_FRAMES <= 32)
+            #define TX_QUEUE_DEPTH 32
+        #else
+            #define TX_QUEUE_DEPTH 64
+        #endif
+    #endif
+    
+    #if (ACQUISITION_MODE == ACQ_MODE_FIFO && TX_QUEUE_DEPTH * FRAME_SAMPLES < FIFO_WATERMARK + 1)
+        #error "TX_QUEUE_DEPTH frames of FRAME_SAMPLES samples must hold a FIFO burst (FIFO_WATERMARK + 1 samples)"
+    #endif
+    
+    #if (USE_TELEMETRY && TELEMETRY_FRAME_SIZE > TRANSMIT_BUFFER_SIZE)
+        #define TX_QUEUE_FRAME_SIZE TELEMETRY_FRAME_SIZE
+    #else
+        #define TX_QUEUE_FRAME_SIZE TRANSMIT_BUFFER_SIZE
+    #endif
+    
+    /**
+    *   \brief Set to 1 to send the frames from the UART TX interrupt: an 
+    *    interrupt component named 'isr_UART_TX' connected to the 'tx_interrupt'
+    *    terminal of UART_Debug, with the 'TX FIFO not full' interrupt source 
+    *    enabled, must be placed in the TopDesign. With 0 the acquisition loop 
+    *    moves the bytes into the TX FIFO while it waits for the I2C bus.
+    *    A host build may set it on the command line.
+    */
+    #ifndef USE_UART_TX_ISR
+        #define USE_UART_TX_ISR 0
+    #endif
     
 #endif
 /* [] END OF FILE */
@@ -17,8 +17,22 @@
 
 // Include required header files
 #include "I2C_Interface.h"
+#include "LIS3DH.h"
+#include "LIS3DH_Config.h"
+#include "LIS3DH_Interrupt.h"
+#include "LIS3DH_Schedule.h"
+#include "Conversion.h"
+#include "TxQueue.h"
+#include "Telemetry.h"
+#include "Profiler.h"
+#include "Boot.h"
+#include "Log.h"
+#include "Packet.h"
+#include "DeltaCodec.h"
+#include "BitPack.h"
+#include "Filter.h"
+#include "Decimator.h"
 #include "project.h"
-#include "stdio.h"
 #include "macro_definition.h"
 
 int main(void)
@@ -29,42 +43,29 @@ int main(void)
     I2C_Peripheral_Start();
     UART_Debug_Start();
     
-    CyDelay(5); //"The boot procedure is complete about 5 milliseconds after device power-up."
-    
-    // String to print out messages on the UART
-    char message[50];
-
-    // Check which devices are present on the I2C bus
-    for (int i = 0 ; i < 128; i++)
-    {
-        if (I2C_Peripheral_IsDeviceConnected(i))
-        {
-            // print out the address in hex format
-            sprintf(message, "Device 0x%02X is connected\r\n", i);
-            UART_Debug_PutString(message); 
-        }
-        
-    }
+    /*  Time 0 of the boot instrumentation (see Boot.h)  */
+    Boot_Start();
     
     /******************************************/
     /*            I2C Reading                 */
     /******************************************/
     
-    /* Read WHO AM I REGISTER register */
+    /* Poll the WHO AM I register until the accelerometer answers: "The boot procedure 
+    is complete about 5 milliseconds after device power-up", often earlier */
     uint8_t who_am_i_reg;
-    ErrorCode error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                                  LIS3DH_WHO_AM_I_REG_ADDR, 
-                                                  &who_am_i_reg);
+    ErrorCode error = Boot_WaitDevice(&who_am_i_reg);
     if (error == NO_ERROR)
     {
-        sprintf(message, "WHO AM I REG: 0x%02X [Expected: 0x33]\r\n", who_am_i_reg);
-        UART_Debug_PutString(message); 
+        Boot_Log(LOG_WHO_AM_I, who_am_i_reg, LIS3DH_WHO_AM_I_VALUE);
     }
     else
     {
-        UART_Debug_PutString("Error occurred during I2C comm\r\n");   
+        Boot_Log(LOG_WHO_AM_I_ERROR);
     }
     
+    // Check which devices are present on the I2C bus (BOOT_SCAN in macro_definition.h)
+    Boot_Scan();
+    
     /*      I2C Reading Status Register       */
     
     uint8_t status_register; 
@@ -74,30 +75,24 @@ int main(void)
     
     if (error == NO_ERROR)
     {
-        sprintf(message, "STATUS REGISTER: 0x%02X\r\n", status_register);
-        UART_Debug_PutString(message); 
+        Boot_Log(LOG_STATUS_REG, status_register);
     }
     else
     {
-        UART_Debug_PutString("Error occurred during I2C comm to read status register\r\n");   
+        Boot_Log(LOG_STATUS_REG_ERROR);
     }
     
     /******************************************/
-    /*        Read Control Register 1         */
+    /*    Load the configuration registers    */
     /******************************************/
-    uint8_t ctrl_reg1; 
-    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                        LIS3DH_CTRL_REG1,
-                                        &ctrl_reg1);
     
-    if (error == NO_ERROR)
-    {
-        sprintf(message, "CONTROL REGISTER 1: 0x%02X\r\n", ctrl_reg1);
-        UART_Debug_PutString(message); 
-    }
-    else
+    /* TEMP_CFG_REG and CTRL_REG1..CTRL_REG6 are read in a single burst: from 
+    now on a register is written only if its value has to change */
+    error = LIS3DH_Config_Load();
+    
+    if (error != NO_ERROR)
     {
-        UART_Debug_PutString("Error occurred during I2C comm to read control register 1\r\n");   
+        Boot_Log(LOG_CONFIG_LOAD_ERROR);
     }
     
     /******************************************/
@@ -105,170 +100,275 @@ int main(void)
     /******************************************/
     
         
-    UART_Debug_PutString("\r\nWriting new values..\r\n");
+    Boot_Log(LOG_WRITING);
     
-    if (ctrl_reg1 != LIS3DH_NORMAL_MODE_CTRL_REG1)
-    {
-        ctrl_reg1 = LIS3DH_NORMAL_MODE_CTRL_REG1;
+    /* Whole configuration of the accelerometer (FIFO and INT1 routing included): only 
+    the registers which differ from the loaded values are written, adjacent ones in a 
+    single burst (see LIS3DH_Config.h) */
+    const LIS3DH_Config_Entry configuration[] = {
+        {LIS3DH_TEMP_CFG_REG,  0x00},
+        {LIS3DH_CTRL_REG1,     LIS3DH_PROFILE_CTRL_REG1}, // derived from the acquisition profile
+        {LIS3DH_CTRL_REG2,     0x00},
+        {LIS3DH_CTRL_REG3,     LIS3DH_CONFIG_CTRL_REG3},
+        {LIS3DH_CTRL_REG4,     LIS3DH_PROFILE_CTRL_REG4}, // derived from the acquisition profile
+        {LIS3DH_CTRL_REG5,     LIS3DH_CONFIG_CTRL_REG5},
+        {LIS3DH_CTRL_REG6,     0x00},
+        {LIS3DH_FIFO_CTRL_REG, LIS3DH_CONFIG_FIFO_CTRL_REG},
+        {LIS3DH_INT1_CFG,      0x00},
+    };
     
-        error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                             LIS3DH_CTRL_REG1,
-                                             ctrl_reg1);
+    error = LIS3DH_Config_Apply(configuration, sizeof(configuration) / sizeof(configuration[0]));
     
-        if (error == NO_ERROR)
-        {
-            sprintf(message, "CONTROL REGISTER 1 successfully written as: 0x%02X\r\n", ctrl_reg1);
-            UART_Debug_PutString(message); 
-        }
-        else
-        {
-            UART_Debug_PutString("Error occurred during I2C comm to set control register 1\r\n");   
-        }
+    if (error != NO_ERROR)
+    {
+        Boot_Log(LOG_CONFIG_APPLY_ERROR);
     }
     
-    /******************************************/
-    /*     Read Control Register 1 again      */
-    /******************************************/
-
-    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                        LIS3DH_CTRL_REG1,
-                                        &ctrl_reg1);
+    /*  Axes to be acquired (already enabled by the table above): the read burst and the frames are sized on them  */
+    error = LIS3DH_SetAxes(ACC_AXES);
     
-    if (error == NO_ERROR)
+    if (error != NO_ERROR)
     {
-        sprintf(message, "CONTROL REGISTER 1 after overwrite operation: 0x%02X\r\n", ctrl_reg1);
-        UART_Debug_PutString(message); 
-    }
-    else
-    {
-        UART_Debug_PutString("Error occurred during I2C comm to read control register 1\r\n");   
+        Boot_Log(LOG_AXES_ERROR);
     }
     
-
+#if (USE_INT1)
+    /*  Data ready (or FIFO watermark) is routed to INT1: the CPU sleeps between events  */
+    error = LIS3DH_Interrupt_Start();
     
-    uint8_t ctrl_reg4;
-
-    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                        LIS3DH_CTRL_REG4,
-                                        &ctrl_reg4);
-    
-    if (error == NO_ERROR)
+    if (error != NO_ERROR)
     {
-        sprintf(message, "CONTROL REGISTER 4: 0x%02X\r\n", ctrl_reg4);
-        UART_Debug_PutString(message); 
+        Boot_Log(LOG_INTERRUPT_ERROR);
     }
-    else
-    {
-        UART_Debug_PutString("Error occurred during I2C comm to read control register4\r\n");   
-    }
-    
-    
-    ctrl_reg4 = LIS3DH_CTRL_REG4_BDU_ACTIVE; // must be changed to the appropriate value
+#elif (USE_POLL_TIMER)
+    /*  One read per tick of the poll timer: the CPU sleeps between the ticks  */
+    LIS3DH_Schedule_Start();
+#endif
     
-    error = I2C_Peripheral_WriteRegister(LIS3DH_DEVICE_ADDRESS,
-                                         LIS3DH_CTRL_REG4,
-                                         ctrl_reg4);
-    
-    error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                        LIS3DH_CTRL_REG4,
-                                        &ctrl_reg4);
+    /******************************************/
+    /*   Verify the whole configuration once  */
+    /******************************************/
     
+    uint8_t config[LIS3DH_CONFIG_REG_COUNT]; //TEMP_CFG_REG (config[0]) and CTRL_REG1..CTRL_REG6
+    error = LIS3DH_Config_Verify(&config[0]);
     
     if (error == NO_ERROR)
     {
-        sprintf(message, "CONTROL REGISTER 4 after being updated: 0x%02X\r\n", ctrl_reg4);
-        UART_Debug_PutString(message); 
+        Boot_Log(LOG_CONFIG, config[1], config[2], config[3], config[4], config[5], config[6]);
     }
     else
     {
-        UART_Debug_PutString("Error occurred during I2C comm to read control register4\r\n");   
+        Boot_Log(LOG_CONFIG_VERIFY_ERROR);
     }
     
-    
     /****************************************************/
     /*   variable declaration and for(;;) definition)   */
     /****************************************************/
     
-    #define range   512 /*Maximum data range: indeed, 12-bit resolution corresponds to 4096 levels (values are 
-                        from -2048 to + 2048),namely ±4g. Hence ±1g corresponds to ±512 */
-    #define gravity 9.81 //Gravity acceleration
-    
-    int16_t Out_Acc_X; //X-axis accelerometer value in integer
-    int16_t Out_Acc_Y; //Y-axis accelerometer value in integer
-    int16_t Out_Acc_Z; //Z-axis accelerometer value in integer
-    float32 Out_Acc_X_f; //X-axis accelerometer value in float
-    float32 Out_Acc_Y_f; //Y-axis accelerometer value in float
-    float32 Out_Acc_Z_f; //Z-axis accelerometer value in float
-    uint8_t X_axis[sizeof(float)]; //Usnigned int array storing the 4-bytes X-axis information 
-    uint8_t Y_axis[sizeof(float)]; //Usnigned int array storing the 4-bytes Y-axis information
-    uint8_t Z_axis[sizeof(float)]; //Usnigned int array storing the 4-bytes Z-axis information   
-    uint8_t OutArray[TRANSMIT_BUFFER_SIZE]; //Array of dimension 'TRANSMIT_BUFFER_SIZE' containing all the axis information
-    uint8_t register_count = 5; //Number of registers to be read in sequence (exluding the first passed as argoment of the function 'I2C_Peripheral_ReadRegisterMulti'
-    uint8_t AccData[6]; //Array storing the info read from the 6 adjacent registers
+#if (FRAME_FORMAT != FRAME_FORMAT_DELTA && FRAME_FORMAT != FRAME_FORMAT_PACKED)
+    int32_t Out_Acc; //Accelerometer value of an axis in m/s2 (Q16.16 fixed-point)
+#endif
+    uint8_t* OutArray = NULL; //Frame of the transmit ring (see TxQueue.h) being filled with FRAME_SAMPLES samples
+    uint8_t* OutSample = NULL; //Position of the current sample in OutArray
+    uint8_t frame_samples = 0; //Samples already written in OutArray
+    uint8_t dropped_samples = 0; //Samples of a dropped frame not yet skipped
+    uint8_t axes = ACC_AXES; //Axes of the samples in OutArray (see LIS3DH_SetAxes())
+    uint8_t AccData[ACC_DATA_SIZE]; //Array storing the info read from the adjacent registers
+    uint8_t* sample_data; //Pointer to the first sample to be converted
+    uint8_t sample_count; //Number of samples to be converted
+#if (FRAME_FORMAT != FRAME_FORMAT_HEADER_TAIL)
+    uint16_t sample_index = 0; //Index of the current sample, dropped samples included (sequence number of the packets)
+#else
     uint8_t header = 0xA0;
     uint8_t footer = 0xC0;
+#endif
+    
+    /*  Frames are sent without blocking the acquisition  */
+    TxQueue_Start();
+#if (USE_TELEMETRY)
+    /*  Counters and loop timing sent between the data packets (see Telemetry.h)  */
+    Telemetry_Start();
+#endif
+#if (DECIMATION_RATIO > 1)
+    /*  One sample sent every DECIMATION_RATIO read (see Decimator.h)  */
+    Decimator_Start();
+#endif
+#if (USE_FILTER)
+    /*  Biquad chains of the axes, from the table of FilterCoefficients.h (see Filter.h)  */
+    Filter_Start(NULL);
+#endif
+    /*  Cycles of each stage of the loop (nothing with USE_PROFILER 0, see Profiler.h)  */
+    PROFILER_START();
+#if (FRAME_FORMAT != FRAME_FORMAT_HEADER_TAIL)
+    UART_Debug_PutChar(0); //Delimiter: the messages above are not part of the first packet
+#endif
     
-    /*Setup header and tail*/
-    OutArray[0] = header; //Header
-    OutArray[TRANSMIT_BUFFER_SIZE-1] = footer; //Tail
-
     for(;;)
     {
-        /*    I2C Reading Status Register     */        
-        error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS,
-                                            LIS3DH_STATUS_REG,
-                                            &status_register);
+        /*  Dump of the stage table on request, then a new iteration starting with the wait  */
+        PROFILER_POLL();
+        PROFILER_LOOP();
+        
+#if (USE_INT1)
+        /*  Sleep until INT1 is asserted: without the TX interrupt the queued frames are sent meanwhile, INT1 checked between two calls  */
+        LIS3DH_Interrupt_Wait(USE_UART_TX_ISR ? NULL : TxQueue_Drain);
+#elif (USE_POLL_TIMER)
+        /*  Sleep until the next tick of the poll timer (the same for the frames)  */
+        LIS3DH_Schedule_Wait(USE_UART_TX_ISR ? NULL : TxQueue_Drain);
+#endif
+        /*  Move the queued frames into the UART TX FIFO  */
+        TxQueue_Drain();
+        
+        PROFILER_ENTER(PROFILER_STAGE_READ);
+
+#if (ACQUISITION_MODE == ACQ_MODE_FIFO)
+        /*  Drain the FIFO in a single burst once the watermark is reached  */
+        error = LIS3DH_FifoRead(&AccData[0], &sample_count);
+        sample_data = &AccData[0];
+#else
+        /*  Status register and data in one burst (see LIS3DH_ReadSampleAsync())  */
+        error = LIS3DH_ReadSampleAsync(&AccData[0]);
+        
+        /*  Feed the UART while the bus is busy  */
+        while (error == NO_ERROR && I2C_Peripheral_AsyncPoll())
+        {
+            TxQueue_Drain();
+        }
+        
+        if (error == NO_ERROR)
+        {
+            error = I2C_Peripheral_AsyncWait();
+        }
+        
+        /*  Check if a new set of data is available (stale data is discarded)  */
+        sample_count = (error == NO_ERROR && LIS3DH_IsNewSample(&AccData[0]));
+#if (USE_INT1)
+        /*  INT1 high again: the sample was updated during the burst and may be torn  */
+        sample_count = (sample_count && !LIS3DH_Interrupt_Updated());
+#endif
+        sample_data = &AccData[1];
+#endif
+
+#if (USE_INT1)
+        LIS3DH_Interrupt_CountSamples(sample_count);
+#elif (USE_POLL_TIMER)
+        /*  Follow the output data rate of the sensor (new, stale or overwritten data),
+            a sample ready after the status byte counting as new  */
+        if (error == NO_ERROR)
+        {
+            LIS3DH_Schedule_Update(sample_count ? (AccData[0] | (1 << ZYXDA)) : AccData[0]);
+        }
+#endif
+#if (USE_TELEMETRY)
+        Telemetry_Loop(sample_count);
+#endif
+        /*  Time to the first sample, then the boot messages  */
+        Boot_FirstSample(sample_count);
+        
+#if (DECIMATION_RATIO > 1)
+        /*  The decimated samples take the place of the samples read: the frames see the output rate only  */
+        if (error == NO_ERROR && sample_count > 0)
+        {
+            PROFILER_ENTER(PROFILER_STAGE_DECIMATE);
+            sample_count = Decimator_Process(sample_data, sample_count, LIS3DH_GetAxes());
+        }
+#endif
+#if (USE_FILTER)
+        /*  The whole burst at once, in place: the frames below carry the filtered values  */
+        if (error == NO_ERROR && sample_count > 0)
+        {
+            PROFILER_ENTER(PROFILER_STAGE_FILTER);
+            Filter_Process(sample_data, sample_count, LIS3DH_GetAxes());
+        }
+#endif
         
-        /*  Check if a new set of data is available  */
-        if (status_register & (1 << ZYXDA))
-        {        
-            error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS,
-                                                     LIS3DH_OUT_X_L,
-                                                     register_count,
-                                                     &AccData[0]);
+        for (uint8_t s = 0; error == NO_ERROR && s < sample_count; s++, sample_data += LIS3DH_SAMPLE_SIZE)
+        {
+            PROFILER_ENTER(PROFILER_STAGE_CONVERT);
             
-            if(error == NO_ERROR)
+            if (OutArray == NULL)
             {
-                /*  Brief explanation to send data as float to the Bridge Control Panel: 
-                - The METHOD HERE IMPLEMENTED, namely  < *(float*)(axis) > , allows to directly take the memory occupied   
-                by the specific axis (namely the uint8_t X-axis, Y_axis and Z_axis) and read it as a floating  
-                point number. In this way, when considering the Bridge Control Panel inerface, we can just set the 
-                'float' type and leave the 'scale' parameter as default value of 1 (we do not lose information at all!). 
-                - ANOTHER ALTERNATIVE and STANDARD method (WHICH IS NOT IMPLEMENTED IN THIS FILE) implies multiplying 
-                the acceleration values by a factor of 1000 (while doing the conversion in m/s2 units) and then, 
-                in the Bridge Control Panel interface, setting the 'scale' parameter equal to '0.001' (thus allowing 
-                to keep at least 3 decimals) */
-                
-                /*  X-AXIS  */
-                Out_Acc_X = (int16)((AccData[0] | (AccData[1]<<8)))>>4; //Right justified 16bit integer         
-                Out_Acc_X_f  = (float32)(Out_Acc_X * gravity) / range;  //Convert data into float and rescale in accelaration units 
-                *(float*)(X_axis) = Out_Acc_X_f ;  //Convert float to uint bytes 
-                
-                /*  Y-AXIS  */
-                Out_Acc_Y = (int16)((AccData[2] | (AccData[3]<<8)))>>4; //Right justified 16bit integer
-                Out_Acc_Y_f  = (float32)(Out_Acc_Y * gravity) / range;  //Convert data into float and rescale in accelaration units 
-                *(float*)(Y_axis) = Out_Acc_Y_f ;  //Convert float to uint bytes 
-                
-                /*  Z-AXIS  */
-                Out_Acc_Z = (int16)((AccData[4] | (AccData[5]<<8)))>>4; //Right justified 16bit integer
-                Out_Acc_Z_f  = (float32)(Out_Acc_Z * gravity) / range;  //Convert data into float and rescale in accelaration units  
-                *(float*)(Z_axis) = Out_Acc_Z_f ;  //Convert float to uint bytes
-
-                
-                OutArray[1] = X_axis [0];  //LSB of accelerometer X-axis
-                OutArray[2] = X_axis [1]; 
-                OutArray[3] = X_axis [2]; 
-                OutArray[4] = X_axis [3];  //MSB of accelerometer X-axis
-                OutArray[5] = Y_axis [0];  //LSB of accelerometer Y-axis
-                OutArray[6] = Y_axis [1];
-                OutArray[7] = Y_axis [2];
-                OutArray[8] = Y_axis [3];  //MSB of accelerometer Y-axis
-                OutArray[9] = Z_axis [0];  //LSB of accelerometer Z-axis
-                OutArray[10] = Z_axis [1];
-                OutArray[11] = Z_axis [2];
-                OutArray[12] = Z_axis [3]; //MSB of accelerometer Z-axis         
-                UART_Debug_PutArray(OutArray, TRANSMIT_BUFFER_SIZE); //Send information through UART communication protocol
-                
+                /*  Free frame of the transmit ring: when the UART cannot keep up the whole frame is dropped
+                    (and counted once), its FRAME_SAMPLES samples are skipped  */
+                if (dropped_samples == 0)
+                {
+                    OutArray = TxQueue_GetFrame();
+                    dropped_samples = (OutArray == NULL) ? FRAME_SAMPLES : 0;
+                }
+                if (OutArray == NULL)
+                {
+                    dropped_samples--;
+#if (FRAME_FORMAT != FRAME_FORMAT_HEADER_TAIL)
+                    sample_index++; //The host sees the gap in the sequence numbers
+#endif
+                    continue;
+                }
+                axes = LIS3DH_GetAxes(); //A new set of axes applies from the next frame
+#if (FRAME_FORMAT == FRAME_FORMAT_DELTA)
+                OutSample = DeltaCodec_Start(OutArray, sample_index, FRAME_SAMPLES, axes); //Sequence number, sample count, axes and keyframe
+#elif (FRAME_FORMAT == FRAME_FORMAT_PACKED)
+                OutSample = BitPack_Start(OutArray, sample_index, FRAME_SAMPLES, axes); //Sequence number, sample count, axes and resolution
+#elif (FRAME_FORMAT == FRAME_FORMAT_COBS)
+                Packet_Start(OutArray, sample_index, FRAME_SAMPLES, axes); //Sequence number, sample count and axes
+                OutSample = &OutArray[PACKET_HEADER_SIZE];
+#else
+                OutArray[0] = header; //Header
+#if (FRAME_SAMPLES > 1)
+                OutArray[1] = FRAME_SAMPLES; //Sample count
+#endif
+                OutSample = &OutArray[FRAME_HEADER_SIZE];
+#endif
+                frame_samples = 0;
+            }
+            
+#if (FRAME_FORMAT == FRAME_FORMAT_DELTA)
+            /*  Right-justified values, compressed: the host applies the sensitivity (see DeltaCodec.h)  */
+            OutSample = DeltaCodec_Encode(OutSample, &sample_data[0], axes);
+#elif (FRAME_FORMAT == FRAME_FORMAT_PACKED)
+            /*  Right-justified values at their resolution: the host applies the sensitivity (see BitPack.h)  */
+            OutSample = BitPack_Encode(OutSample, &sample_data[0], axes);
+#else
+            /*  Brief explanation to send data to the Bridge Control Panel: 
+            - Each axis is converted in m/s2 units as a Q16.16 fixed-point number (see Conversion.h): a single 
+            integer multiplication replaces the float/double arithmetic, which the Cortex-M3 emulates in software. 
+            - With OUTPUT_FORMAT_FLOAT the value is turned into a float only when it is written in the frame, so 
+            that, when considering the Bridge Control Panel inerface, we can just set the 'float' type and leave 
+            the 'scale' parameter as default value of 1 (we do not lose information at all!). 
+            - With OUTPUT_FORMAT_Q16_16 the fixed-point value is sent as it is and, in the Bridge Control Panel 
+            interface, the 'scale' parameter must be set equal to 1/65536 */
+            
+            /*  Enabled axes only (X, Y, Z order), each one right after the previous one  */
+            for (uint8_t axis = 0; axis < 3; axis++)
+            {
+                if (axes & (1 << axis))
+                {
+                    Out_Acc = Conversion_Sample(&sample_data[2 * axis]);
+                    Conversion_EncodeMs2(&OutSample[0], Out_Acc);  //4 bytes, LSB first
+                    OutSample += AXIS_BYTES;
+                }
+            }
+#endif
+            
+#if (FRAME_FORMAT != FRAME_FORMAT_HEADER_TAIL)
+            sample_index++;
+#endif
+            
+            if (++frame_samples == FRAME_SAMPLES)
+            {
+                PROFILER_ENTER(PROFILER_STAGE_SEND);
+#if (FRAME_FORMAT != FRAME_FORMAT_HEADER_TAIL)
+#if (FRAME_FORMAT == FRAME_FORMAT_PACKED)
+                OutSample = BitPack_Finish(OutSample);
+#endif
+                TxQueue_Push(Packet_Seal(OutArray, OutSample - &OutArray[PACKET_HEADER_SIZE])); //CRC16 and COBS encoding, then send
+#if (USE_TELEMETRY)
+                Telemetry_Send(sample_index); //Between two data packets, when due
+#endif
+#else
+                *OutSample++ = footer; //Tail, right after the last sample
+                TxQueue_Push(OutSample - OutArray); //Send information through UART communication protocol
+#endif
+                OutArray = NULL;
             }
         }
     }
@@ -0,0 +1,329 @@
+/**
+ * \file AcquisitionSim.c
+ * \brief Host run of the whole firmware against the virtual-time simulator.
+ *
+ * Compiles all the sources of PROJ_2 (or PROJ_3), main.c included, on the
+ * PC (HOST_BUILD, see Host_Tools/Sim): the I2C_Master, UART_Debug,
+ * Timer_Poll and interrupt components are simulated on a virtual clock
+ * and the LIS3DH is a register model (see Sim.h and LIS3DH_Model.h). The
+ * acquisition loop runs unmodified for the given virtual time, then the
+ * program prints:
+ *   - the ground truth of the sensor: samples produced, read and lost
+ *     (overwritten before they were read), samples read per second, their
+ *     age when read and the interval between two reads (mean, standard
+ *     deviation, longest);
+ *   - the boot (see Boot.h): polls of the WHO AM I register until the
+ *     LIS3DH answers, addresses probed by the bus scan, first sample read
+ *     (times of the cycle counter, from Boot_Start()) and, with the
+ *     frames traced, first frame received (virtual time from the reset);
+ *   - the counters of the firmware: overruns seen (LIS3DH_GetOverruns()),
+ *     I2C transactions and errors, frames queued, sent and dropped by the
+ *     transmit ring;
+ *   - the frames received: with the sequence signal of the model, the
+ *     frames of one sample (FRAME_FORMAT_HEADER_TAIL, FRAME_SAMPLES 1,
+ *     all the axes, no filter and no decimation) are traced back to the
+ *     samples they carry (see FrameTrace.h): samples delivered and
+ *     missing, duplicated, torn and untraced frames, latency;
+ *   - the load: I2C bus, UART link, CPU awake (and in interrupts);
+ *   - the faults injected, and whether the run has to be lossless.
+ * The configuration is the one of macro_definition.h; the switches in
+ * #ifndef blocks are set with -D at build time (e.g. -DUSE_INT1=1
+ * -DACQUISITION_MODE=ACQ_MODE_FIFO), the clocks of the TopDesign on the
+ * command line. A run has to be lossless when no fault is injected, the
+ * UART link carries the frames (within 90 % of the bit rate) and the bus
+ * transfers of a sample take less than half of the sample period. The
+ * program exits with 1 if:
+ *   - the samples produced do not add up to the samples read, lost and
+ *     still unread;
+ *   - a frame is duplicated, torn or not traced back to a sample;
+ *   - a run which has to be lossless loses samples in the sensor, drops
+ *     frames in the transmit ring or misses samples on the link.
+ *
+ * Build: gcc -std=c99 -O2 -DHOST_BUILD -Dmain=Firmware_Main -ISim
+ *            -I../AY1920_II_HW_05_PROJ_2.cydsn -o AcquisitionSim AcquisitionSim.c
+ *            Sim/Sim.c Sim/LIS3DH_Model.c Sim/FrameTrace.c
+ *            ../AY1920_II_HW_05_PROJ_2.cydsn/[A-Z]*.c ../AY1920_II_HW_05_PROJ_2.cydsn/main.c -lm
+ * Usage: AcquisitionSim [-t seconds] [-i i2c_hz] [-b baud] [-p ppm] [-n noise]
+ *                       [-e nack_rate] [-s stall_rate] [-d stall_us] [-r seed] [-o file]
+ *        -t    virtual time (default 10 s)
+ *        -i    I2C clock (default 100000)
+ *        -b    UART bit rate (default 9600)
+ *        -p    error of the sensor clock, in ppm (default 0)
+ *        -n    sines with a noise density, in ug/sqrt(Hz), instead of the sequence
+ *              signal (frames not traced; default without tracing 220)
+ *        -e    probability that an address byte is not acknowledged (default 0)
+ *        -s    CPU stalls per second (default 0)
+ *        -d    length of a stall, in us (default 2000)
+ *        -r    seed of the faults (default 1)
+ *        -o    capture of the bytes sent on the UART (input of FrameDecoder)
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FrameTrace.h"
+#include "Sim.h"
+#include "Boot.h"
+#include "I2C_Interface.h"
+#include "LIS3DH.h"
+#include "LIS3DH_Interrupt.h"
+#include "LIS3DH_Profile.h"
+#include "LIS3DH_Schedule.h"
+#include "TxQueue.h"
+#include "macro_definition.h"
+#include "project.h"
+
+#undef main
+
+/**
+*   \brief Frames traced back to their samples: one sample per frame, with the
+*   digits of the sensor in it (see FrameTrace.h).
+*/
+#define ACQUISITION_TRACED (FRAME_FORMAT == FRAME_FORMAT_HEADER_TAIL && FRAME_SAMPLES == 1 && \
+                            DECIMATION_RATIO == 1 && !USE_FILTER && \
+                            ACC_AXES == (ACC_AXIS_X | ACC_AXIS_Y | ACC_AXIS_Z))
+#if (BYTE_TO_SEND == 6)
+    #define ACQUISITION_TRACE_FORMAT FRAME_TRACE_INT16
+#elif (OUTPUT_FORMAT == OUTPUT_FORMAT_Q16_16)
+    #define ACQUISITION_TRACE_FORMAT FRAME_TRACE_Q16
+#else
+    #define ACQUISITION_TRACE_FORMAT FRAME_TRACE_FLOAT
+#endif
+
+/**
+*   \brief Bits on the I2C bus of a read of n registers: start, address,
+*   register, restart, address, data, 9 bits per byte, and stop.
+*/
+#define I2C_READ_BITS(n) (3 + 9 * (3 + (n)))
+
+int Firmware_Main(void);
+
+static double Percent(uint64_t part, uint64_t whole)
+{
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+// Bits on the I2C bus per sample read, at best
+static double AcquisitionSim_BusBits(void)
+{
+#if (ACQUISITION_MODE == ACQ_MODE_FIFO)
+    // FIFO_SRC_REG, FIFO_WATERMARK + 1 samples in one burst, FIFO_SRC_REG again
+    return (double)(2 * I2C_READ_BITS(1) + I2C_READ_BITS(LIS3DH_SAMPLE_SIZE * (FIFO_WATERMARK + 1))) /
+           (FIFO_WATERMARK + 1);
+#elif (USE_INT1)
+    // The data of the sample only
+    return I2C_READ_BITS(LIS3DH_SAMPLE_SIZE);
+#else
+    // Status register, status and data, status register again
+    return I2C_READ_BITS(1) + I2C_READ_BITS(LIS3DH_SAMPLE_BURST_SIZE) + I2C_READ_BITS(1);
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    Sim_Config config = {
+        .seconds = 10,
+        .i2c_hz = 100000,
+        .baud = 9600,
+        .timer_hz = POLL_TIMER_CLOCK_HZ,
+        .sensor = {.boot_us = 5000, .clock_ppm = 0, .noise_ug = 220, .seed = 1,
+                   .signal = ACQUISITION_TRACED ? LIS3DH_MODEL_SIGNAL_SEQUENCE : LIS3DH_MODEL_SIGNAL_SINE},
+        .stall_us = 2000,
+        .seed = 1,
+    };
+    const char* capture_name = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc)
+        {
+            config.seconds = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-i") && i + 1 < argc)
+        {
+            config.i2c_hz = strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+        {
+            config.baud = strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc)
+        {
+            config.sensor.clock_ppm = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+        {
+            config.sensor.noise_ug = atof(argv[++i]);
+            config.sensor.signal = LIS3DH_MODEL_SIGNAL_SINE;
+        }
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc)
+        {
+            config.nack_rate = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+        {
+            config.stall_rate = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+        {
+            config.stall_us = strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+        {
+            config.seed = strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+        {
+            capture_name = argv[++i];
+        }
+        else
+        {
+            config.seconds = 0;
+            break;
+        }
+    }
+    if (config.seconds <= 0 || config.i2c_hz == 0 || config.baud == 0)
+    {
+        fprintf(stderr, "usage: AcquisitionSim [-t seconds] [-i i2c_hz] [-b baud] [-p ppm] [-n noise]\n"
+                        "                      [-e nack_rate] [-s stall_rate] [-d stall_us] [-r seed] [-o file]\n");
+        return 1;
+    }
+    if (capture_name != NULL && (config.capture = fopen(capture_name, "wb")) == NULL)
+    {
+        perror(capture_name);
+        return 1;
+    }
+
+    int traced = (config.sensor.signal == LIS3DH_MODEL_SIGNAL_SEQUENCE);
+
+    if (traced)
+    {
+        FrameTrace_Start(ACQUISITION_TRACE_FORMAT);
+        config.monitor = FrameTrace_Monitor;
+    }
+    if (Sim_Run(&config, Firmware_Main))
+    {
+        fprintf(stderr, "The firmware returned from main()\n");
+    }
+    if (config.capture != NULL)
+    {
+        fclose(config.capture);
+    }
+
+    Sim_Stats sim;
+    LIS3DH_Model_Stats sensor;
+    uint32_t pending;
+    I2C_Peripheral_BusCounters bus;
+    TxQueue_Stats tx;
+    FrameTrace_Stats trace;
+    Boot_Stats boot;
+
+    Sim_GetStats(&sim);
+    LIS3DH_Model_GetStats(&sensor, &pending);
+    I2C_Peripheral_GetBusCounters(&bus);
+    TxQueue_GetStats(&tx);
+    FrameTrace_GetStats(&trace);
+    Boot_GetStats(&boot);
+
+    double seconds = (double)sim.cycles / BCLK__BUS_CLK__HZ;
+    double us_per_cycle = 1e6 / BCLK__BUS_CLK__HZ;
+    double sample_rate = LIS3DH_PROFILE_ODR_HZ / (1.0 + config.sensor.clock_ppm * 1e-6);
+    double link_load = 10.0 * TRANSMIT_BUFFER_SIZE * sample_rate / DECIMATION_RATIO / FRAME_SAMPLES / config.baud;
+    double bus_load = AcquisitionSim_BusBits() * sample_rate / config.i2c_hz;
+    int lossless = (config.nack_rate == 0 && config.stall_rate == 0 && link_load <= 0.9 && bus_load <= 0.5);
+
+    printf("LIS3DH %u Hz, %u bits, I2C %lu Hz, UART %lu bit/s, %.3f s\n",
+           (unsigned)LIS3DH_PROFILE_ODR_HZ, (unsigned)LIS3DH_PROFILE_RESOLUTION_BITS,
+           (unsigned long)config.i2c_hz, (unsigned long)config.baud, seconds);
+    double intervals = (sensor.read > 1) ? (double)(sensor.read - 1) : 1.0;
+    double interval_mean = sensor.interval_sum / intervals;
+    double interval_variance = sensor.interval_sq_sum / intervals - interval_mean * interval_mean;
+
+    printf("sensor:   %llu samples, %llu read (%.1f samples/s), %llu lost (%.2f %%), %lu unread,"
+           " age %.0f us (max %.0f us), interval %.0f us (sd %.0f us, max %.0f us)\n",
+           (unsigned long long)sensor.produced, (unsigned long long)sensor.read,
+           sensor.read / seconds, (unsigned long long)sensor.lost,
+           Percent(sensor.lost, sensor.produced), (unsigned long)pending,
+           sensor.read ? (double)sensor.age_sum / sensor.read * us_per_cycle : 0.0,
+           sensor.age_max * us_per_cycle, interval_mean * us_per_cycle,
+           (interval_variance > 0) ? sqrt(interval_variance) * us_per_cycle : 0.0,
+           sensor.interval_max * us_per_cycle);
+    printf("firmware: %lu overruns, %lu I2C transactions (%lu bytes), %lu I2C errors,"
+           " frames %lu queued, %lu sent, %lu dropped (max level %u)\n",
+           (unsigned long)LIS3DH_GetOverruns(), (unsigned long)bus.transactions,
+           (unsigned long)bus.bytes, (unsigned long)bus.errors,
+           (unsigned long)tx.frames_queued, (unsigned long)tx.frames_sent,
+           (unsigned long)tx.frames_dropped, (unsigned)tx.max_level);
+    printf("boot:     device ready at %.2f ms (%u WHO AM I polls), %u addresses probed,"
+           " first sample read at %.2f ms", boot.ready_cycles * us_per_cycle / 1000.0,
+           (unsigned)boot.who_am_i_polls, (unsigned)boot.probes, boot.first_sample_cycles * us_per_cycle / 1000.0);
+    if (traced && trace.samples)
+    {
+        printf(", first frame received at %.2f ms", trace.first_cycle * us_per_cycle / 1000.0);
+    }
+    printf("\n");
+#if (USE_INT1)
+    LIS3DH_Interrupt_Stats interrupt;
+
+    LIS3DH_Interrupt_GetStats(&interrupt);
+    printf("INT1:     %lu wakes, %lu events, %lu samples, %lu torn, latency %.0f us (min %.0f us, max %.0f us)\n",
+           (unsigned long)interrupt.wakes, (unsigned long)interrupt.events, (unsigned long)interrupt.samples,
+           (unsigned long)interrupt.torn,
+           interrupt.events ? (double)interrupt.latency_sum / interrupt.events * us_per_cycle : 0.0,
+           interrupt.events ? interrupt.latency_min * us_per_cycle : 0.0, interrupt.latency_max * us_per_cycle);
+#elif (USE_POLL_TIMER)
+    LIS3DH_Schedule_Stats schedule;
+
+    LIS3DH_Schedule_GetStats(&schedule);
+    printf("schedule: %lu reads, %lu samples, %lu stale, %lu overruns, %lu late ticks, period %u counts\n",
+           (unsigned long)schedule.reads, (unsigned long)schedule.samples, (unsigned long)schedule.stale_reads,
+           (unsigned long)schedule.overruns, (unsigned long)schedule.late_ticks, (unsigned)schedule.period);
+#endif
+    if (traced)
+    {
+        printf("frames:   %llu received, %llu samples, %llu missing, %llu duplicated, %llu torn,"
+               " %llu untraced, latency %.0f us (max %.0f us)\n",
+               (unsigned long long)trace.frames, (unsigned long long)trace.samples,
+               (unsigned long long)trace.missing, (unsigned long long)trace.duplicates,
+               (unsigned long long)trace.torn, (unsigned long long)trace.untraced,
+               trace.samples ? (double)trace.latency_sum / trace.samples * us_per_cycle : 0.0,
+               trace.latency_max * us_per_cycle);
+    }
+    printf("load:     I2C bus %.1f %%, UART link %.1f %% (%llu bytes), CPU awake %.1f %%,"
+           " interrupts %.1f %% (%llu served by the firmware)\n",
+           Percent(sim.i2c_cycles, sim.cycles), Percent(sim.uart_cycles, sim.cycles),
+           (unsigned long long)sim.uart_bytes, Percent(sim.awake_cycles, sim.cycles),
+           Percent(sim.isr_cycles, sim.cycles), (unsigned long long)sim.interrupts);
+    printf("faults:   %llu NACKs, %llu stalls, %llu bytes into a full TX FIFO;"
+           " %s (link %.0f %%, bus %.0f %% of the sample period)\n",
+           (unsigned long long)sim.nacks, (unsigned long long)sim.stalls,
+           (unsigned long long)sim.uart_overflows, lossless ? "lossless" : "losses allowed",
+           100.0 * link_load, 100.0 * bus_load);
+
+    if (sensor.produced != sensor.read + sensor.lost + pending)
+    {
+        fprintf(stderr, "Samples do not add up: %llu produced, %llu read, %llu lost, %lu unread\n",
+                (unsigned long long)sensor.produced, (unsigned long long)sensor.read,
+                (unsigned long long)sensor.lost, (unsigned long)pending);
+        return 1;
+    }
+    if (trace.duplicates || trace.torn || trace.untraced)
+    {
+        fprintf(stderr, "Frames not delivered as sampled: %llu duplicated, %llu torn, %llu untraced\n",
+                (unsigned long long)trace.duplicates, (unsigned long long)trace.torn,
+                (unsigned long long)trace.untraced);
+        return 1;
+    }
+    if (lossless && (sensor.lost || tx.frames_dropped || trace.missing))
+    {
+        fprintf(stderr, "Samples lost in a lossless run: %llu in the sensor, %lu frames dropped,"
+                        " %llu missing on the link\n",
+                (unsigned long long)sensor.lost, (unsigned long)tx.frames_dropped,
+                (unsigned long long)trace.missing);
+        return 1;
+    }
+    return 0;
+}
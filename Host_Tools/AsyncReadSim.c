@@ -0,0 +1,175 @@
+/**
+ * \file AsyncReadSim.c
+ * \brief CPU busy time of the blocking and of the asynchronous I2C reads.
+ *
+ * Compiles I2C_Interface.c of PROJ_2 (or PROJ_3) on the PC with the
+ * simulator of Host_Tools/Sim and reads bursts of the sizes the firmware
+ * uses (the FIFO Source register alone, the 6 output registers of a sample with
+ * USE_INT1, the Status register and a sample when polling, a FIFO burst of
+ * FIFO_WATERMARK samples) both ways:
+ *   - I2C_Peripheral_ReadRegisterMulti(): the CPU clocks every byte and
+ *     is busy for the whole transfer;
+ *   - I2C_Peripheral_ReadRegisterMultiAsync(): the bytes are moved by the
+ *     interrupt of the I2C component; the CPU polls the transfer with
+ *     I2C_Peripheral_AsyncPoll() and does other work in between (a delay of
+ *     FREE_WORK_US), which is not counted as busy. The busy time is the
+ *     start of the transfer, the interrupts and the polls.
+ * The cycles of the component calls and of its interrupt are the estimates
+ * of the simulator (see Sim.h): the code of the firmware in between costs
+ * nothing, so the busy times are lower bounds. Each burst is read
+ * READ_COUNT times each way and the program prints the mean bus time and
+ * busy time per read, and the share of the blocking busy time left to
+ * other work. The data of the two ways are compared: the program exits with 1 if
+ * a read fails or they differ.
+ *
+ * Build: gcc -std=c99 -O2 -DHOST_BUILD -ISim -I../AY1920_II_HW_05_PROJ_2.cydsn -o AsyncReadSim
+ *            AsyncReadSim.c Sim/Sim.c Sim/LIS3DH_Model.c ../AY1920_II_HW_05_PROJ_2.cydsn/I2C_Interface.c -lm
+ * Usage: AsyncReadSim [-i i2c_hz]
+ *        -i    I2C clock (default 100000)
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "I2C_Interface.h"
+#include "LIS3DH.h"
+#include "Sim.h"
+#include "macro_definition.h"
+#include "project.h"
+
+#define READ_COUNT 20
+#define FREE_WORK_US 10         // Other work between two polls of the asynchronous read
+#define BURST_MAX 255
+
+typedef struct {
+    const char* name;
+    uint8_t first;              // First register
+    uint8_t count;              // Registers read
+} Burst;
+
+static const Burst bursts[] = {
+    {"FIFO Source register",    LIS3DH_FIFO_SRC_REG, 1},
+    {"sample (USE_INT1)",       LIS3DH_OUT_X_L,      LIS3DH_SAMPLE_SIZE},
+    {"status and sample",       LIS3DH_STATUS_REG,   LIS3DH_SAMPLE_BURST_SIZE},
+    {"FIFO burst",              LIS3DH_OUT_X_L,      FIFO_WATERMARK * LIS3DH_SAMPLE_SIZE},
+};
+
+static int failures = 0;
+
+// Cycles of the virtual clock
+static double AsyncReadSim_Now(void)
+{
+    return Sim_Time() * BCLK__BUS_CLK__HZ;
+}
+
+static uint64_t AsyncReadSim_BusCycles(void)
+{
+    Sim_Stats sim;
+
+    Sim_GetStats(&sim);
+    return sim.i2c_cycles;
+}
+
+// The reads, run as the firmware on the virtual clock
+static int AsyncReadSim_Run(void)
+{
+    static uint8_t blocking_data[BURST_MAX];
+    static uint8_t async_data[BURST_MAX];
+    double us_per_cycle = 1e6 / BCLK__BUS_CLK__HZ;
+    double free_cycles = FREE_WORK_US / us_per_cycle;
+
+    I2C_Peripheral_Start();
+    printf("%-20s %9s %11s %14s %9s\n", "burst", "bus (us)", "blocking", "asynchronous", "CPU left");
+    for (size_t b = 0; b < sizeof(bursts) / sizeof(bursts[0]); b++)
+    {
+        const Burst* burst = &bursts[b];
+        double blocking_busy = 0.0;
+        double async_busy = 0.0;
+        uint64_t bus = 0;
+        int equal = 1;
+
+        for (int r = 0; r < READ_COUNT; r++)
+        {
+            // Blocking: the CPU waits for every byte
+            uint64_t bus_start = AsyncReadSim_BusCycles();
+            double start = AsyncReadSim_Now();
+            ErrorCode error = I2C_Peripheral_ReadRegisterMulti(LIS3DH_DEVICE_ADDRESS, burst->first,
+                                                               burst->count, blocking_data);
+
+            blocking_busy += AsyncReadSim_Now() - start;
+            bus += AsyncReadSim_BusCycles() - bus_start;
+
+            // Asynchronous: other work between the polls
+            int polls = 0;
+
+            start = AsyncReadSim_Now();
+            if (error == NO_ERROR)
+            {
+                error = I2C_Peripheral_ReadRegisterMultiAsync(LIS3DH_DEVICE_ADDRESS, burst->first,
+                                                              burst->count, async_data, NULL);
+            }
+            while (error == NO_ERROR && I2C_Peripheral_AsyncPoll())
+            {
+                CyDelayUs(FREE_WORK_US);
+                polls++;
+            }
+            if (error == NO_ERROR)
+            {
+                error = I2C_Peripheral_AsyncWait();
+            }
+            async_busy += AsyncReadSim_Now() - start - polls * free_cycles;
+
+            if (error != NO_ERROR)
+            {
+                printf("%-20s read failed\n", burst->name);
+                failures++;
+                break;
+            }
+            equal = equal && !memcmp(blocking_data, async_data, burst->count);
+        }
+        printf("%-20s %9.0f %8.0f us %11.0f us %8.1f %%%s\n", burst->name, bus * us_per_cycle / READ_COUNT,
+               blocking_busy * us_per_cycle / READ_COUNT, async_busy * us_per_cycle / READ_COUNT,
+               100.0 * (1.0 - async_busy / blocking_busy), equal ? "" : "  data differ");
+        failures += !equal;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    Sim_Config config = {
+        .seconds = 100,
+        .i2c_hz = 100000,
+        .baud = 115200,
+        .timer_hz = 1000000,
+        .seed = 1,
+    };
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-i") && i + 1 < argc)
+        {
+            config.i2c_hz = strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            config.i2c_hz = 0;
+            break;
+        }
+    }
+    if (config.i2c_hz == 0)
+    {
+        fprintf(stderr, "usage: AsyncReadSim [-i i2c_hz]\n");
+        return 1;
+    }
+
+    // The reads return before the end of the virtual time
+    if (!Sim_Run(&config, AsyncReadSim_Run))
+    {
+        fprintf(stderr, "The reads did not end within the virtual time\n");
+        return 1;
+    }
+    return failures ? 1 : 0;
+}
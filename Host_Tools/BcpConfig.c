@@ -0,0 +1,269 @@
+/**
+ * \file BcpConfig.c
+ * \brief Bridge Control Panel configuration of the header/tail frames.
+ *
+ * Writes the .iic file (the RX8 command with the frame layout) and the .ini
+ * file (the variables to be plotted) for the frames of FRAME_FORMAT_HEADER_TAIL
+ * with the given FRAME_SAMPLES and ACC_AXES: a frame holds the enabled axes
+ * only, so the Bridge Control Panel must be configured for the same axes as
+ * the firmware. The .ini is a copy of a template (one of the files in
+ * 'Bridge Control Panel') where the X_axis, Y_axis and Z_axis variables are
+ * set active or not and get the type of the values.
+ *
+ * Build: gcc -std=c99 -O2 -o BcpConfig BcpConfig.c
+ * Usage: BcpConfig [-p 2|3] [-n samples] [-a axes] [-q] template.ini name
+ *        -p 2  PROJ_2 frames: int16 values in mg (default)
+ *        -p 3  PROJ_3 frames: float values in m/s2
+ *        -q    PROJ_3 frames with OUTPUT_FORMAT_Q16_16
+ *        -n    FRAME_SAMPLES of the firmware (default 1)
+ *        -a    ACC_AXES of the firmware, e.g. xyz (default) or z
+ *        writes name.iic and name.ini
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_MAX_SIZE 255
+#define LINE_SIZE 256
+
+typedef enum {
+    VALUE_INT16,    ///< PROJ_2: 2 bytes per axis, mg
+    VALUE_FLOAT,    ///< PROJ_3: 4 bytes per axis, float m/s2
+    VALUE_Q16_16    ///< PROJ_3: 4 bytes per axis, Q16.16 m/s2
+} ValueFormat;
+
+static const char* const axis_names[3] = {"X_axis", "Y_axis", "Z_axis"};
+
+static ValueFormat format = VALUE_INT16;
+static int frame_samples = 1;
+static int frame_axes = 0x07;
+
+static int ValueSize(void)
+{
+    return (format == VALUE_INT16) ? 2 : 4;
+}
+
+static int WriteIic(const char* path)
+{
+    FILE* out = fopen(path, "w");
+
+    if (out == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+
+    fprintf(out, ";---------------------------- RX8 packet structure --------------------------\n");
+    fprintf(out, ";Header = {0xA0};\n");
+    if (frame_samples > 1)
+    {
+        fprintf(out, ";Count = {0x%02X}; (number of samples, FRAME_SAMPLES %d in macro_definition.h)\n",
+                frame_samples, frame_samples);
+        fprintf(out, ";Data = { %d samples of:", frame_samples);
+    }
+    else
+    {
+        fprintf(out, ";Data = {");
+    }
+    for (int a = 0, first = 1; a < 3; a++)
+    {
+        if (frame_axes & (1 << a))
+        {
+            fprintf(out, "%s %d bytes %s %s", first ? "" : ",", ValueSize(), axis_names[a],
+                    (format == VALUE_INT16) ? "int16" : (format == VALUE_FLOAT) ? "float" : "Q16.16");
+            first = 0;
+        }
+    }
+    fprintf(out, " }\n");
+    fprintf(out, ";Tail = {0xC0};\n");
+    fprintf(out, ";-----------------------------------------------------------------------------\n");
+
+    fprintf(out, "rx8 [h=A0]");
+    if (frame_samples > 1)
+    {
+        fprintf(out, " @0count");
+    }
+    for (int s = 0; s < frame_samples; s++)
+    {
+        for (int a = 0; a < 3; a++)
+        {
+            for (int b = 0; (frame_axes & (1 << a)) && b < ValueSize(); b++)
+            {
+                fprintf(out, " @%d%s", b, axis_names[a]);
+            }
+        }
+    }
+    fprintf(out, " [t=C0]\n");
+
+    return fclose(out) == 0;
+}
+
+/* Axis (0-2) of the variable defined by a 'VarN.VariableName=' line, -1 if none */
+static int VariableAxis(const char* line, int* number)
+{
+    char name[LINE_SIZE];
+
+    if (sscanf(line, "Var%d.VariableName=%255[^\r\n]", number, name) != 2)
+    {
+        return -1;
+    }
+    for (int a = 0; a < 3; a++)
+    {
+        if (!strcmp(name, axis_names[a]))
+        {
+            return a;
+        }
+    }
+    return -1;
+}
+
+static int WriteIni(const char* template_path, const char* path)
+{
+    FILE* in = fopen(template_path, "r");
+    FILE* out;
+    char line[LINE_SIZE];
+    int numbers[3] = {0, 0, 0};
+    int number, axis;
+
+    if (in == NULL)
+    {
+        perror(template_path);
+        return 0;
+    }
+
+    // First pass: the variables holding the axes
+    while (fgets(line, sizeof(line), in))
+    {
+        if ((axis = VariableAxis(line, &number)) >= 0)
+        {
+            numbers[axis] = number;
+        }
+    }
+    if (!numbers[0] || !numbers[1] || !numbers[2])
+    {
+        fprintf(stderr, "%s: X_axis, Y_axis and Z_axis variables not found\n", template_path);
+        fclose(in);
+        return 0;
+    }
+
+    if ((out = fopen(path, "w")) == NULL)
+    {
+        perror(path);
+        fclose(in);
+        return 0;
+    }
+
+    rewind(in);
+    while (fgets(line, sizeof(line), in))
+    {
+        char key[LINE_SIZE];
+        const char* eol = strchr(line, '\r') ? "\r\n" : "\n";
+
+        axis = -1;
+        if (sscanf(line, "Var%d.%255[^=]=", &number, key) == 2)
+        {
+            for (int a = 0; a < 3; a++)
+            {
+                axis = (numbers[a] == number) ? a : axis;
+            }
+        }
+
+        if (axis < 0)
+        {
+            fputs(line, out);
+        }
+        else if (!strcmp(key, "Active"))
+        {
+            fprintf(out, "Var%d.Active=%s%s", number, (frame_axes & (1 << axis)) ? "True" : "False", eol);
+        }
+        else if (!strcmp(key, "Type"))
+        {
+            fprintf(out, "Var%d.Type=%s%s", number, (format == VALUE_FLOAT) ? "float" : "int", eol);
+        }
+        else if (!strcmp(key, "Scale"))
+        {
+            // Q16.16: 1/65536
+            fprintf(out, "Var%d.Scale=%s%s", number, (format == VALUE_Q16_16) ? "0.0000152587890625" : "1", eol);
+        }
+        else
+        {
+            fputs(line, out);
+        }
+    }
+
+    fclose(in);
+    return fclose(out) == 0;
+}
+
+int main(int argc, char** argv)
+{
+    const char* paths[2] = {NULL, NULL};
+    int path_count = 0;
+    char path[FILENAME_MAX];
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-p") && i + 1 < argc)
+        {
+            format = (atoi(argv[++i]) == 3) ? VALUE_FLOAT : VALUE_INT16;
+        }
+        else if (!strcmp(argv[i], "-q"))
+        {
+            format = VALUE_Q16_16;
+        }
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+        {
+            frame_samples = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-a") && i + 1 < argc)
+        {
+            const char* axis = argv[++i];
+
+            frame_axes = 0;
+            for (; *axis; axis++)
+            {
+                frame_axes |= (*axis == 'x') ? 1 : (*axis == 'y') ? 2 : (*axis == 'z') ? 4 : 0;
+            }
+        }
+        else if (path_count < 2)
+        {
+            paths[path_count++] = argv[i];
+        }
+    }
+
+    int axis_count = (frame_axes & 1) + ((frame_axes >> 1) & 1) + ((frame_axes >> 2) & 1);
+    int frame_size = ((frame_samples > 1) ? 2 : 1) + frame_samples * axis_count * ValueSize() + 1;
+
+    if (path_count < 2)
+    {
+        fprintf(stderr, "usage: BcpConfig [-p 2|3] [-n samples] [-a axes] [-q] template.ini name\n");
+        return 1;
+    }
+    if (axis_count == 0)
+    {
+        fprintf(stderr, "invalid axes\n");
+        return 1;
+    }
+    if (frame_samples < 1 || frame_size > FRAME_MAX_SIZE)
+    {
+        fprintf(stderr, "invalid number of samples per frame\n");
+        return 1;
+    }
+
+    snprintf(path, sizeof(path), "%s.iic", paths[1]);
+    if (!WriteIic(path))
+    {
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s.ini", paths[1]);
+    if (!WriteIni(paths[0], path))
+    {
+        return 1;
+    }
+
+    fprintf(stderr, "%d bytes per frame\n", frame_size);
+    return 0;
+}
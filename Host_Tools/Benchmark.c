@@ -0,0 +1,176 @@
+/**
+ * \file Benchmark.c
+ * \brief Host benchmark of the acquisition: one row of the throughput matrix.
+ *
+ * Compiles all the sources of PROJ_1, PROJ_2 or PROJ_3 on the PC, as
+ * AcquisitionSim does, with the acquisition profile set at build time
+ * (Benchmark.sh builds and runs the whole matrix). The LIS3DH model sends
+ * the sequence signal (see LIS3DH_Model.h): every frame leaving the UART
+ * (0xA0 header, 0xC0 tail) is decoded in the format of the project and
+ * traced back to the sample it carries, so that the measures are end to end:
+ *   - samples/s: distinct samples delivered per second, from the first
+ *     frame to the end of the run;
+ *   - loss: samples produced from the first delivered to the last
+ *     delivered one and never delivered (overwritten in the sensor, dropped
+ *     by the transmit ring or skipped by design, as the 10 Hz reads of PROJ_1);
+ *   - CPU: time awake over the same window;
+ *   - latency: from the data ready of a sample to the stop bit of the last
+ *     byte of its frame, mean and maximum;
+ *   - first frame: from the reset to the stop bit of the frame of the
+ *     first sample delivered, boot and configuration included (the time
+ *     to first sample).
+ * Frames carrying a sample already delivered (read twice), torn samples
+ * (X and Z of two different samples) and frames not traced back to a
+ * sample are counted apart (see Sim/FrameTrace.h): any of them fails the
+ * run, which exits 1 after its row.
+ * The result is one CSV row (the header line first with -H).
+ *
+ * Build: gcc -std=c99 -O2 -DHOST_BUILD -Dmain=Firmware_Main -ISim
+ *            -I../AY1920_II_HW_05_PROJ_2.cydsn -o Benchmark Benchmark.c
+ *            Sim/Sim.c Sim/LIS3DH_Model.c Sim/FrameTrace.c
+ *            ../AY1920_II_HW_05_PROJ_2.cydsn/[A-Z]*.c
+ *            ../AY1920_II_HW_05_PROJ_2.cydsn/main.c -lm
+ * Usage: Benchmark [-p 1|2|3] [-t seconds] [-i i2c_hz] [-b baud] [-H]
+ *        -p 1  PROJ_1 frames: temperature, int16
+ *        -p 2  PROJ_2 frames: int16 values in mg (default)
+ *        -p 3  PROJ_3 frames: float values in m/s2 (Q16.16 with
+ *              OUTPUT_FORMAT_Q16_16)
+ *        -t    virtual time (default 5 s)
+ *        -i    I2C clock (default 100000)
+ *        -b    UART bit rate (default 9600)
+ *        -H    print the header line first
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FrameTrace.h"
+#include "Sim.h"
+#include "macro_definition.h"
+#include "project.h"
+
+#undef main
+
+#ifndef POLL_TIMER_CLOCK_HZ
+    #define POLL_TIMER_CLOCK_HZ 1000000 // PROJ_1: no Timer_Poll
+#endif
+
+#if defined(OUTPUT_FORMAT_Q16_16) && (OUTPUT_FORMAT == OUTPUT_FORMAT_Q16_16)
+    #define BENCHMARK_FORMAT_3 FRAME_TRACE_Q16
+#else
+    #define BENCHMARK_FORMAT_3 FRAME_TRACE_FLOAT
+#endif
+
+int Firmware_Main(void);
+
+static const char* const format_names[4] = {"temperature_int16", "mg_int16", "ms2_float32", "ms2_q16_16"};
+
+static const char* Benchmark_ModeName(int bits)
+{
+    return (bits == 8) ? "low_power" : (bits == 12) ? "high_resolution" : "normal";
+}
+
+int main(int argc, char** argv)
+{
+    Sim_Config config = {
+        .seconds = 5,
+        .i2c_hz = 100000,
+        .baud = 9600,
+        .timer_hz = POLL_TIMER_CLOCK_HZ,
+        .sensor = {.boot_us = 5000, .signal = LIS3DH_MODEL_SIGNAL_SEQUENCE},
+        .seed = 1,
+        .monitor = FrameTrace_Monitor,
+    };
+    FrameTrace_Format format = FRAME_TRACE_INT16;
+    int header = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-p") && i + 1 < argc)
+        {
+            int project = atoi(argv[++i]);
+
+            if (project < 1 || project > 3)
+            {
+                config.seconds = 0;
+                break;
+            }
+            format = (project == 3) ? BENCHMARK_FORMAT_3 : (FrameTrace_Format)(project - 1);
+        }
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+        {
+            config.seconds = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-i") && i + 1 < argc)
+        {
+            config.i2c_hz = strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+        {
+            config.baud = strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-H"))
+        {
+            header = 1;
+        }
+        else
+        {
+            config.seconds = 0;
+            break;
+        }
+    }
+    if (config.seconds <= 0 || config.i2c_hz == 0 || config.baud == 0)
+    {
+        fprintf(stderr, "usage: Benchmark [-p 1|2|3] [-t seconds] [-i i2c_hz] [-b baud] [-H]\n");
+        return 1;
+    }
+
+    FrameTrace_Start(format);
+    if (Sim_Run(&config, Firmware_Main))
+    {
+        fprintf(stderr, "The firmware returned from main()\n");
+        return 1;
+    }
+
+    Sim_Stats sim;
+    LIS3DH_Model_Format output;
+    FrameTrace_Stats trace;
+
+    Sim_GetStats(&sim);
+    LIS3DH_Model_GetFormat(&output);
+    FrameTrace_GetStats(&trace);
+
+    double us_per_cycle = 1e6 / BCLK__BUS_CLK__HZ;
+    double window = trace.samples ? (double)(sim.cycles - trace.first_cycle) / BCLK__BUS_CLK__HZ : 0.0;
+    uint64_t expected = trace.samples + trace.missing;
+
+    if (header)
+    {
+        printf("format,mode,odr_hz,bits,baud,i2c_hz,seconds,frames,samples,samples_per_s,loss_pct,"
+               "duplicates,torn,untraced,cpu_pct,i2c_pct,uart_pct,latency_mean_us,latency_max_us,first_frame_ms\n");
+    }
+    printf("%s,%s,%g,%d,%lu,%lu,%g,%llu,%llu,%.2f,%.3f,%llu,%llu,%llu,%.2f,%.2f,%.2f,%.0f,%.0f,%.2f\n",
+           format_names[format], Benchmark_ModeName(output.bits), output.odr_hz, output.bits,
+           (unsigned long)config.baud, (unsigned long)config.i2c_hz, config.seconds,
+           (unsigned long long)trace.frames, (unsigned long long)trace.samples,
+           (window > 0) ? trace.samples / window : 0.0,
+           expected ? 100.0 * trace.missing / expected : 0.0,
+           (unsigned long long)trace.duplicates, (unsigned long long)trace.torn,
+           (unsigned long long)trace.untraced,
+           (window > 0) ? 100.0 * (sim.awake_cycles - trace.first_awake) / (sim.cycles - trace.first_cycle) : 0.0,
+           100.0 * sim.i2c_cycles / sim.cycles, 100.0 * sim.uart_cycles / sim.cycles,
+           trace.samples ? (double)trace.latency_sum / trace.samples * us_per_cycle : 0.0,
+           trace.latency_max * us_per_cycle, trace.samples ? trace.first_cycle * us_per_cycle / 1000.0 : 0.0);
+
+    // Pass/fail: every frame carries a whole sample, delivered once
+    if (trace.duplicates || trace.torn || trace.untraced)
+    {
+        fprintf(stderr, "Frames not delivered as sampled: %llu duplicated, %llu torn, %llu untraced\n",
+                (unsigned long long)trace.duplicates, (unsigned long long)trace.torn,
+                (unsigned long long)trace.untraced);
+        return 1;
+    }
+    return 0;
+}
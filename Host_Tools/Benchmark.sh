@@ -0,0 +1,97 @@
+#!/bin/sh
+#
+# \file Benchmark.sh
+# \brief Throughput matrix of the acquisition on the host (see Benchmark.c).
+#
+# Builds Benchmark.c with the firmware of each project for every output
+# data rate of the LIS3DH in the low power, normal and high resolution
+# modes, and runs each build at the standard bit rates of UART_Debug:
+#   - PROJ_1: temperature, int16 (CTRL_REG1 and CTRL_REG4 set with -D);
+#   - PROJ_2: acceleration in mg, int16 (ACC_POWER_MODE and ACC_ODR set with -D);
+#   - PROJ_3: acceleration in m/s2, float (the same).
+# The other switches keep their value in macro_definition.h, unless given
+# on the command line (e.g. -DACQUISITION_MODE=ACQ_MODE_FIFO -DUSE_INT1=1).
+# The result is a CSV table on the standard output: the revision of the
+# tree and the project, then the columns of Benchmark.c, so that the tables
+# of two versions can be compared row by row.
+# A run with duplicated, torn or untraced frames fails (see Benchmark.c):
+# its row is kept and the script exits 1 at the end, after the whole
+# matrix, so that a regression fails the benchmark.
+#
+# Usage: Benchmark.sh [-t seconds] [-i i2c_hz] [-D...] > benchmark.csv
+#        -t    virtual time of each run (default 5 s)
+#        -i    I2C clock (default 100000)
+#        -D    switch of macro_definition.h, for all the builds
+#
+# \Author Marco Sinatra
+#
+
+TOOLS=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(dirname "$TOOLS")
+BAUDS="9600 19200 38400 57600 115200"
+SECONDS_RUN=5
+I2C_HZ=100000
+DEFINES=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -t) SECONDS_RUN=$2; shift 2 ;;
+        -i) I2C_HZ=$2; shift 2 ;;
+        -D*) DEFINES="$DEFINES $1"; shift ;;
+        *) echo "usage: Benchmark.sh [-t seconds] [-i i2c_hz] [-D...]" >&2; exit 1 ;;
+    esac
+done
+
+REVISION=$(git -C "$ROOT" describe --always --dirty 2>/dev/null || echo unknown)
+BUILD=$(mktemp -d) || exit 1
+trap 'rm -rf "$BUILD"' EXIT
+
+HEADER=1
+FAILED=0
+for PROJECT in 1 2 3; do
+    SOURCES="$ROOT/AY1920_II_HW_05_PROJ_$PROJECT.cydsn"
+    # Power modes as LIS3DH_MODE_*: 0 low power, 1 normal, 2 high resolution
+    for MODE in 0 1 2; do
+        # ODR codes as LIS3DH_ODR_*: 8 (1.6 kHz) is low power only, 9 is 1.344 kHz or 5.376 kHz
+        for ODR in 1 2 3 4 5 6 7 8 9; do
+            if [ "$ODR" -eq 8 ] && [ "$MODE" -ne 0 ]; then
+                continue
+            fi
+            if [ "$PROJECT" -eq 1 ]; then
+                LP=$([ "$MODE" -eq 0 ] && echo 1 || echo 0)
+                HR=$([ "$MODE" -eq 2 ] && echo 1 || echo 0)
+                PROFILE="-DLIS3DH_NORMAL_MODE_CTRL_REG1=$(( (ODR << 4) | (LP << 3) | 0x07 ))"
+                PROFILE="$PROFILE -DLIS3DH_CTRL_REG4_BDU_ACTIVE=$(( 0x80 | (HR << 3) ))"
+            else
+                PROFILE="-DACC_POWER_MODE=$MODE -DACC_ODR=$ODR"
+            fi
+            PROGRAM="$BUILD/Benchmark_${PROJECT}_${MODE}_${ODR}"
+            if ! gcc -std=c99 -O2 -DHOST_BUILD -Dmain=Firmware_Main $PROFILE $DEFINES \
+                     -I"$TOOLS/Sim" -I"$SOURCES" -o "$PROGRAM" "$TOOLS/Benchmark.c" \
+                     "$TOOLS/Sim/Sim.c" "$TOOLS/Sim/LIS3DH_Model.c" "$TOOLS/Sim/FrameTrace.c" \
+                     "$SOURCES"/*.c -lm 2>/dev/null; then
+                echo "PROJ_$PROJECT $PROFILE: build failed" >&2
+                continue
+            fi
+            for BAUD in $BAUDS; do
+                # The exit status of the run, not of sed: its rows go through a file
+                if ! "$PROGRAM" -p "$PROJECT" -t "$SECONDS_RUN" -i "$I2C_HZ" -b "$BAUD" \
+                     $([ "$HEADER" -eq 1 ] && echo -H) > "$BUILD/rows"; then
+                    echo "PROJ_$PROJECT $PROFILE at $BAUD baud: failed" >&2
+                    FAILED=$((FAILED + 1))
+                fi
+                if [ "$HEADER" -eq 1 ]; then
+                    sed "1s/^/revision,project,/; 2s/^/$REVISION,PROJ_$PROJECT,/" "$BUILD/rows"
+                    HEADER=0
+                else
+                    sed "s/^/$REVISION,PROJ_$PROJECT,/" "$BUILD/rows"
+                fi
+            done
+        done
+    done
+done
+
+if [ "$FAILED" -gt 0 ]; then
+    echo "$FAILED runs failed" >&2
+    exit 1
+fi
@@ -0,0 +1,94 @@
+#!/bin/sh
+#
+# \file Check.sh
+# \brief All the checks of the host tools in one run.
+#
+# Runs the check scripts and the checking programs of Host_Tools against
+# the firmware of PROJ_2 and PROJ_3 in the simulator:
+#   - ConversionCheck.sh, also with INT1 (USE_INT1=1);
+#   - FifoCheck.sh and CounterCheck.sh;
+#   - AsyncReadSim.c, ConfigBusCheck.c and ProfilerSim.c, built for each
+#     project as in the README;
+#   - with -b, the throughput matrices of Benchmark.sh (status register,
+#     FIFO, INT1, poll timer at 400 kHz), the tables themselves discarded.
+# The output of each check goes to the standard output, a line per failed
+# check to the standard error. The script exits 1 if a check fails.
+#
+# Usage: Check.sh [-b]
+#        -b    run the benchmark matrices too (a quarter of an hour)
+#
+# \Author Marco Sinatra
+#
+
+TOOLS=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(dirname "$TOOLS")
+BENCHMARK=0
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -b) BENCHMARK=1; shift ;;
+        *) echo "usage: Check.sh [-b]" >&2; exit 1 ;;
+    esac
+done
+
+BUILD=$(mktemp -d) || exit 1
+trap 'rm -rf "$BUILD"' EXIT
+
+FAILED=0
+
+# check NAME COMMAND...: runs a check and counts it if it fails
+check() {
+    NAME=$1
+    shift
+    echo "== $NAME"
+    if ! "$@"; then
+        echo "$NAME: failed" >&2
+        FAILED=$((FAILED + 1))
+    fi
+}
+
+check "ConversionCheck" sh "$TOOLS/ConversionCheck.sh"
+check "ConversionCheck, INT1" sh "$TOOLS/ConversionCheck.sh" -DUSE_INT1=1
+check "FifoCheck" sh "$TOOLS/FifoCheck.sh"
+check "CounterCheck" sh "$TOOLS/CounterCheck.sh"
+
+for PROJECT in 2 3; do
+    SOURCES="$ROOT/AY1920_II_HW_05_PROJ_$PROJECT.cydsn"
+    FLAGS="-std=c99 -O2 -DHOST_BUILD -I$TOOLS/Sim -I$SOURCES"
+
+    if gcc $FLAGS -o "$BUILD/AsyncReadSim" "$TOOLS/AsyncReadSim.c" "$TOOLS/Sim/Sim.c" \
+           "$TOOLS/Sim/LIS3DH_Model.c" "$SOURCES/I2C_Interface.c" -lm; then
+        check "PROJ_$PROJECT AsyncReadSim" "$BUILD/AsyncReadSim"
+    else
+        echo "PROJ_$PROJECT AsyncReadSim: build failed" >&2
+        FAILED=$((FAILED + 1))
+    fi
+
+    if gcc $FLAGS -o "$BUILD/ConfigBusCheck" "$TOOLS/ConfigBusCheck.c" "$TOOLS/Sim/Sim.c" \
+           "$TOOLS/Sim/LIS3DH_Model.c" "$SOURCES/LIS3DH_Config.c" "$SOURCES/I2C_Interface.c" -lm; then
+        check "PROJ_$PROJECT ConfigBusCheck" "$BUILD/ConfigBusCheck"
+    else
+        echo "PROJ_$PROJECT ConfigBusCheck: build failed" >&2
+        FAILED=$((FAILED + 1))
+    fi
+
+    if gcc $FLAGS -DUSE_PROFILER=1 -o "$BUILD/ProfilerSim" "$TOOLS/ProfilerSim.c" \
+           "$SOURCES/Profiler.c" "$SOURCES/Log.c"; then
+        check "PROJ_$PROJECT ProfilerSim" "$BUILD/ProfilerSim"
+    else
+        echo "PROJ_$PROJECT ProfilerSim: build failed" >&2
+        FAILED=$((FAILED + 1))
+    fi
+done
+
+if [ "$BENCHMARK" -eq 1 ]; then
+    check "Benchmark" sh -c "sh '$TOOLS/Benchmark.sh' > /dev/null"
+    check "Benchmark, FIFO" sh -c "sh '$TOOLS/Benchmark.sh' -DACQUISITION_MODE=ACQ_MODE_FIFO > /dev/null"
+    check "Benchmark, INT1" sh -c "sh '$TOOLS/Benchmark.sh' -DUSE_INT1=1 > /dev/null"
+    check "Benchmark, poll timer" sh -c "sh '$TOOLS/Benchmark.sh' -i 400000 -DUSE_POLL_TIMER=1 > /dev/null"
+fi
+
+if [ "$FAILED" -gt 0 ]; then
+    echo "$FAILED checks failed" >&2
+    exit 1
+fi
@@ -0,0 +1,310 @@
+/**
+ * \file CodecBench.c
+ * \brief Bytes per sample and host speed of the packet codecs of one acquisition profile.
+ *
+ * Compiles DeltaCodec.c, BitPack.c and Packet.c of PROJ_2 on the PC
+ * (HOST_BUILD) with the profile set at build time (CodecBench.sh builds
+ * and runs the low power, normal and high resolution modes) and encodes
+ * three recordings at the output data rate of the profile, made here with
+ * a fixed seed:
+ *   - rest: 1 g on Z and the noise of the LIS3DH (220 ug/sqrt(Hz));
+ *   - walk: plus 0.3 g at 2 Hz on the three axes;
+ *   - shake: plus 1.5 g at 7 Hz on the three axes.
+ * For packets of 1 to 25 samples it prints the bytes per sample on the
+ * link (COBS encoded, delimiter included) of FRAME_FORMAT_DELTA and
+ * FRAME_FORMAT_PACKED, against 8 bytes of the frames of one sample of
+ * FRAME_FORMAT_HEADER_TAIL, and the time to encode and seal a sample on
+ * this PC (the 'encode' stage of USE_PROFILER measures it on the PSoC).
+ * From the walk recording with 16 samples per packet it prints the highest
+ * output data rate each codec carries at the standard bit rates of the
+ * UART (10 bits per byte), as in the table of FRAME_SAMPLES in
+ * macro_definition.h.
+ * With -o the packets of the walk recording are written to a file as the
+ * UART would carry them, one byte in every -d dropped (but in the first
+ * and the last packets), and the values of its samples, in mg as
+ * FrameDecoder prints them, to the same name with .csv appended:
+ * CodecBench.sh decodes the file with FrameDecoder -c and checks the
+ * samples decoded and lost against them.
+ *
+ * Build: gcc -std=c99 -O2 -DHOST_BUILD -ISim -I../AY1920_II_HW_05_PROJ_2.cydsn -o CodecBench CodecBench.c
+ *            ../AY1920_II_HW_05_PROJ_2.cydsn/DeltaCodec.c ../AY1920_II_HW_05_PROJ_2.cydsn/BitPack.c
+ *            ../AY1920_II_HW_05_PROJ_2.cydsn/Packet.c -lm
+ *        (e.g. with -DACC_POWER_MODE=0 for low power)
+ * Usage: CodecBench [-n samples] [-o file] [-c delta|packed] [-k samples] [-d interval]
+ *        -n    samples of each recording (default 100000)
+ *        -o    packets of the walk recording, as sent on the UART
+ *        -c    codec of those packets (default delta)
+ *        -k    samples per packet of those packets (default 16)
+ *        -d    one byte dropped in every 'interval' written (default 0: none)
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "BitPack.h"
+#include "DeltaCodec.h"
+#include "LIS3DH_Profile.h"
+#include "Packet.h"
+#include "macro_definition.h"
+
+#define CODEC_DELTA 0
+#define CODEC_PACKED 1
+#define CODEC_AXES (ACC_AXIS_X | ACC_AXIS_Y | ACC_AXIS_Z)
+#define CODEC_FRAME_SIZE 512
+#define NOISE_UG 220.0                  // Noise density of the LIS3DH (ug/sqrt(Hz))
+#define TIMING_SECONDS 0.2              // Encoding time of each measure, at least
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+static const char* const mode_names[3] = {"low power", "normal", "high resolution"};
+static const char* const codec_names[2] = {"delta", "packed"};
+static const char* const trace_names[3] = {"rest", "walk", "shake"};
+static const double trace_g[3] = {0.0, 0.3, 1.5};     // Amplitude of the motion
+static const double trace_hz[3] = {0.0, 2.0, 7.0};
+static const int packet_samples[] = {1, 4, 8, 16, 25};
+static const long link_bauds[] = {9600, 19200, 57600, 115200};
+
+static uint32_t noise_state = 1;
+static unsigned long dropped = 0;      // Bytes dropped on the way to the file of -o
+
+// Normal value, Box-Muller on the LCG of Numerical Recipes
+static double CodecBench_Gaussian(void)
+{
+    double u1, u2;
+
+    noise_state = noise_state * 1664525u + 1013904223u;
+    u1 = (noise_state + 1.0) / 4294967297.0;
+    noise_state = noise_state * 1664525u + 1013904223u;
+    u2 = (noise_state + 1.0) / 4294967297.0;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+// Output registers of a recording: left-justified digits of the profile, 6 bytes per sample
+static void CodecBench_Record(int trace, uint8_t* samples, long sample_count)
+{
+    int bits = LIS3DH_PROFILE_RESOLUTION_BITS;
+    long limit = 1L << (bits - 1);
+    double sigma_g = NOISE_UG * 1e-6 * sqrt(LIS3DH_PROFILE_ODR_HZ / 2.0);
+
+    noise_state = 1 + trace;
+    for (long s = 0; s < sample_count; s++)
+    {
+        double t = (double)s / LIS3DH_PROFILE_ODR_HZ;
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            double g = (axis == 2 ? 1.0 : 0.0) + trace_g[trace] * sin(2.0 * M_PI * trace_hz[trace] * t + axis) +
+                       sigma_g * CodecBench_Gaussian();
+            long digits = lround(g * 1000.0 / LIS3DH_PROFILE_SENSITIVITY_MG);
+            uint16_t value;
+
+            digits = (digits >= limit) ? limit - 1 : (digits < -limit) ? -limit : digits;
+            value = (uint16_t)((unsigned long)digits << (16 - bits));
+            samples[6 * s + 2 * axis] = (uint8_t)value;
+            samples[6 * s + 2 * axis + 1] = (uint8_t)(value >> 8);
+        }
+    }
+}
+
+// Packets of 'count' samples of a recording, as main.c builds them: bytes on the link
+static unsigned long CodecBench_Encode(int codec, const uint8_t* samples, long sample_count, int count,
+                                       FILE* out, long drop)
+{
+    static uint8_t frame[CODEC_FRAME_SIZE];
+    static long written = 0;
+    unsigned long bytes = 0;
+
+    for (long first = 0; first + count <= sample_count; first += count)
+    {
+        uint8_t* position = (codec == CODEC_DELTA) ?
+                            DeltaCodec_Start(frame, (uint16_t)first, count, CODEC_AXES) :
+                            BitPack_Start(frame, (uint16_t)first, count, CODEC_AXES);
+
+        for (int s = 0; s < count; s++)
+        {
+            position = (codec == CODEC_DELTA) ?
+                       DeltaCodec_Encode(position, &samples[6 * (first + s)], CODEC_AXES) :
+                       BitPack_Encode(position, &samples[6 * (first + s)], CODEC_AXES);
+        }
+        if (codec == CODEC_PACKED)
+        {
+            position = BitPack_Finish(position);
+        }
+
+        uint8_t length = Packet_Seal(frame, position - &frame[PACKET_HEADER_SIZE]);
+
+        bytes += length;
+        for (int i = 0; out != NULL && i < length; i++)
+        {
+            // The first and the last packets are left whole: the loss of either cannot be seen
+            if (drop == 0 || first == 0 || first + 2 * count > sample_count || ++written % drop != 0)
+            {
+                fputc(frame[i], out);
+            }
+            else
+            {
+                dropped++;
+            }
+        }
+    }
+    return bytes;
+}
+
+// Time to encode and seal a sample on this PC, in ns
+static double CodecBench_Time(int codec, const uint8_t* samples, long sample_count, int count)
+{
+    long rounds = 0;
+    clock_t start = clock();
+    clock_t elapsed;
+
+    do
+    {
+        CodecBench_Encode(codec, samples, sample_count, count, NULL, 0);
+        rounds++;
+        elapsed = clock() - start;
+    } while (elapsed < TIMING_SECONDS * CLOCKS_PER_SEC);
+    return 1e9 * elapsed / CLOCKS_PER_SEC / ((double)rounds * (sample_count / count * count));
+}
+
+int main(int argc, char** argv)
+{
+    long sample_count = 100000;
+    const char* out_name = NULL;
+    int out_codec = CODEC_DELTA;
+    int out_samples = 16;
+    long drop = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+        {
+            sample_count = atol(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+        {
+            out_name = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+        {
+            i++;
+            out_codec = !strcmp(argv[i], "delta") ? CODEC_DELTA : !strcmp(argv[i], "packed") ? CODEC_PACKED : -1;
+        }
+        else if (!strcmp(argv[i], "-k") && i + 1 < argc)
+        {
+            out_samples = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+        {
+            drop = atol(argv[++i]);
+        }
+        else
+        {
+            sample_count = 0;
+            break;
+        }
+    }
+    if (sample_count <= 0 || out_codec < 0 || out_samples < 1 || out_samples > 25 || drop < 0)
+    {
+        fprintf(stderr, "usage: CodecBench [-n samples] [-o file] [-c delta|packed] [-k samples] [-d interval]\n");
+        return 1;
+    }
+
+    uint8_t* samples = malloc(6 * sample_count);
+
+    if (samples == NULL)
+    {
+        perror("CodecBench");
+        return 1;
+    }
+    printf("profile:   %s, %d bits, %d Hz, %d mg/digit, %ld samples per recording\n",
+           mode_names[ACC_POWER_MODE], LIS3DH_PROFILE_RESOLUTION_BITS, LIS3DH_PROFILE_ODR_HZ,
+           LIS3DH_PROFILE_SENSITIVITY_MG, sample_count);
+    printf("bytes per sample on the link, by samples per packet (header/tail, 1 sample: 8.00)\n");
+    printf("%-8s %-6s", "codec", "trace");
+    for (size_t n = 0; n < sizeof(packet_samples) / sizeof(packet_samples[0]); n++)
+    {
+        printf("   N=%-3d", packet_samples[n]);
+    }
+    printf("  ns/sample (N=16, this PC)\n");
+
+    double walk_bytes[2] = {0.0, 0.0};     // Bytes per sample of the walk recording with N=16
+
+    for (int codec = CODEC_DELTA; codec <= CODEC_PACKED; codec++)
+    {
+        for (int trace = 0; trace < 3; trace++)
+        {
+            CodecBench_Record(trace, samples, sample_count);
+            printf("%-8s %-6s", codec_names[codec], trace_names[trace]);
+            for (size_t n = 0; n < sizeof(packet_samples) / sizeof(packet_samples[0]); n++)
+            {
+                int count = packet_samples[n];
+                unsigned long bytes = CodecBench_Encode(codec, samples, sample_count, count, NULL, 0);
+
+                printf(" %7.2f", (double)bytes / (sample_count / count * count));
+                if (trace == 1 && count == 16)
+                {
+                    walk_bytes[codec] = (double)bytes / (sample_count / count * count);
+                }
+            }
+            printf("  %9.1f\n", CodecBench_Time(codec, samples, sample_count, 16));
+        }
+    }
+
+    printf("highest ODR carried, walk, N=16 (10 bits per byte on the UART)\n");
+    printf("%-8s %-6s", "codec", "bytes");
+    for (size_t b = 0; b < sizeof(link_bauds) / sizeof(link_bauds[0]); b++)
+    {
+        printf(" %7ld", link_bauds[b]);
+    }
+    printf(" bps\n");
+    for (int codec = CODEC_DELTA; codec <= CODEC_PACKED; codec++)
+    {
+        printf("%-8s %6.2f", codec_names[codec], walk_bytes[codec]);
+        for (size_t b = 0; b < sizeof(link_bauds) / sizeof(link_bauds[0]); b++)
+        {
+            printf(" %7.0f", floor(link_bauds[b] / 10.0 / walk_bytes[codec]));
+        }
+        printf(" Hz\n");
+    }
+
+    // Packets of the walk recording and the values FrameDecoder has to print
+    if (out_name != NULL)
+    {
+        char values_name[FILENAME_MAX];
+        FILE* out = fopen(out_name, "wb");
+        FILE* values;
+
+        snprintf(values_name, sizeof(values_name), "%s.csv", out_name);
+        values = fopen(values_name, "w");
+        if (out == NULL || values == NULL)
+        {
+            perror(out == NULL ? out_name : values_name);
+            return 1;
+        }
+        CodecBench_Record(1, samples, sample_count);
+        unsigned long bytes = CodecBench_Encode(out_codec, samples, sample_count, out_samples, out, drop);
+        for (long s = 0; s < sample_count / out_samples * out_samples; s++)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                int16_t value = (int16_t)(samples[6 * s + 2 * axis] | (samples[6 * s + 2 * axis + 1] << 8));
+
+                fprintf(values, (axis < 2) ? "%g," : "%g\n",
+                        (double)(value >> (16 - LIS3DH_PROFILE_RESOLUTION_BITS)) * LIS3DH_PROFILE_SENSITIVITY_MG);
+            }
+        }
+        fclose(out);
+        fclose(values);
+        printf("output:    %s packets of %d samples of the walk recording in %s: %ld samples, %lu bytes"
+               " (%lu dropped)\n", codec_names[out_codec], out_samples, out_name,
+               sample_count / out_samples * out_samples, bytes, dropped);
+    }
+    free(samples);
+    return 0;
+}
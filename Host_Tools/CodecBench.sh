@@ -0,0 +1,93 @@
+#!/bin/sh
+#
+# \file CodecBench.sh
+# \brief Bytes per sample, host speed and loss recovery of the packet codecs (see CodecBench.c).
+#
+# Builds CodecBench.c with the codecs of PROJ_2 for the low power, normal
+# and high resolution modes (8, 10 and 12 bits) and prints the tables of
+# each one: bytes per sample, and highest ODR carried by bit rate (the
+# table of FRAME_SAMPLES in macro_definition.h). Then, in the normal mode,
+# it writes the packets of the walk recording of both codecs
+# (FRAME_FORMAT_DELTA and FRAME_FORMAT_PACKED) with one byte in every 2000
+# dropped, decodes them with FrameDecoder -c and checks that:
+#   - every value decoded is the value sent, in order (the decoded samples
+#     are a subsequence of the ones sent);
+#   - the samples decoded and the samples counted as lost add up to the
+#     samples sent (the first and the last packets are left whole: the
+#     decoder cannot see a loss before the first packet or after the last).
+# The script exits 1 if a build or a check fails.
+#
+# Usage: CodecBench.sh [-n samples] [-D...]
+#        -n    samples of each recording (default 100000; 400000 for the lossy link)
+#        -D    switch of macro_definition.h, for all the builds
+#
+# \Author Marco Sinatra
+#
+
+TOOLS=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(dirname "$TOOLS")
+SOURCES="$ROOT/AY1920_II_HW_05_PROJ_2.cydsn"
+SAMPLES=100000
+LOSSY_SAMPLES=400000
+DEFINES=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -n) SAMPLES=$2; LOSSY_SAMPLES=$2; shift 2 ;;
+        -D*) DEFINES="$DEFINES $1"; shift ;;
+        *) echo "usage: CodecBench.sh [-n samples] [-D...]" >&2; exit 1 ;;
+    esac
+done
+
+BUILD=$(mktemp -d) || exit 1
+trap 'rm -rf "$BUILD"' EXIT
+
+FAILED=0
+if ! gcc -std=c99 -O2 -I"$SOURCES" -o "$BUILD/FrameDecoder" "$TOOLS/FrameDecoder.c"; then
+    echo "FrameDecoder: build failed" >&2
+    exit 1
+fi
+
+# Power modes as LIS3DH_MODE_*: 0 low power, 1 normal, 2 high resolution
+for MODE in 0 1 2; do
+    PROGRAM="$BUILD/CodecBench_$MODE"
+    if ! gcc -std=c99 -O2 -DHOST_BUILD -DACC_POWER_MODE=$MODE $DEFINES -I"$TOOLS/Sim" -I"$SOURCES" \
+             -o "$PROGRAM" "$TOOLS/CodecBench.c" "$SOURCES/DeltaCodec.c" "$SOURCES/BitPack.c" \
+             "$SOURCES/Packet.c" -lm; then
+        echo "-DACC_POWER_MODE=$MODE: build failed" >&2
+        FAILED=$((FAILED + 1))
+        continue
+    fi
+    "$PROGRAM" -n "$SAMPLES" || FAILED=$((FAILED + 1))
+    echo
+done
+
+# Lossy link: one byte in 2000 dropped
+for CODEC in delta packed; do
+    if ! "$BUILD/CodecBench_1" -n "$LOSSY_SAMPLES" -c "$CODEC" -d 2000 -o "$BUILD/link" > "$BUILD/output"; then
+        FAILED=$((FAILED + 1))
+        continue
+    fi
+    "$BUILD/FrameDecoder" -c "$BUILD/link" > "$BUILD/decoded" 2> "$BUILD/summary"
+    SENT=$(wc -l < "$BUILD/link.csv")
+    DECODED=$(sed -n 's/^[0-9]* packets, \([0-9]*\) samples, .*/\1/p' "$BUILD/summary")
+    LOST=$(sed -n 's/^.* samples, \([0-9]*\) samples lost, .*/\1/p' "$BUILD/summary")
+    DROPPED=$(sed -n 's/^output: .* (\([0-9]*\) dropped)$/\1/p' "$BUILD/output")
+    echo "lossy link, $CODEC: $SENT samples sent, ${DECODED:-?} decoded, ${LOST:-?} lost," \
+         "${DROPPED:-?} bytes dropped ($(( ${LOST:-0} / ${DROPPED:-1} )) samples lost per byte)"
+    if [ $(( ${DECODED:-0} + ${LOST:-0} )) -ne "$SENT" ]; then
+        echo "lossy link, $CODEC: decoded and lost samples do not add up to the samples sent" >&2
+        FAILED=$((FAILED + 1))
+    fi
+    if ! awk 'NR == FNR { sent[++n] = $0; next }
+              { while (++i <= n && sent[i] != $0); if (i > n) { exit 1 } }' \
+             "$BUILD/link.csv" "$BUILD/decoded"; then
+        echo "lossy link, $CODEC: a value decoded is not the value sent" >&2
+        FAILED=$((FAILED + 1))
+    fi
+done
+
+if [ "$FAILED" -gt 0 ]; then
+    echo "$FAILED checks failed" >&2
+    exit 1
+fi
@@ -0,0 +1,230 @@
+/**
+ * \file ConfigBusCheck.c
+ * \brief Check of the bytes the configuration writes put on the I2C bus.
+ *
+ * Compiles LIS3DH_Config.c and I2C_Interface.c of PROJ_2 (or PROJ_3) on the
+ * PC with the simulator of Host_Tools/Sim, which passes every byte clocked
+ * on the bus to a monitor (address bytes included), and checks each write
+ * byte for byte:
+ *   - I2C_Peripheral_WriteRegisterMulti() of 1 to 7 registers: the device
+ *     address, the register address with the auto-increment bit and exactly
+ *     register_count data bytes; no transaction for 0 registers;
+ *   - LIS3DH_Config_Apply() after LIS3DH_Config_Load(): the whole
+ *     configuration of main.c (one burst per run of adjacent registers,
+ *     over up to two unchanged ones), the same table again (no byte), a
+ *     delta of two registers two apart (one burst) and three apart (two
+ *     bursts), and a table with a register outside the configuration (no
+ *     byte, ERROR);
+ *   - the configuration read back from the LIS3DH model.
+ * The byte count of the bus counters of the firmware (see
+ * I2C_Peripheral_GetBusCounters()) is checked against the bytes seen on
+ * the bus too. The program prints one line per check and exits with 1 if
+ * one fails.
+ *
+ * Build: gcc -std=c99 -O2 -DHOST_BUILD -ISim -I../AY1920_II_HW_05_PROJ_2.cydsn -o ConfigBusCheck
+ *            ConfigBusCheck.c Sim/Sim.c Sim/LIS3DH_Model.c
+ *            ../AY1920_II_HW_05_PROJ_2.cydsn/LIS3DH_Config.c ../AY1920_II_HW_05_PROJ_2.cydsn/I2C_Interface.c -lm
+ * Usage: ConfigBusCheck
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "I2C_Interface.h"
+#include "LIS3DH_Config.h"
+#include "Sim.h"
+#include "macro_definition.h"
+
+#define BUS_MAX_BYTES 64
+#define ADDRESS_WRITE (LIS3DH_DEVICE_ADDRESS << 1)
+#define AUTO_INCREMENT 0x80
+
+static uint8_t bus[BUS_MAX_BYTES];     // Bytes of the current check
+static int bus_count;
+static int bus_starts;                 // Address bytes among them
+static int failures = 0;
+
+static void ConfigBusCheck_Monitor(uint8_t data, int start)
+{
+    if (bus_count < BUS_MAX_BYTES)
+    {
+        bus[bus_count] = data;
+    }
+    bus_count++;
+    bus_starts += start;
+}
+
+// Start of a check: no byte seen, bus counters of the firmware cleared
+static void ConfigBusCheck_Begin(void)
+{
+    bus_count = 0;
+    bus_starts = 0;
+    I2C_Peripheral_ResetBusCounters();
+}
+
+// End of a check: the bytes seen on the bus against the ones expected
+static void ConfigBusCheck_End(const char* name, ErrorCode error, ErrorCode expected_error,
+                               const uint8_t* expected, int expected_count, int expected_starts)
+{
+    I2C_Peripheral_BusCounters counters;
+    int pass;
+
+    I2C_Peripheral_GetBusCounters(&counters);
+    pass = (error == expected_error && bus_count == expected_count && bus_starts == expected_starts &&
+            counters.bytes == (uint32_t)expected_count &&
+            (expected_count == 0 || !memcmp(bus, expected, expected_count)));
+    printf("%-44s %2d bytes, %d transactions (firmware counters %2lu bytes) %s\n", name, bus_count,
+           bus_starts, (unsigned long)counters.bytes, pass ? "ok" : "FAILED");
+    if (!pass)
+    {
+        printf("    bus:     ");
+        for (int i = 0; i < bus_count && i < BUS_MAX_BYTES; i++)
+        {
+            printf(" %02X", bus[i]);
+        }
+        printf("\n    expected:");
+        for (int i = 0; i < expected_count; i++)
+        {
+            printf(" %02X", expected[i]);
+        }
+        printf("\n");
+        failures++;
+    }
+}
+
+// The checks, run as the firmware on the virtual clock
+static int ConfigBusCheck_Run(void)
+{
+    uint8_t data[7] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77};
+    uint8_t expected[BUS_MAX_BYTES];
+    ErrorCode error;
+    char name[64];
+
+    I2C_Peripheral_Start();
+
+    // WriteRegisterMulti: register_count data bytes, not one more
+    for (uint8_t count = 1; count <= 7; count++)
+    {
+        expected[0] = ADDRESS_WRITE;
+        expected[1] = LIS3DH_TEMP_CFG_REG | AUTO_INCREMENT;
+        memcpy(&expected[2], data, count);
+        ConfigBusCheck_Begin();
+        error = I2C_Peripheral_WriteRegisterMulti(LIS3DH_DEVICE_ADDRESS, LIS3DH_TEMP_CFG_REG, count, data);
+        snprintf(name, sizeof(name), "WriteRegisterMulti, %d registers:", count);
+        ConfigBusCheck_End(name, error, NO_ERROR, expected, 2 + count, 1);
+    }
+    ConfigBusCheck_Begin();
+    error = I2C_Peripheral_WriteRegisterMulti(LIS3DH_DEVICE_ADDRESS, LIS3DH_TEMP_CFG_REG, 0, data);
+    ConfigBusCheck_End("WriteRegisterMulti, 0 registers:", error, ERROR, NULL, 0, 0);
+
+    // Shadow of the block TEMP_CFG_REG..CTRL_REG6: 0x11 .. 0x77 written above
+    ConfigBusCheck_Begin();
+    error = LIS3DH_Config_Load();
+    uint8_t load[] = {ADDRESS_WRITE, LIS3DH_CONFIG_FIRST_REG | AUTO_INCREMENT, ADDRESS_WRITE | 1,
+                      0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77};
+    ConfigBusCheck_End("Config_Load:", error, NO_ERROR, load, sizeof(load), 2);
+
+    // Whole configuration, as main.c: TEMP_CFG_REG, CTRL_REG2..4 and CTRL_REG6 change, CTRL_REG1 and
+    // CTRL_REG5 are rewritten with their value within the burst, FIFO_CTRL_REG and INT1_CFG are unknown
+    const LIS3DH_Config_Entry configuration[] = {
+        {LIS3DH_TEMP_CFG_REG,  0x00},
+        {LIS3DH_CTRL_REG1,     0x22},
+        {LIS3DH_CTRL_REG2,     0x00},
+        {LIS3DH_CTRL_REG3,     0x10},
+        {LIS3DH_CTRL_REG4,     0x88},
+        {LIS3DH_CTRL_REG5,     0x66},
+        {LIS3DH_CTRL_REG6,     0x00},
+        {LIS3DH_FIFO_CTRL_REG, 0x80},
+        {LIS3DH_INT1_CFG,      0x00},
+    };
+    const uint8_t apply[] = {
+        ADDRESS_WRITE, LIS3DH_TEMP_CFG_REG | AUTO_INCREMENT, 0x00, 0x22, 0x00, 0x10, 0x88, 0x66, 0x00,
+        ADDRESS_WRITE, LIS3DH_FIFO_CTRL_REG | AUTO_INCREMENT, 0x80,
+        ADDRESS_WRITE, LIS3DH_INT1_CFG | AUTO_INCREMENT, 0x00,
+    };
+    ConfigBusCheck_Begin();
+    error = LIS3DH_Config_Apply(configuration, sizeof(configuration) / sizeof(configuration[0]));
+    ConfigBusCheck_End("Config_Apply, whole configuration:", error, NO_ERROR, apply, sizeof(apply), 3);
+
+    ConfigBusCheck_Begin();
+    error = LIS3DH_Config_Apply(configuration, sizeof(configuration) / sizeof(configuration[0]));
+    ConfigBusCheck_End("Config_Apply, same configuration:", error, NO_ERROR, NULL, 0, 0);
+
+    // CTRL_REG1 and CTRL_REG4: two unchanged registers in between, one burst
+    const LIS3DH_Config_Entry odr_scale[] = {
+        {LIS3DH_CTRL_REG4, 0x98},
+        {LIS3DH_CTRL_REG1, 0x97},
+    };
+    const uint8_t apply_odr_scale[] = {
+        ADDRESS_WRITE, LIS3DH_CTRL_REG1 | AUTO_INCREMENT, 0x97, 0x00, 0x10, 0x98,
+    };
+    ConfigBusCheck_Begin();
+    error = LIS3DH_Config_Apply(odr_scale, sizeof(odr_scale) / sizeof(odr_scale[0]));
+    ConfigBusCheck_End("Config_Apply, CTRL_REG1 and CTRL_REG4:", error, NO_ERROR,
+                       apply_odr_scale, sizeof(apply_odr_scale), 1);
+
+    // TEMP_CFG_REG and CTRL_REG4: three unchanged registers in between, two bursts
+    const LIS3DH_Config_Entry temperature_scale[] = {
+        {LIS3DH_TEMP_CFG_REG, 0xC0},
+        {LIS3DH_CTRL_REG4,    0x88},
+    };
+    const uint8_t apply_temperature_scale[] = {
+        ADDRESS_WRITE, LIS3DH_TEMP_CFG_REG | AUTO_INCREMENT, 0xC0,
+        ADDRESS_WRITE, LIS3DH_CTRL_REG4 | AUTO_INCREMENT, 0x88,
+    };
+    ConfigBusCheck_Begin();
+    error = LIS3DH_Config_Apply(temperature_scale, sizeof(temperature_scale) / sizeof(temperature_scale[0]));
+    ConfigBusCheck_End("Config_Apply, TEMP_CFG_REG and CTRL_REG4:", error, NO_ERROR,
+                       apply_temperature_scale, sizeof(apply_temperature_scale), 2);
+
+    // Status register: not a configuration register, nothing written
+    const LIS3DH_Config_Entry status[] = {
+        {LIS3DH_CTRL_REG2,  0x01},
+        {LIS3DH_STATUS_REG, 0x00},
+    };
+    ConfigBusCheck_Begin();
+    error = LIS3DH_Config_Apply(status, sizeof(status) / sizeof(status[0]));
+    ConfigBusCheck_End("Config_Apply, Status register:", error, ERROR, NULL, 0, 0);
+
+    // The registers of the model
+    uint8_t block[LIS3DH_CONFIG_REG_COUNT];
+    const uint8_t block_expected[LIS3DH_CONFIG_REG_COUNT] = {0xC0, 0x97, 0x00, 0x10, 0x88, 0x66, 0x00};
+    uint8_t fifo_ctrl = 0xFF;
+    uint8_t int1_cfg = 0xFF;
+
+    error = LIS3DH_Config_Verify(block);
+    if (error == NO_ERROR)
+    {
+        error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_FIFO_CTRL_REG, &fifo_ctrl);
+    }
+    if (error == NO_ERROR)
+    {
+        error = I2C_Peripheral_ReadRegister(LIS3DH_DEVICE_ADDRESS, LIS3DH_INT1_CFG, &int1_cfg);
+    }
+    int pass = (error == NO_ERROR && !memcmp(block, block_expected, sizeof(block)) &&
+                fifo_ctrl == 0x80 && int1_cfg == 0x00);
+    printf("%-44s %s\n", "Registers of the model:", pass ? "ok" : "FAILED");
+    failures += !pass;
+    return 0;
+}
+
+int main(void)
+{
+    Sim_Config config = {
+        .seconds = 1,
+        .i2c_hz = 400000,
+        .baud = 115200,
+        .timer_hz = 1000000,
+        .seed = 1,
+        .i2c_monitor = ConfigBusCheck_Monitor,
+    };
+
+    // The checks return before the end of the virtual time
+    if (!Sim_Run(&config, ConfigBusCheck_Run))
+    {
+        fprintf(stderr, "The checks did not end within the virtual time\n");
+        return 1;
+    }
+    return failures ? 1 : 0;
+}
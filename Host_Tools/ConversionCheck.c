@@ -0,0 +1,190 @@
+/**
+ * \file ConversionCheck.c
+ * \brief Check of the conversion kernel and of the registers of one acquisition profile.
+ *
+ * Compiles Conversion.h and LIS3DH_Profile.h of the firmware on the PC
+ * (HOST_BUILD) with the profile set at build time (ConversionCheck.sh
+ * builds and runs every power mode and full scale of PROJ_2 and PROJ_3),
+ * and checks what they derive from it against the datasheet of the LIS3DH,
+ * kept here as plain tables:
+ *   - resolution, shift of the output registers and sensitivity (mg/digit)
+ *     of the power mode and full scale;
+ *   - output data rate of ACC_ODR in the power mode;
+ *   - CTRL_REG1 (ODR, LPen, ACC_AXES) and CTRL_REG4 (BDU, FS, HR);
+ *   - Conversion_Sample() for all the 65536 values of the output registers
+ *     against the digits times the sensitivity: exact in mg (UNIT_MG), within
+ *     one unit of the last place plus the rounding of the factor in Q16.16
+ *     m/s2 (UNIT_MS2_Q16), where the largest difference of the float sent
+ *     with OUTPUT_FORMAT_FLOAT from the float conversion of the samples it
+ *     replaced is printed too.
+ * Last, the cycles per axis of Conversion_Sample() on the Cortex-M3 are
+ * estimated from its instructions and the cycle counts of the Cortex-M3
+ * Technical Reference Manual (long multiply 3 to 5 cycles, load 2, the
+ * second of two loads 1): the 'convert' stage of the profiler (see
+ * USE_PROFILER) measures the whole conversion on the PSoC. The program
+ * exits with 1 if a check fails.
+ *
+ * Build: gcc -std=c99 -O2 -DHOST_BUILD -ISim -I../AY1920_II_HW_05_PROJ_2.cydsn
+ *            -o ConversionCheck ConversionCheck.c -lm
+ *        (e.g. with -DACC_POWER_MODE=0 -DACC_FULL_SCALE=3 for low power, ±16 g)
+ * Usage: ConversionCheck
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include "Conversion.h"
+#include "LIS3DH_Profile.h"
+#include "macro_definition.h"
+#include "project.h"
+
+static const char* const mode_names[3] = {"low power", "normal", "high resolution"};
+static const int full_scales[4] = {2, 4, 8, 16};
+
+// Datasheet: resolution of each power mode, sensitivity (mg/digit) of each power mode and full scale
+static const int datasheet_bits[3] = {8, 10, 12};
+static const int datasheet_mg[3][4] = {
+    {16, 32, 64, 192},
+    {4, 8, 16, 48},
+    {1, 2, 4, 12}
+};
+
+// Datasheet: output data rates (Hz) of the ODR codes 1 to 9, normal and high resolution, low power
+static const int datasheet_odr[2][9] = {
+    {1, 10, 25, 50, 100, 200, 400, 0, 1344},
+    {1, 10, 25, 50, 100, 200, 400, 1600, 5376}
+};
+
+static int failures = 0;
+
+// One check: printed only if it fails
+static void ConversionCheck_Expect(int condition, const char* what, long value, long expected)
+{
+    if (!condition)
+    {
+        printf("check:     %s is %ld (0x%lX), the datasheet gives %ld (0x%lX)\n",
+               what, value, (unsigned long)value, expected, (unsigned long)expected);
+        failures++;
+    }
+}
+
+// Cycles of Conversion_Sample() per axis on the Cortex-M3, with long multiplies of 'multiply' cycles
+static int ConversionCheck_Cycles(int multiply)
+{
+    // Right-justify: 2 LDRB (2 + 1), ORR, SXTH, ASR = 6
+    int cycles = 6;
+
+#if (ACC_OUTPUT_UNIT == UNIT_MG)
+    // MUL by the sensitivity, or LSL if it is a power of 2
+    (void)multiply;
+    cycles += 1;
+#else
+    // Factor (MOVW, MOVT), SMULL, 64-bit shift (LSR, ORR with LSL) = 2 + multiply + 2
+    cycles += 2 + multiply + 2;
+#endif
+    return cycles;
+}
+
+int main(void)
+{
+    int mode = ACC_POWER_MODE;
+    int fs = ACC_FULL_SCALE;
+    int bits = datasheet_bits[mode];
+    int mg = datasheet_mg[mode][fs];
+    int odr = datasheet_odr[mode == LIS3DH_MODE_LOW_POWER][ACC_ODR - 1];
+    double error_max = 0.0;
+#if (ACC_OUTPUT_UNIT != UNIT_MG)
+    double float_max = 0.0;
+#endif
+
+    printf("profile:   %s, ±%d g, %d Hz, %s: CTRL_REG1 0x%02X, CTRL_REG4 0x%02X\n",
+           mode_names[mode], full_scales[fs], odr, (ACC_OUTPUT_UNIT == UNIT_MG) ? "mg" : "m/s2 Q16.16",
+           LIS3DH_PROFILE_CTRL_REG1, LIS3DH_PROFILE_CTRL_REG4);
+
+    ConversionCheck_Expect(LIS3DH_PROFILE_RESOLUTION_BITS == bits, "resolution",
+                           LIS3DH_PROFILE_RESOLUTION_BITS, bits);
+    ConversionCheck_Expect(LIS3DH_PROFILE_SHIFT == 16 - bits, "shift", LIS3DH_PROFILE_SHIFT, 16 - bits);
+    ConversionCheck_Expect(LIS3DH_PROFILE_SENSITIVITY_MG == mg, "sensitivity", LIS3DH_PROFILE_SENSITIVITY_MG, mg);
+    ConversionCheck_Expect(LIS3DH_PROFILE_ODR_HZ == odr, "output data rate", LIS3DH_PROFILE_ODR_HZ, odr);
+    ConversionCheck_Expect(LIS3DH_PROFILE_HIGH_BYTES == (bits == 8), "high bytes only",
+                           LIS3DH_PROFILE_HIGH_BYTES, bits == 8);
+
+    // CTRL_REG1: ODR3-ODR0 (bits 7-4), LPen (bit 3), Zen, Yen, Xen (bits 2-0)
+    ConversionCheck_Expect((LIS3DH_PROFILE_CTRL_REG1 >> 4) == ACC_ODR, "CTRL_REG1 ODR",
+                           LIS3DH_PROFILE_CTRL_REG1 >> 4, ACC_ODR);
+    ConversionCheck_Expect(((LIS3DH_PROFILE_CTRL_REG1 >> 3) & 1) == (mode == LIS3DH_MODE_LOW_POWER),
+                           "CTRL_REG1 LPen", (LIS3DH_PROFILE_CTRL_REG1 >> 3) & 1, mode == LIS3DH_MODE_LOW_POWER);
+    ConversionCheck_Expect((LIS3DH_PROFILE_CTRL_REG1 & 0x07) == ACC_AXES, "CTRL_REG1 axes",
+                           LIS3DH_PROFILE_CTRL_REG1 & 0x07, ACC_AXES);
+
+    // CTRL_REG4: BDU (bit 7), FS1-FS0 (bits 5-4), HR (bit 3); BDU is left off with 8-bit data read on INT1
+    ConversionCheck_Expect(((LIS3DH_PROFILE_CTRL_REG4 >> 7) & 1) == !(bits == 8 && USE_INT1), "CTRL_REG4 BDU",
+                           (LIS3DH_PROFILE_CTRL_REG4 >> 7) & 1, !(bits == 8 && USE_INT1));
+    ConversionCheck_Expect(((LIS3DH_PROFILE_CTRL_REG4 >> 4) & 3) == fs, "CTRL_REG4 FS",
+                           (LIS3DH_PROFILE_CTRL_REG4 >> 4) & 3, fs);
+    ConversionCheck_Expect(((LIS3DH_PROFILE_CTRL_REG4 >> 3) & 1) == (mode == LIS3DH_MODE_HIGH_RESOLUTION),
+                           "CTRL_REG4 HR", (LIS3DH_PROFILE_CTRL_REG4 >> 3) & 1, mode == LIS3DH_MODE_HIGH_RESOLUTION);
+    ConversionCheck_Expect((LIS3DH_PROFILE_CTRL_REG4 & 0x47) == 0, "CTRL_REG4 other bits",
+                           LIS3DH_PROFILE_CTRL_REG4 & 0x47, 0);
+
+    // Every value of the output registers: left-justified digits, the low bits are not meaningful
+    for (long value = 0; value < 65536; value++)
+    {
+        uint8_t data[2] = {(uint8_t)(value & 0xFF), (uint8_t)(value >> 8)};
+        long digits = (long)floor((int16_t)value / (double)(1 << (16 - bits)));
+        int32_t converted = Conversion_Sample(data);
+        double error;
+
+        if (Conversion_Raw(data) != digits)
+        {
+            printf("check:     registers 0x%04lX: %d digits, %ld expected\n",
+                   (unsigned long)value, Conversion_Raw(data), digits);
+            failures++;
+            break;
+        }
+#if (ACC_OUTPUT_UNIT == UNIT_MG)
+        error = fabs((double)converted - (double)digits * mg);
+#else
+        error = fabs(converted / 65536.0 - digits * mg * CONVERSION_GRAVITY / 1000.0) * 65536.0;
+        
+        // The float sent with OUTPUT_FORMAT_FLOAT against the float conversion it replaced
+        double difference = fabs((float)(converted / 65536.0) - (float)(digits * CONVERSION_GRAVITY * mg / 1000.0));
+        
+        if (difference > float_max)
+        {
+            float_max = difference;
+        }
+#endif
+        if (error > error_max)
+        {
+            error_max = error;
+        }
+    }
+
+    // Q16.16: the product is truncated (1 unit), the factor is rounded to 2^-28 over up to 2^11 digits
+#if (ACC_OUTPUT_UNIT == UNIT_MG)
+    double error_bound = 0.0;
+#else
+    double error_bound = 1.0 + 0.5 * (1 << (bits - 1)) / (1 << (CONVERSION_FACTOR_BITS - 16));
+#endif
+    printf("kernel:    65536 register values, error max %.4f units of the last place (bound %.4f)\n",
+           error_max, error_bound);
+    if (error_max > error_bound)
+    {
+        failures++;
+    }
+#if (ACC_OUTPUT_UNIT != UNIT_MG)
+    printf("float:     difference max %.2e m/s2 from the float conversion (digits * 9.81 * mg/digit in float32)\n",
+           float_max);
+#endif
+
+    int best = ConversionCheck_Cycles(3);
+    int worst = ConversionCheck_Cycles(5);
+    int axes = ((ACC_AXES >> 0) & 1) + ((ACC_AXES >> 1) & 1) + ((ACC_AXES >> 2) & 1);
+
+    printf("M3:        %d to %d cycles per axis, %d to %d per sample (%d axes), %.3f to %.3f %% of the CPU"
+           " at %d Hz\n", best, worst, best * axes, worst * axes, axes,
+           100.0 * best * axes * odr / BCLK__BUS_CLK__HZ, 100.0 * worst * axes * odr / BCLK__BUS_CLK__HZ, odr);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,60 @@
+#!/bin/sh
+#
+# \file ConversionCheck.sh
+# \brief Check of the conversion kernels of every acquisition profile (see ConversionCheck.c).
+#
+# Builds ConversionCheck.c with the headers of PROJ_2 (mg kernel) and of
+# PROJ_3 (Q16.16 m/s2 kernel) for every power mode and full scale of the
+# LIS3DH, and runs each build: the registers, the sensitivity and the
+# kernel of each profile are checked against the datasheet, and the cycles
+# of each kernel on the Cortex-M3 are printed, with the difference of the
+# Q16.16 kernel from the float conversion it replaced.
+# The script exits 1 if a build or a check fails.
+#
+# Usage: ConversionCheck.sh [-D...]
+#        -D    switch of macro_definition.h, for all the builds (e.g. -DACC_ODR=9)
+#
+# \Author Marco Sinatra
+#
+
+TOOLS=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(dirname "$TOOLS")
+DEFINES=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -D*) DEFINES="$DEFINES $1"; shift ;;
+        *) echo "usage: ConversionCheck.sh [-D...]" >&2; exit 1 ;;
+    esac
+done
+
+BUILD=$(mktemp -d) || exit 1
+trap 'rm -rf "$BUILD"' EXIT
+
+FAILED=0
+for PROJECT in 2 3; do
+    SOURCES="$ROOT/AY1920_II_HW_05_PROJ_$PROJECT.cydsn"
+    # Power modes as LIS3DH_MODE_*, full scales as LIS3DH_FS_*
+    for MODE in 0 1 2; do
+        for FS in 0 1 2 3; do
+            PROFILE="-DACC_POWER_MODE=$MODE -DACC_FULL_SCALE=$FS"
+            PROGRAM="$BUILD/ConversionCheck_${PROJECT}_${MODE}_${FS}"
+            echo "PROJ_$PROJECT $PROFILE"
+            if ! gcc -std=c99 -O2 -DHOST_BUILD $PROFILE $DEFINES -I"$TOOLS/Sim" -I"$SOURCES" \
+                     -o "$PROGRAM" "$TOOLS/ConversionCheck.c" -lm; then
+                echo "PROJ_$PROJECT $PROFILE: build failed" >&2
+                FAILED=$((FAILED + 1))
+                continue
+            fi
+            if ! "$PROGRAM"; then
+                echo "PROJ_$PROJECT $PROFILE: check failed" >&2
+                FAILED=$((FAILED + 1))
+            fi
+        done
+    done
+done
+
+if [ "$FAILED" -gt 0 ]; then
+    echo "$FAILED profiles failed" >&2
+    exit 1
+fi
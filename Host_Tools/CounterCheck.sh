@@ -0,0 +1,147 @@
+#!/bin/sh
+#
+# \file CounterCheck.sh
+# \brief Check of the loss and error counters of the firmware against the faults injected (see AcquisitionSim.c).
+#
+# Builds AcquisitionSim.c with the firmware of PROJ_2 and PROJ_3 and runs
+# one case per counter, each with the fault which has to move it, and a
+# clean run which has to leave them all at 0. The counters of the firmware
+# are checked against the ground truth of the simulator:
+#   - I2C errors (I2C_Peripheral_GetBusCounters()): one per address byte
+#     not acknowledged (-e), but the ones of the probes at boot, which are
+#     not errors (WHO AM I polls, bus scan);
+#   - overruns (LIS3DH_GetOverruns()), reading the Status register and in
+#     the FIFO mode: at least one when the sensor loses samples under CPU
+#     stalls (-s), at most one per sample lost or refused (read, not sent);
+#   - frames dropped by the transmit ring (TxQueue_GetStats(), tx_dropped
+#     of the telemetry): the link cannot carry 400 Hz at 9600 bit/s, and
+#     every sample read is either queued or dropped; with 8 samples per
+#     frame, one drop per frame given up (the frames in progress at the
+#     end aside), also with the telemetry packets waiting for room;
+#   - late ticks of the poll timer (LIS3DH_Schedule_GetStats()): at least
+#     one under CPU stalls.
+# Every run has to pass AcquisitionSim too. The script exits 1 if a build
+# or a check fails.
+#
+# Usage: CounterCheck.sh [-D...]
+#        -D    switch of macro_definition.h, for all the builds
+#
+# \Author Marco Sinatra
+#
+
+TOOLS=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(dirname "$TOOLS")
+DEFINES=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -D*) DEFINES="$DEFINES $1"; shift ;;
+        *) echo "usage: CounterCheck.sh [-D...]" >&2; exit 1 ;;
+    esac
+done
+
+BUILD=$(mktemp -d) || exit 1
+trap 'rm -rf "$BUILD"' EXIT
+
+FAILED=0
+
+# Field of the output of the last run: sed expression with one group
+field() {
+    sed -n "s/$1/\1/p" "$BUILD/run"
+}
+
+# Build and run one case: name, switches, options of AcquisitionSim
+run() {
+    NAME="PROJ_$PROJECT $1"
+    PROGRAM="$BUILD/AcquisitionSim"
+    if ! gcc -std=c99 -O2 -DHOST_BUILD -Dmain=Firmware_Main $2 $DEFINES -I"$TOOLS/Sim" -I"$SOURCES" \
+             -o "$PROGRAM" "$TOOLS/AcquisitionSim.c" "$TOOLS/Sim/Sim.c" "$TOOLS/Sim/LIS3DH_Model.c" \
+             "$TOOLS/Sim/FrameTrace.c" "$SOURCES"/[A-Z]*.c "$SOURCES/main.c" -lm; then
+        echo "$NAME: build failed" >&2
+        FAILED=$((FAILED + 1))
+        return 1
+    fi
+    "$PROGRAM" -t 3 -b 115200 $3 > "$BUILD/run"
+    STATUS=$?
+    READ=$(field '^sensor: .* \([0-9]*\) read (.*')
+    LOST=$(field '^sensor: .*), \([0-9]*\) lost .*')
+    OVERRUNS=$(field '^firmware: \([0-9]*\) overruns.*')
+    ERRORS=$(field '^firmware: .*, \([0-9]*\) I2C errors.*')
+    QUEUED=$(field '^firmware: .* frames \([0-9]*\) queued.*')
+    DROPPED=$(field '^firmware: .*, \([0-9]*\) dropped.*')
+    POLLS=$(field '^boot: .*(\([0-9]*\) WHO AM I polls.*')
+    PROBES=$(field '^boot: .*, \([0-9]*\) addresses probed.*')
+    LATE=$(field '^schedule: .*, \([0-9]*\) late ticks.*')
+    NACKS=$(field '^faults: *\([0-9]*\) NACKs.*')
+    REFUSED=$((${READ:-0} - ${QUEUED:-0} - ${DROPPED:-0}))
+    echo "$NAME: ${READ:-?} read, ${LOST:-?} lost, ${OVERRUNS:-?} overruns, ${ERRORS:-?} I2C errors" \
+         "(${NACKS:-?} NACKs), ${QUEUED:-?} queued, ${DROPPED:-?} dropped${LATE:+, $LATE late ticks}"
+    if [ "$STATUS" -ne 0 ]; then
+        echo "$NAME: AcquisitionSim failed" >&2
+        FAILED=$((FAILED + 1))
+    fi
+    return 0
+}
+
+# One check of the last run: shell condition, what it checks
+expect() {
+    if ! eval "$1" 2>/dev/null; then
+        cat "$BUILD/run"
+        echo "$NAME: $2 ($1)" >&2
+        FAILED=$((FAILED + 1))
+    fi
+}
+
+for PROJECT in 2 3; do
+    SOURCES="$ROOT/AY1920_II_HW_05_PROJ_$PROJECT.cydsn"
+
+    if run "clean run" "" ""; then
+        expect '[ "$LOST" -eq 0 ] && [ "$OVERRUNS" -eq 0 ] && [ "$ERRORS" -eq 0 ] && [ "$DROPPED" -eq 0 ]' \
+               "a counter moved without faults"
+    fi
+
+    if run "I2C errors" "" "-e 0.01"; then
+        expect '[ "$ERRORS" -gt 0 ] && [ "$ERRORS" -le "$NACKS" ] && \
+                [ "$ERRORS" -ge $((NACKS - POLLS - PROBES)) ]' \
+               "I2C errors do not match the NACKs"
+    fi
+
+    if run "overruns, Status register" "" "-s 20 -d 20000"; then
+        expect '[ "$LOST" -gt 0 ] && [ "$OVERRUNS" -gt 0 ] && [ "$OVERRUNS" -le $((LOST + REFUSED)) ]' \
+               "overruns do not match the samples lost"
+    fi
+
+    if run "overruns, FIFO" "-DACQUISITION_MODE=ACQ_MODE_FIFO" "-t 10 -s 0.5 -d 400000"; then
+        expect '[ "$LOST" -gt 0 ] && [ "$OVERRUNS" -gt 0 ] && [ "$OVERRUNS" -le $((LOST + REFUSED)) ]' \
+               "overruns do not match the samples lost"
+    fi
+
+    if run "frames dropped" "-DACC_ODR=7" "-b 9600"; then
+        expect '[ "$DROPPED" -gt 0 ] && [ $((QUEUED + DROPPED)) -eq "$READ" ]' \
+               "frames dropped do not match the samples read"
+    fi
+
+    if run "frames dropped, 8 samples per frame" "-DACC_ODR=7 -DFRAME_SAMPLES=8" "-b 9600"; then
+        expect '[ "$DROPPED" -gt 0 ] && [ $(((QUEUED + DROPPED) * 8)) -le $((READ + 7)) ] && \
+                [ $(((QUEUED + DROPPED) * 8)) -gt $((READ - 16)) ]' \
+               "frames dropped do not match the frames of the samples read"
+    fi
+
+    if run "frames dropped, telemetry" \
+           "-DACC_ODR=7 -DFRAME_SAMPLES=8 -DFRAME_FORMAT=FRAME_FORMAT_COBS -DUSE_TELEMETRY=1" "-b 9600"; then
+        # The telemetry packets are queued too: only the data frames are bounded from above
+        expect '[ "$DROPPED" -gt 0 ] && [ $((DROPPED * 8)) -le $((READ + 7)) ] && \
+                [ $(((QUEUED + DROPPED) * 8)) -gt $((READ - 16)) ]' \
+               "frames dropped do not match the frames of the samples read"
+    fi
+
+    if run "late ticks" "-DUSE_POLL_TIMER=1" "-s 20 -d 20000"; then
+        expect '[ "$LATE" -gt 0 ] && [ "$OVERRUNS" -gt 0 ] && [ "$OVERRUNS" -le $((LOST + REFUSED)) ]' \
+               "late ticks or overruns do not match the stalls"
+    fi
+done
+
+if [ "$FAILED" -gt 0 ]; then
+    echo "$FAILED checks failed" >&2
+    exit 1
+fi
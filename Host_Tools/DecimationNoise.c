@@ -0,0 +1,267 @@
+/**
+ * \file DecimationNoise.c
+ * \brief Noise of the samples sent, with or without the decimator (DECIMATION_RATIO).
+ *
+ * Compiles all the sources of PROJ_2 (or PROJ_3), main.c included, with the
+ * simulator of Host_Tools/Sim, as AcquisitionSim does, the profile and the
+ * decimator set at build time. The LIS3DH model sends 1 g on Z with white
+ * noise of the given density: the frames leaving the UART (0xA0 header,
+ * 0xC0 tail, one sample each) are decoded and the program prints
+ *   - the rate of the samples (the one of the sensor over DECIMATION_RATIO)
+ *     and the samples sent per second (more with back-to-back polling,
+ *     which sends some samples twice, less if the link drops frames);
+ *   - mean and standard deviation of Z (the noise, after the rounding to
+ *     the resolution of the profile), and the noise density of the output
+ *     (standard deviation over the square root of half the rate), against
+ *     the density of the sensor;
+ *   - the cycles per sample sent of Decimator_Process() on the Cortex-M3,
+ *     estimated from the instructions of its loops and the cycle counts of
+ *     the Cortex-M3 Technical Reference Manual (long multiply 3 to 5
+ *     cycles, load 2, taken branch 3): the 'decimate' stage of the profiler
+ *     (see USE_PROFILER) measures them on the PSoC.
+ * The noise of the model is limited to ODR/2, as by the filter of the
+ * sensor (then the average of DECIMATION_RATIO samples has the noise of a
+ * single sample at the output rate, plus less rounding), or to the band
+ * given with -w, aliased into the samples at the lower rates (then the
+ * average gains the square root of DECIMATION_RATIO).
+ * The first 16 samples sent are left out (start of the decimator).
+ *
+ * Build: gcc -std=c99 -O2 -DHOST_BUILD -Dmain=Firmware_Main -ISim
+ *            -I../AY1920_II_HW_05_PROJ_2.cydsn -o DecimationNoise DecimationNoise.c
+ *            Sim/Sim.c Sim/LIS3DH_Model.c ../AY1920_II_HW_05_PROJ_2.cydsn/[A-Z]*.c
+ *            ../AY1920_II_HW_05_PROJ_2.cydsn/main.c -lm
+ *        e.g. with -DACC_ODR=9 -DACQUISITION_MODE=1 -DDECIMATION_RATIO=13 for 1.344 kHz to 103 Hz
+ * Usage: DecimationNoise [-p 2|3] [-t seconds] [-n noise] [-w hz] [-i i2c_hz] [-b baud]
+ *        -p 2  PROJ_2 frames: int16 values in mg (default)
+ *        -p 3  PROJ_3 frames: float values in m/s2
+ *        -t    virtual time (default 60 s)
+ *        -n    noise density of the sensor, in ug/sqrt(Hz) (default 220)
+ *        -w    bandwidth of the noise (default 0: ODR/2)
+ *        -i    I2C clock (default 400000)
+ *        -b    UART bit rate (default 921600, so that the link drops no frame)
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Sim.h"
+#include "Decimator.h"
+#include "macro_definition.h"
+#include "project.h"
+
+#undef main
+
+#define FRAME_HEADER 0xA0
+#define FRAME_TAIL 0xC0
+#define FRAME_MAX_SIZE 14
+#define GRAVITY 9.81            // m/s2 per g, as CONVERSION_GRAVITY of PROJ_3
+#define SKIPPED_SAMPLES 16
+
+int Firmware_Main(void);
+
+static int float_values;        // PROJ_3 frames
+static uint8_t frame[FRAME_MAX_SIZE];
+static int frame_level;
+
+static struct {
+    uint64_t samples;
+    uint64_t first_cycle;       // Stop bit of the first sample counted
+    uint64_t last_cycle;        // And of the last one
+    double mean;                // Of Z, in mg (Welford)
+    double m2;
+} noise;
+
+// A whole frame: Z into the statistics
+static void DecimationNoise_Frame(uint64_t cycle)
+{
+    static uint64_t frames = 0;
+    double z;
+
+    if (++frames <= SKIPPED_SAMPLES)
+    {
+        return;
+    }
+    if (float_values)
+    {
+        float ms2;
+
+        memcpy(&ms2, &frame[9], sizeof(ms2));
+        z = ms2 * 1000.0 / GRAVITY;
+    }
+    else
+    {
+        z = (int16_t)(frame[5] | (frame[6] << 8));
+    }
+    if (noise.samples == 0)
+    {
+        noise.first_cycle = cycle;
+    }
+    noise.last_cycle = cycle;
+    noise.samples++;
+
+    double delta = z - noise.mean;
+
+    noise.mean += delta / noise.samples;
+    noise.m2 += delta * (z - noise.mean);
+}
+
+// Byte on the UART: frames resynchronised on the header and the tail
+static void DecimationNoise_Monitor(uint8_t data, uint64_t cycle)
+{
+    int size = float_values ? 14 : 8;
+
+    if (frame_level == 0 && data != FRAME_HEADER)
+    {
+        return;
+    }
+    frame[frame_level++] = data;
+    if (frame_level < size)
+    {
+        return;
+    }
+    if (frame[size - 1] == FRAME_TAIL)
+    {
+        DecimationNoise_Frame(cycle);
+        frame_level = 0;
+        return;
+    }
+    // Not a frame: look for the next header within the bytes received
+    int start = 1;
+
+    while (start < size && frame[start] != FRAME_HEADER)
+    {
+        start++;
+    }
+    memmove(frame, &frame[start], size - start);
+    frame_level = size - start;
+}
+
+// Cycles of Decimator_Process() per sample sent on the Cortex-M3, with long multiplies of 'multiply' cycles
+static double DecimationNoise_Cycles(int multiply)
+{
+    int axes = 0;
+    double per_input;
+    double per_output;
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        axes += (ACC_AXES >> axis) & 1;
+    }
+    // Per sample read: phase and loop 8; per axis: 2 LDRB, ORR, SXTH, ASR, test of the axis and loop 10,
+    // then LDR, ADD, STR of each integrator 4
+    per_input = 8 + axes * (10 + 4 * DECIMATION_ORDER);
+    // Per sample sent: loop 6; per axis: LDR, SUB, STR, MOV of each comb 5, rounding 3, division by a
+    // constant (SMULL, 2 shifts, sign correction 3), saturation 4, shift and 2 STRB 3, test and loop 5
+    per_output = 6 + axes * (5 * DECIMATION_ORDER + 3 + multiply + 3 + 4 + 3 + 5);
+    return DECIMATION_RATIO * per_input + per_output;
+}
+
+int main(int argc, char** argv)
+{
+    Sim_Config config = {
+        .seconds = 60,
+        .i2c_hz = 400000,
+        .baud = 921600,
+        .timer_hz = POLL_TIMER_CLOCK_HZ,
+        .sensor = {.boot_us = 5000, .noise_ug = 220, .seed = 1, .signal = LIS3DH_MODEL_SIGNAL_SINE},
+        .seed = 1,
+        .monitor = DecimationNoise_Monitor,
+    };
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-p") && i + 1 < argc)
+        {
+            int project = atoi(argv[++i]);
+
+            if (project != 2 && project != 3)
+            {
+                config.seconds = 0;
+                break;
+            }
+            float_values = (project == 3);
+        }
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+        {
+            config.seconds = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+        {
+            config.sensor.noise_ug = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-w") && i + 1 < argc)
+        {
+            config.sensor.noise_hz = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-i") && i + 1 < argc)
+        {
+            config.i2c_hz = strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+        {
+            config.baud = strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            config.seconds = 0;
+            break;
+        }
+    }
+    if (config.seconds <= 0 || config.i2c_hz == 0 || config.baud == 0)
+    {
+        fprintf(stderr, "usage: DecimationNoise [-p 2|3] [-t seconds] [-n noise] [-w hz] [-i i2c_hz] [-b baud]\n");
+        return 1;
+    }
+#if (FRAME_FORMAT != FRAME_FORMAT_HEADER_TAIL || FRAME_SAMPLES != 1)
+    fprintf(stderr, "FRAME_FORMAT_HEADER_TAIL and FRAME_SAMPLES 1 only\n");
+    return 1;
+#endif
+
+    if (Sim_Run(&config, Firmware_Main))
+    {
+        fprintf(stderr, "The firmware returned from main()\n");
+        return 1;
+    }
+    if (noise.samples < 2)
+    {
+        fprintf(stderr, "No samples sent\n");
+        return 1;
+    }
+
+    Sim_Stats sim;
+    LIS3DH_Model_Stats sensor;
+    LIS3DH_Model_Format format;
+    uint32_t pending;
+
+    Sim_GetStats(&sim);
+    LIS3DH_Model_GetStats(&sensor, &pending);
+    LIS3DH_Model_GetFormat(&format);
+
+    double rate = format.odr_hz / DECIMATION_RATIO;
+    double sent = (noise.samples - 1) * (double)BCLK__BUS_CLK__HZ / (noise.last_cycle - noise.first_cycle);
+    double deviation = sqrt(noise.m2 / (noise.samples - 1));
+    double band = (config.sensor.noise_hz > 0) ? config.sensor.noise_hz : format.odr_hz / 2;
+
+    printf("LIS3DH %g Hz, %d bits (%g mg/digit), noise %g ug/sqrt(Hz) over %g Hz (%.3f mg RMS per sample)\n",
+           format.odr_hz, format.bits, format.mg_per_digit, config.sensor.noise_ug, band,
+           config.sensor.noise_ug * 1e-3 * sqrt(band));
+    printf("decimator: ratio %d, order %d (%s), %llu samples read, %llu lost\n",
+           DECIMATION_RATIO, DECIMATION_ORDER, (DECIMATION_ORDER == 1) ? "average" : "CIC",
+           (unsigned long long)sensor.read, (unsigned long long)sensor.lost);
+    printf("output:    %.2f Hz (%.2f samples/s sent), %llu samples, Z mean %.2f mg, deviation %.3f mg, density %.1f ug/sqrt(Hz)"
+           " (%.2f x the sensor)\n",
+           rate, sent, (unsigned long long)noise.samples, noise.mean, deviation,
+           deviation * 1e3 / sqrt(rate / 2), deviation * 1e3 / sqrt(rate / 2) / config.sensor.noise_ug);
+    if (DECIMATION_RATIO > 1)
+    {
+        double best = DecimationNoise_Cycles(3);
+        double worst = DecimationNoise_Cycles(5);
+
+        printf("M3:        %.0f to %.0f cycles per sample sent, %.2f to %.2f %% of the CPU\n",
+               best, worst, 100.0 * best * rate / BCLK__BUS_CLK__HZ, 100.0 * worst * rate / BCLK__BUS_CLK__HZ);
+    }
+    return 0;
+}
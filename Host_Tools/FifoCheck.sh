@@ -0,0 +1,91 @@
+#!/bin/sh
+#
+# \file FifoCheck.sh
+# \brief Check that the FIFO mode loses no sample at any output data rate (see AcquisitionSim.c).
+#
+# Builds AcquisitionSim.c with the firmware of PROJ_2 and PROJ_3 in
+# ACQ_MODE_FIFO for every output data rate of the LIS3DH in the low power,
+# normal and high resolution modes, and runs each build long enough for
+# several watermarks (I2C at 400 kHz by default, the bus of 5.376 kHz).
+# Each run has to:
+#   - pass AcquisitionSim (no duplicated, torn or untraced frame, no loss
+#     at all when the link carries the frames);
+#   - read samples, and lose none in the sensor: no sample overwritten in
+#     the FIFO, no overrun seen by the firmware.
+# Frames dropped by the transmit ring when the UART link cannot carry the
+# output data rate are allowed: they are the limit of the link, not of the
+# FIFO. The script exits 1 if a build or a run fails.
+#
+# Usage: FifoCheck.sh [-i i2c_hz] [-b baud] [-D...]
+#        -i    I2C clock (default 400000)
+#        -b    UART bit rate (default 115200)
+#        -D    switch of macro_definition.h, for all the builds (e.g. -DUSE_INT1=1)
+#
+# \Author Marco Sinatra
+#
+
+TOOLS=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(dirname "$TOOLS")
+I2C_HZ=400000
+BAUD=115200
+DEFINES=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -i) I2C_HZ=$2; shift 2 ;;
+        -b) BAUD=$2; shift 2 ;;
+        -D*) DEFINES="$DEFINES $1"; shift ;;
+        *) echo "usage: FifoCheck.sh [-i i2c_hz] [-b baud] [-D...]" >&2; exit 1 ;;
+    esac
+done
+
+BUILD=$(mktemp -d) || exit 1
+trap 'rm -rf "$BUILD"' EXIT
+
+FAILED=0
+for PROJECT in 2 3; do
+    SOURCES="$ROOT/AY1920_II_HW_05_PROJ_$PROJECT.cydsn"
+    # Power modes as LIS3DH_MODE_*: 0 low power, 1 normal, 2 high resolution
+    for MODE in 0 1 2; do
+        # ODR codes as LIS3DH_ODR_*: 8 (1.6 kHz) is low power only, 9 is 1.344 kHz or 5.376 kHz
+        for ODR in 1 2 3 4 5 6 7 8 9; do
+            if [ "$ODR" -eq 8 ] && [ "$MODE" -ne 0 ]; then
+                continue
+            fi
+            # Three watermarks (FIFO_WATERMARK + 1 samples) at least
+            case "$ODR" in
+                1) SECONDS_RUN=60 ;;
+                2) SECONDS_RUN=6 ;;
+                3) SECONDS_RUN=4 ;;
+                *) SECONDS_RUN=2 ;;
+            esac
+            PROFILE="-DACC_POWER_MODE=$MODE -DACC_ODR=$ODR"
+            PROGRAM="$BUILD/AcquisitionSim_${PROJECT}_${MODE}_${ODR}"
+            if ! gcc -std=c99 -O2 -DHOST_BUILD -Dmain=Firmware_Main -DACQUISITION_MODE=ACQ_MODE_FIFO \
+                     $PROFILE $DEFINES -I"$TOOLS/Sim" -I"$SOURCES" -o "$PROGRAM" \
+                     "$TOOLS/AcquisitionSim.c" "$TOOLS/Sim/Sim.c" "$TOOLS/Sim/LIS3DH_Model.c" \
+                     "$TOOLS/Sim/FrameTrace.c" "$SOURCES"/[A-Z]*.c "$SOURCES/main.c" -lm; then
+                echo "PROJ_$PROJECT $PROFILE: build failed" >&2
+                FAILED=$((FAILED + 1))
+                continue
+            fi
+            "$PROGRAM" -t "$SECONDS_RUN" -i "$I2C_HZ" -b "$BAUD" > "$BUILD/run"
+            STATUS=$?
+            READ=$(sed -n 's/^sensor: .* \([0-9]*\) read (.*/\1/p' "$BUILD/run")
+            LOST=$(sed -n 's/^sensor: .*), \([0-9]*\) lost .*/\1/p' "$BUILD/run")
+            OVERRUNS=$(sed -n 's/^firmware: \([0-9]*\) overruns.*/\1/p' "$BUILD/run")
+            echo "PROJ_$PROJECT $PROFILE: ${READ:-?} read, ${LOST:-?} lost, ${OVERRUNS:-?} overruns"
+            if [ "$STATUS" -ne 0 ] || [ "${READ:-0}" -eq 0 ] || [ "${LOST:-1}" -ne 0 ] || \
+               [ "${OVERRUNS:-1}" -ne 0 ]; then
+                cat "$BUILD/run"
+                echo "PROJ_$PROJECT $PROFILE: check failed" >&2
+                FAILED=$((FAILED + 1))
+            fi
+        done
+    done
+done
+
+if [ "$FAILED" -gt 0 ]; then
+    echo "$FAILED profiles failed" >&2
+    exit 1
+fi
@@ -0,0 +1,540 @@
+/**
+ * \file FilterDesign.c
+ * \brief Design of the biquad chains of the firmware (USE_FILTER) and check of Filter.c.
+ *
+ * Designs a chain of second order sections for each axis from the given
+ * specifications, with the bilinear transform (cookbook formulas, cut-off
+ * frequencies prewarped):
+ *   - lowpass and highpass: Butterworth of order 2 x sections;
+ *   - bandpass: one section centred on the geometric mean of the two
+ *     frequencies, or highpass sections at the first one followed by
+ *     lowpass sections at the second one.
+ * The coefficients are rounded to Q2.30 and written in the header of the
+ * firmware (FilterCoefficients.h, -o). The axes without a specification
+ * are not filtered.
+ * Then Filter.c of the firmware, compiled on the PC (HOST_BUILD), runs the
+ * quantized chains on a test signal (tones at 1%, 5%, 20% and 60% of the
+ * Nyquist frequency, offset and noise, 70% of the full scale of the
+ * profile), in bursts of 1 to LIS3DH_FIFO_SIZE samples as main.c does, and
+ * its output is compared with the same chains designed and run in double
+ * precision: maximum and RMS error in digits (rounding the output to whole
+ * digits alone gives 0.5 and 0.29), samples equal to the rounded reference
+ * and error power under the output power. The program exits with 1 if an
+ * error reaches 1 digit.
+ * Last, the cycles per sample of Filter_Process() on the Cortex-M3 are
+ * estimated from the instructions of its loops and the cycle counts of the
+ * Cortex-M3 Technical Reference Manual (long multiply-accumulate 3 to 5
+ * cycles, load 2, taken branch 3): the 'filter' stage of the profiler (see
+ * USE_PROFILER) measures them on the PSoC.
+ *
+ * Build: gcc -std=c99 -O2 -DHOST_BUILD -ISim -I../AY1920_II_HW_05_PROJ_2.cydsn -o FilterDesign
+ *            FilterDesign.c ../AY1920_II_HW_05_PROJ_2.cydsn/Filter.c -lm
+ *        (the resolution and the rate of the samples sent are the ones of the profile
+ *        of macro_definition.h, e.g. -DACC_ODR=9 for 1.344 kHz, -DDECIMATION_RATIO=13)
+ * Usage: FilterDesign [-s odr_hz] [-n sections] [-o file] [-t seconds] [-r seed] spec...
+ *        spec  axes:type:hz[:hz], e.g. xyz:lowpass:10, z:highpass:0.5, xy:bandpass:1:20
+ *              (after the options)
+ *        -s    rate of the samples (default: the one of the profile, after the decimator)
+ *        -n    sections per chain (default 2, at most FILTER_MAX_SECTIONS)
+ *        -o    header to be written (FilterCoefficients.h of the firmware)
+ *        -t    length of the test signal (default 60 s)
+ *        -r    seed of the noise (default 1)
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Decimator.h"
+#include "Filter.h"
+#include "LIS3DH_Profile.h"
+#include "macro_definition.h"
+#include "project.h"
+
+#define PI 3.14159265358979323846
+#define Q30 1073741824.0        // 2^FILTER_COEFFICIENT_BITS
+
+typedef enum {
+    TYPE_LOWPASS,
+    TYPE_HIGHPASS,
+    TYPE_BANDPASS
+} FilterType;
+
+static const char* const type_names[3] = {"lowpass", "highpass", "bandpass"};
+
+typedef struct {
+    double b0, b1, b2, a1, a2;  // Normalized by a0, a1 and a2 with the sign of the transfer function
+    double hz;
+    double q;
+} Biquad;
+
+typedef struct {
+    int sections;
+    FilterType type;
+    double hz[2];
+    Biquad biquad[FILTER_MAX_SECTIONS];
+    Filter_Section section[FILTER_MAX_SECTIONS];
+} AxisChain;
+
+static AxisChain axis_chain[3];
+static double odr_hz = (double)LIS3DH_PROFILE_ODR_HZ / DECIMATION_RATIO;
+static int sections = 2;
+
+// Cookbook biquad with the cut-off (or centre) frequency prewarped
+static Biquad FilterDesign_Biquad(FilterType type, double hz, double q)
+{
+    double w0 = 2.0 * PI * hz / odr_hz;
+    double cosine = cos(w0);
+    double alpha = sin(w0) / (2.0 * q);
+    double a0 = 1.0 + alpha;
+    Biquad biquad = {.hz = hz, .q = q};
+
+    switch (type)
+    {
+    case TYPE_LOWPASS:
+        biquad.b0 = (1.0 - cosine) / 2.0;
+        biquad.b1 = 1.0 - cosine;
+        biquad.b2 = (1.0 - cosine) / 2.0;
+        break;
+    case TYPE_HIGHPASS:
+        biquad.b0 = (1.0 + cosine) / 2.0;
+        biquad.b1 = -(1.0 + cosine);
+        biquad.b2 = (1.0 + cosine) / 2.0;
+        break;
+    default:
+        biquad.b0 = alpha;  // 0 dB at the centre frequency
+        biquad.b1 = 0.0;
+        biquad.b2 = -alpha;
+        break;
+    }
+    biquad.b0 /= a0;
+    biquad.b1 /= a0;
+    biquad.b2 /= a0;
+    biquad.a1 = -2.0 * cosine / a0;
+    biquad.a2 = (1.0 - alpha) / a0;
+    return biquad;
+}
+
+// Butterworth of order 2 x count: a section per pair of poles
+static void FilterDesign_Butterworth(Biquad* biquad, int count, FilterType type, double hz)
+{
+    for (int k = 0; k < count; k++)
+    {
+        double q = 1.0 / (2.0 * cos(PI * (2 * k + 1) / (8.0 * count)));
+
+        biquad[k] = FilterDesign_Biquad(type, hz, q);
+    }
+}
+
+static int FilterDesign_Quantize(double value, int32_t* out)
+{
+    double scaled = round(value * Q30);
+
+    if (scaled > 2147483647.0 || scaled < -2147483648.0)
+    {
+        return 0;
+    }
+    *out = (int32_t)scaled;
+    return 1;
+}
+
+static int FilterDesign_Chain(AxisChain* chain)
+{
+    if (chain->type == TYPE_BANDPASS && chain->sections == 1)
+    {
+        double centre = sqrt(chain->hz[0] * chain->hz[1]);
+
+        chain->biquad[0] = FilterDesign_Biquad(TYPE_BANDPASS, centre, centre / (chain->hz[1] - chain->hz[0]));
+    }
+    else if (chain->type == TYPE_BANDPASS)
+    {
+        int highpass = (chain->sections + 1) / 2;
+
+        FilterDesign_Butterworth(chain->biquad, highpass, TYPE_HIGHPASS, chain->hz[0]);
+        FilterDesign_Butterworth(&chain->biquad[highpass], chain->sections - highpass, TYPE_LOWPASS, chain->hz[1]);
+    }
+    else
+    {
+        FilterDesign_Butterworth(chain->biquad, chain->sections, chain->type, chain->hz[0]);
+    }
+    for (int k = 0; k < chain->sections; k++)
+    {
+        const Biquad* biquad = &chain->biquad[k];
+        Filter_Section* section = &chain->section[k];
+
+        // Feedback coefficients negated: the firmware only adds products
+        if (!FilterDesign_Quantize(biquad->b0, &section->b0) || !FilterDesign_Quantize(biquad->b1, &section->b1) ||
+            !FilterDesign_Quantize(biquad->b2, &section->b2) || !FilterDesign_Quantize(-biquad->a1, &section->a1) ||
+            !FilterDesign_Quantize(-biquad->a2, &section->a2))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// axes:type:hz[:hz]
+static int FilterDesign_Spec(const char* spec)
+{
+    char axes[4];
+    char type[16];
+    double hz[2] = {0.0, 0.0};
+    int fields = sscanf(spec, "%3[xyz]:%15[a-z]:%lf:%lf", axes, type, &hz[0], &hz[1]);
+    FilterType filter_type;
+
+    if (fields < 3)
+    {
+        return 0;
+    }
+    if (!strcmp(type, "lowpass"))
+    {
+        filter_type = TYPE_LOWPASS;
+    }
+    else if (!strcmp(type, "highpass"))
+    {
+        filter_type = TYPE_HIGHPASS;
+    }
+    else if (!strcmp(type, "bandpass") && fields == 4 && hz[1] > hz[0])
+    {
+        filter_type = TYPE_BANDPASS;
+    }
+    else
+    {
+        return 0;
+    }
+    if (hz[0] <= 0.0 || hz[0] >= odr_hz / 2 || hz[1] >= odr_hz / 2)
+    {
+        fprintf(stderr, "%s: the frequencies must be between 0 and %g Hz\n", spec, odr_hz / 2);
+        return 0;
+    }
+    for (const char* axis = axes; *axis; axis++)
+    {
+        AxisChain* chain = &axis_chain[*axis - 'x'];
+
+        chain->sections = sections;
+        chain->type = filter_type;
+        chain->hz[0] = hz[0];
+        chain->hz[1] = hz[1];
+    }
+    return 1;
+}
+
+static int FilterDesign_WriteHeader(const char* name, int argc, char** argv)
+{
+    FILE* header = fopen(name, "w");
+
+    if (header == NULL)
+    {
+        perror(name);
+        return 0;
+    }
+    fprintf(header, "/**\n"
+                    " * \\file FilterCoefficients.h\n"
+                    " * \\brief Biquad chains of the axes (see Filter.h), written by Host_Tools/FilterDesign:\n"
+                    " *       ");
+    for (int i = 0; i < argc; i++)
+    {
+        fprintf(header, " %s", (i == 0) ? "FilterDesign" : argv[i]);
+    }
+    fprintf(header, "\n *\n");
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const AxisChain* chain = &axis_chain[axis];
+
+        fprintf(header, " *   %c: ", 'X' + axis);
+        if (chain->sections == 0)
+        {
+            fprintf(header, "not filtered\n");
+        }
+        else if (chain->type == TYPE_BANDPASS)
+        {
+            fprintf(header, "bandpass %g-%g Hz, %d sections\n", chain->hz[0], chain->hz[1], chain->sections);
+        }
+        else
+        {
+            fprintf(header, "%s %g Hz, Butterworth of order %d\n", type_names[chain->type], chain->hz[0],
+                    2 * chain->sections);
+        }
+    }
+    fprintf(header, " * Coefficients b0, b1, b2, -a1, -a2 in Q2.30 (see Filter_Section).\n"
+                    "*/\n"
+                    "\n"
+                    "#ifndef FilterCoefficients_H\n"
+                    "    #define FilterCoefficients_H\n"
+                    "    \n"
+                    "    /**\n"
+                    "    *   \\brief Output data rate of the design: it must be the one of the profile.\n"
+                    "    */\n"
+                    "    #define FILTER_DESIGN_ODR_HZ %ld\n", lround(odr_hz));
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const AxisChain* chain = &axis_chain[axis];
+
+        fprintf(header, "    \n"
+                        "    #define FILTER_%c_SECTIONS %d\n", 'X' + axis, chain->sections);
+        if (chain->sections == 0)
+        {
+            fprintf(header, "    #define FILTER_%c_COEFFICIENTS {{0, 0, 0, 0, 0}} //Not used\n", 'X' + axis);
+            continue;
+        }
+        fprintf(header, "    #define FILTER_%c_COEFFICIENTS { \\\n", 'X' + axis);
+        for (int k = 0; k < chain->sections; k++)
+        {
+            const Filter_Section* section = &chain->section[k];
+
+            fprintf(header, "        {%ld, %ld, %ld, %ld, %ld}, /* %g Hz, Q %.4f */ \\\n",
+                    (long)section->b0, (long)section->b1, (long)section->b2, (long)section->a1, (long)section->a2,
+                    chain->biquad[k].hz, chain->biquad[k].q);
+        }
+        fprintf(header, "    }\n");
+    }
+    fprintf(header, "\n"
+                    "#endif // FilterCoefficients_H\n"
+                    "/* [] END OF FILE */\n");
+    fclose(header);
+    return 1;
+}
+
+// Standard normal number (Box-Muller)
+static double FilterDesign_Gaussian(void)
+{
+    double u = (rand() + 1.0) / ((double)RAND_MAX + 2.0);
+    double v = (rand() + 1.0) / ((double)RAND_MAX + 2.0);
+
+    return sqrt(-2.0 * log(u)) * cos(2.0 * PI * v);
+}
+
+// Filter.c against the double precision chains on the test signal: 1 if equivalent within 1 digit
+static int FilterDesign_Check(double seconds)
+{
+    Filter_Chain chains[3];
+    double state[3][FILTER_MAX_SECTIONS][4];
+    double error_max = 0.0;
+    double error_sum = 0.0;
+    double output_sum = 0.0;
+    unsigned long exact = 0;
+    unsigned long checked = 0;
+    long limit = 1L << (LIS3DH_PROFILE_RESOLUTION_BITS - 1);
+    long total = lround(seconds * odr_hz);
+    uint8_t axes = 0;
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        chains[axis].sections = axis_chain[axis].sections;
+        chains[axis].section = axis_chain[axis].section;
+        axes |= (chains[axis].sections > 0) << axis;
+    }
+    if (Filter_Start(chains) != NO_ERROR)
+    {
+        fprintf(stderr, "Filter_Start() refused the chains\n");
+        return 0;
+    }
+    memset(state, 0, sizeof(state));
+
+    for (long n = 0; n < total; )
+    {
+        uint8_t burst[LIS3DH_FIFO_SIZE * LIS3DH_SAMPLE_SIZE];
+        double input[LIS3DH_FIFO_SIZE][3];
+        int count = 1 + rand() % LIS3DH_FIFO_SIZE;
+
+        count = (count > total - n) ? (int)(total - n) : count;
+        for (int s = 0; s < count; s++)
+        {
+            double t = (n + s) / odr_hz;
+
+            for (int axis = 0; axis < 3; axis++)
+            {
+                double value = 0.1 + 2.0 * FilterDesign_Gaussian() / limit;
+                long digits;
+                uint16_t register_value;
+
+                value += 0.15 * sin(2.0 * PI * 0.005 * odr_hz * t + axis);
+                value += 0.15 * sin(2.0 * PI * 0.025 * odr_hz * t + 2 * axis);
+                value += 0.15 * sin(2.0 * PI * 0.1 * odr_hz * t + 3 * axis);
+                value += 0.15 * sin(2.0 * PI * 0.3 * odr_hz * t + 4 * axis);
+                digits = lround(value * limit);
+                digits = (digits >= limit) ? limit - 1 : (digits < -limit) ? -limit : digits;
+                input[s][axis] = (double)digits;
+                register_value = (uint16_t)((unsigned long)digits << LIS3DH_PROFILE_SHIFT);
+                burst[s * LIS3DH_SAMPLE_SIZE + 2 * axis] = (uint8_t)register_value;
+                burst[s * LIS3DH_SAMPLE_SIZE + 2 * axis + 1] = (uint8_t)(register_value >> 8);
+            }
+        }
+
+        Filter_Process(burst, (uint8_t)count, axes);
+
+        for (int s = 0; s < count; s++)
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                const AxisChain* chain = &axis_chain[axis];
+                double value = input[s][axis];
+
+                if (chain->sections == 0)
+                {
+                    continue;
+                }
+                for (int k = 0; k < chain->sections; k++)
+                {
+                    const Biquad* biquad = &chain->biquad[k];
+                    double* z = state[axis][k];
+                    double y = biquad->b0 * value + biquad->b1 * z[0] + biquad->b2 * z[1] - biquad->a1 * z[2] -
+                               biquad->a2 * z[3];
+
+                    z[1] = z[0];
+                    z[0] = value;
+                    z[3] = z[2];
+                    z[2] = y;
+                    value = y;
+                }
+                value = (value >= limit - 1) ? limit - 1 : (value < -limit) ? -limit : value;
+
+                const uint8_t* out = &burst[s * LIS3DH_SAMPLE_SIZE + 2 * axis];
+                int16_t firmware = (int16_t)(out[0] | (out[1] << 8)) >> LIS3DH_PROFILE_SHIFT;
+                double error = fabs(firmware - value);
+
+                error_max = (error > error_max) ? error : error_max;
+                error_sum += error * error;
+                output_sum += value * value;
+                exact += (firmware == lround(value));
+                checked++;
+            }
+        }
+        n += count;
+    }
+
+    if (checked == 0)
+    {
+        printf("check:     no axis filtered\n");
+        return 1;
+    }
+    printf("check:     %lu samples, error max %.3f digits, RMS %.3f digits, %.2f %% equal to the rounded reference,"
+           " %.1f dB under the output\n",
+           checked, error_max, sqrt(error_sum / checked), 100.0 * exact / checked,
+           (error_sum > 0) ? 10.0 * log10(output_sum / error_sum) : INFINITY);
+    return error_max < 1.0;
+}
+
+// Cycles of Filter_Process() per sample on the Cortex-M3, with long multiplies of 'multiply' cycles
+static double FilterDesign_Cycles(int multiply, int batch)
+{
+    double cycles = 0.0;
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        int count = axis_chain[axis].sections;
+
+        if (count == 0)
+        {
+            continue;
+        }
+        // Per sample: load and right-justify (2 LDRB, ORR, SXTH, ASR, LSL, STR, loop 5 = 13), round, saturate
+        // and write back (LDR 2, 2 ASR, ADD, 2 CMP + IT, LSL, 2 STRB, loop 5 = 16)
+        cycles += 13 + 16;
+        // Per sample and section: LDR 2, rounding constant 2, 5 long multiply-accumulates, shift and
+        // saturation 6, 4 MOV of the state, STR 1, loop 5 (with 2 reloads of spilled coefficients 4)
+        cycles += count * (2 + 2 + 5 * multiply + 6 + 4 + 1 + 5 + 4);
+        // Per burst: call of each section (load of the coefficients and of the state, store of the state)
+        cycles += (count * 30.0 + 20.0) / batch;
+    }
+    return cycles;
+}
+
+int main(int argc, char** argv)
+{
+    const char* header_name = NULL;
+    double seconds = 60.0;
+    unsigned seed = 1;
+    int specs = 0;
+    int usage = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-s") && i + 1 < argc)
+        {
+            odr_hz = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+        {
+            sections = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+        {
+            header_name = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+        {
+            seconds = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+        {
+            seed = (unsigned)strtoul(argv[++i], NULL, 0);
+        }
+        else if (argv[i][0] != '-' && odr_hz > 0 && sections >= 1 && sections <= FILTER_MAX_SECTIONS &&
+                 FilterDesign_Spec(argv[i]))
+        {
+            specs++;
+        }
+        else
+        {
+            usage = 1;
+            break;
+        }
+    }
+    if (usage || specs == 0 || seconds <= 0)
+    {
+        fprintf(stderr, "usage: FilterDesign [-s odr_hz] [-n sections] [-o file] [-t seconds] [-r seed] spec...\n"
+                        "       spec: axes:lowpass:hz, axes:highpass:hz or axes:bandpass:hz:hz\n"
+                        "       (axes: x, y, z or a combination; sections: 1 to %d)\n", FILTER_MAX_SECTIONS);
+        return 1;
+    }
+    srand(seed);
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        AxisChain* chain = &axis_chain[axis];
+
+        if (chain->sections == 0)
+        {
+            continue;
+        }
+        if (!FilterDesign_Chain(chain))
+        {
+            fprintf(stderr, "%c: a coefficient does not fit Q2.30\n", 'X' + axis);
+            return 1;
+        }
+        printf("%c:", 'X' + axis);
+        for (int k = 0; k < chain->sections; k++)
+        {
+            printf(" [%s %g Hz, Q %.4f]", (chain->type == TYPE_BANDPASS && chain->sections > 1) ?
+                   type_names[k < (chain->sections + 1) / 2 ? TYPE_HIGHPASS : TYPE_LOWPASS] :
+                   type_names[chain->type], chain->biquad[k].hz, chain->biquad[k].q);
+        }
+        printf("\n");
+    }
+    if (header_name != NULL && !FilterDesign_WriteHeader(header_name, argc, argv))
+    {
+        return 1;
+    }
+
+    if (lround(odr_hz) != DECIMATION_OUTPUT_ODR_HZ)
+    {
+        printf("check:     the test runs at %g Hz, the samples of this build are sent at %d Hz\n",
+               odr_hz, (int)DECIMATION_OUTPUT_ODR_HZ);
+    }
+    int equivalent = FilterDesign_Check(seconds);
+
+    // One sample per read, or a FIFO burst of FIFO_WATERMARK samples
+    for (int batch = 1; batch <= FIFO_WATERMARK; batch += FIFO_WATERMARK - 1)
+    {
+        double best = FilterDesign_Cycles(3, batch);
+        double worst = FilterDesign_Cycles(5, batch);
+
+        printf("M3:        %2d sample(s) per read: %.0f to %.0f cycles per sample, %.2f to %.2f %% of the CPU"
+               " at %g Hz\n", batch, best, worst, 100.0 * best * odr_hz / BCLK__BUS_CLK__HZ,
+               100.0 * worst * odr_hz / BCLK__BUS_CLK__HZ, odr_hz);
+    }
+    return equivalent ? 0 : 1;
+}
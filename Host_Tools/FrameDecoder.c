@@ -0,0 +1,662 @@
+/**
+ * \file FrameDecoder.c
+ * \brief Host-side decoder of the accelerometer frames.
+ *
+ * Reads the bytes received from the PSoC UART (a serial port or a capture
+ * file) and prints one line per sample with the X, Y and Z values. Both the
+ * original frame (header, one sample, tail) and the batched frame (header,
+ * sample count, FRAME_SAMPLES samples, tail) are decoded. Frames are found
+ * by their header and tail, so the decoder resynchronises after lost bytes.
+ * With -c the COBS packets of FRAME_FORMAT_COBS are decoded instead (see
+ * Packet.h): packets end at each 0x00 byte, those with a wrong CRC16 are
+ * discarded and the samples lost in between are counted from the sequence
+ * numbers. The compressed packets of FRAME_FORMAT_DELTA (see DeltaCodec.h)
+ * and the bit-packed ones of FRAME_FORMAT_PACKED (see BitPack.h) are
+ * recognised by their flags and give the same values as the uncompressed
+ * formats; after a lost delta packet the samples up to the next keyframe
+ * cannot be decoded and are counted as lost. The telemetry packets of
+ * USE_TELEMETRY (see Telemetry.h) are printed on stderr, one line starting
+ * with '#' each, so that the samples on stdout stay plain CSV, as the text
+ * sent between two packets (e.g. the table of USE_PROFILER, see Profiler.h).
+ * The log records of LOG_FORMAT_BINARY (see Log.h) are expanded with the
+ * format table of the firmware (LogMessages.h, included at build time) and
+ * printed on stderr as the firmware would print the text; -l prints the
+ * table and checks that each format takes as many values as the message
+ * has arguments.
+ * Only the axes enabled in the firmware (see LIS3DH_SetAxes()) are printed,
+ * X first: packets carry them, for the other frames they are given by -a.
+ *
+ * Build: gcc -std=c99 -O2 -I../AY1920_II_HW_05_PROJ_2.cydsn -o FrameDecoder FrameDecoder.c
+ * Usage: FrameDecoder [-p 2|3] [-n samples] [-a axes] [-q] [-c] [-l] [file]
+ *        -p 2  PROJ_2 frames: int16 values in mg (default)
+ *        -p 3  PROJ_3 frames: float values in m/s2
+ *        -q    PROJ_3 frames with OUTPUT_FORMAT_Q16_16
+ *        -n    FRAME_SAMPLES of the firmware (default 1, not needed with -c)
+ *        -a    ACC_AXES of the firmware, e.g. xyz (default) or z (not needed with -c)
+ *        -c    COBS packets (FRAME_FORMAT_COBS and FRAME_FORMAT_DELTA)
+ *        -l    print and check the log format table, then exit
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "LogMessages.h"
+
+#define FRAME_HEADER 0xA0
+#define FRAME_TAIL 0xC0
+#define FRAME_MAX_SIZE 255
+#define TEXT_MAX_SIZE 2048      // Text between two packets, '#' lines
+#define PACKET_HEADER_SIZE 4    // Sequence number, sample count and axes, after COBS decoding
+#define PACKET_CRC_SIZE 2
+#define PACKET_DELTA 0x80
+#define PACKET_KEYFRAME 0x40
+#define PACKET_PACKED 0x40
+#define PACKET_COUNT_MASK 0x3F
+#define PACKET_TELEMETRY 0x00
+#define TELEMETRY_COUNTERS 8   // 4 bytes each, LSB first (see Telemetry_Stats)
+#define PACKET_LOG 0x40         // Log record: message ID in place of the axes, varint arguments
+#define LOG_ARGUMENTS_MAX 8
+#define LOG_TEXT_SIZE 256
+#define AXES_ALL 0x07           // Bit 0 X, bit 1 Y, bit 2 Z, as ACC_AXES
+
+/* Same constants as Conversion.h of the firmware */
+#define CONVERSION_GRAVITY 9.81
+#define CONVERSION_FACTOR_BITS 28
+
+typedef enum {
+    VALUE_INT16,    ///< PROJ_2: 2 bytes per axis, mg
+    VALUE_FLOAT,    ///< PROJ_3: 4 bytes per axis, float m/s2
+    VALUE_Q16_16    ///< PROJ_3: 4 bytes per axis, Q16.16 m/s2
+} ValueFormat;
+
+static ValueFormat format = VALUE_INT16;
+static int frame_samples = 1;
+static int frame_axes = AXES_ALL;
+static unsigned long frames = 0, samples = 0, skipped = 0;
+static unsigned long bad_packets = 0, lost_samples = 0, telemetry_packets = 0;
+static unsigned long log_records = 0, lost_records = 0;
+
+/* Same table as the firmware */
+#define LOG_ARGUMENTS(id, arguments, format) arguments,
+#define LOG_FORMAT_STRING(id, arguments, format) format,
+#define LOG_NAME(id, arguments, format) #id,
+
+static const int log_arguments[] = {LOG_MESSAGES(LOG_ARGUMENTS)};
+static const char* const log_formats[] = {LOG_MESSAGES(LOG_FORMAT_STRING)};
+static const char* const log_names[] = {LOG_MESSAGES(LOG_NAME)};
+static const int log_messages = sizeof(log_arguments) / sizeof(log_arguments[0]);
+
+static int ValueSize(void)
+{
+    return (format == VALUE_INT16) ? 2 : 4;
+}
+
+static double DecodeValue(const uint8_t* data)
+{
+    uint32_t raw = data[0] | (data[1] << 8);
+    float value;
+
+    if (format == VALUE_INT16)
+    {
+        return (int16_t)raw;
+    }
+    raw |= ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    if (format == VALUE_Q16_16)
+    {
+        return (int32_t)raw / 65536.0;
+    }
+    memcpy(&value, &raw, sizeof(value)); // LSB first, as the Cortex-M3
+    return value;
+}
+
+static int AxisCount(int axes)
+{
+    return (axes & 1) + ((axes >> 1) & 1) + ((axes >> 2) & 1);
+}
+
+/* One line per sample with the values of its axes */
+static void PrintLine(const double* values, int axis_count)
+{
+    for (int a = 0; a < axis_count; a++)
+    {
+        printf((a + 1 < axis_count) ? "%g," : "%g\n", values[a]);
+    }
+}
+
+static void PrintSamples(const uint8_t* data, int count, int axis_count)
+{
+    double values[3];
+
+    for (int s = 0; s < count; s++)
+    {
+        for (int a = 0; a < axis_count; a++, data += ValueSize())
+        {
+            values[a] = DecodeValue(data);
+        }
+        PrintLine(values, axis_count);
+    }
+    frames++;
+    samples += count;
+}
+
+/* Value of a right-justified sample, converted as the firmware does */
+static double RawValue(int32_t raw, int sensitivity)
+{
+    int32_t factor = (int32_t)(sensitivity * CONVERSION_GRAVITY / 1000.0 *
+                               (double)(1UL << CONVERSION_FACTOR_BITS) + 0.5);
+    int32_t q16 = (int32_t)(((int64_t)raw * factor) >> (CONVERSION_FACTOR_BITS - 16));
+
+    if (format == VALUE_INT16)
+    {
+        return raw * sensitivity;
+    }
+    if (format == VALUE_Q16_16)
+    {
+        return q16 / 65536.0;
+    }
+    return (float)q16 * (1.0f / 65536.0f);
+}
+
+/* Print right-justified values, axis_count per sample */
+static void PrintRaw(const int32_t* values, int count, int axis_count, int sensitivity)
+{
+    double line[3];
+
+    for (int s = 0; s < count; s++)
+    {
+        for (int a = 0; a < axis_count; a++)
+        {
+            line[a] = RawValue(*values++, sensitivity);
+        }
+        PrintLine(line, axis_count);
+    }
+    frames++;
+    samples += count;
+}
+
+/* Decode the samples of a FRAME_FORMAT_DELTA packet, false if malformed */
+static int DecodeDelta(const uint8_t* data, int length, int count, int axis_count, int keyframe)
+{
+    static int32_t previous[3];
+    static int sensitivity;
+    int32_t values[3 * PACKET_COUNT_MASK];
+    const uint8_t* end = data + length;
+
+    if (keyframe)
+    {
+        if (length < 1)
+        {
+            return 0;
+        }
+        sensitivity = *data++;
+        previous[0] = previous[1] = previous[2] = 0;
+    }
+
+    for (int i = 0; i < axis_count * count; i++)
+    {
+        uint32_t code = 0;
+        int shift = 0;
+
+        // At most 3 bytes (21 bits) per value
+        do
+        {
+            if (data == end || shift > 14)
+            {
+                return 0;
+            }
+            code |= (uint32_t)(*data & 0x7F) << shift;
+            shift += 7;
+        } while (*data++ & 0x80);
+
+        previous[i % axis_count] += (int32_t)(code >> 1) ^ -(int32_t)(code & 1);
+        values[i] = previous[i % axis_count];
+    }
+    if (data != end)
+    {
+        return 0;
+    }
+
+    PrintRaw(values, count, axis_count, sensitivity);
+    return 1;
+}
+
+/* Unpack values of 'bits' bits (LSB first): one unaligned 64-bit load per
+   value, no branch, so the loop can be vectorised. 'data' must be readable
+   for 8 bytes past the last value. Little-endian host. */
+static void Unpack(const uint8_t* data, int bits, int value_count, int32_t* values)
+{
+    for (int i = 0; i < value_count; i++)
+    {
+        int bit = i * bits;
+        uint64_t word;
+
+        memcpy(&word, &data[bit >> 3], sizeof(word));
+        values[i] = (int32_t)((uint32_t)(word >> (bit & 7)) << (32 - bits)) >> (32 - bits);
+    }
+}
+
+/* Decode the samples of a FRAME_FORMAT_PACKED packet, false if malformed */
+static int DecodePacked(const uint8_t* data, int length, int count, int axis_count)
+{
+    int32_t values[3 * PACKET_COUNT_MASK];
+
+    if (length < 2 || data[1] < 8 || data[1] > 16 ||
+        length != 2 + (count * axis_count * data[1] + 7) / 8)
+    {
+        return 0;
+    }
+    Unpack(&data[2], data[1], axis_count * count, values);
+
+    PrintRaw(values, count, axis_count, data[0]);
+    return 1;
+}
+
+/* Print the counters of a telemetry packet, false if malformed */
+static int PrintTelemetry(uint16_t sequence, const uint8_t* data, int length)
+{
+    unsigned long counters[TELEMETRY_COUNTERS];
+
+    if (length != 4 * TELEMETRY_COUNTERS)
+    {
+        return 0;
+    }
+    for (int i = 0; i < TELEMETRY_COUNTERS; i++, data += 4)
+    {
+        counters[i] = data[0] | (data[1] << 8) | ((unsigned long)data[2] << 16) | ((unsigned long)data[3] << 24);
+    }
+
+    // Same order as Telemetry_Stats
+    fprintf(stderr, "# telemetry at sample %u: %lu samples read, %lu overruns, %lu I2C errors, "
+            "%lu frames dropped, loop min/avg/max %lu/%lu/%lu cycles over %lu iterations\n",
+            sequence, counters[0], counters[1], counters[2], counters[3],
+            counters[5], counters[7], counters[6], counters[4]);
+    telemetry_packets++;
+    return 1;
+}
+
+/* Values taken by a log format (the conversions of Log.c), -1 if it has others */
+static int LogConversions(const char* format)
+{
+    int count = 0;
+
+    for (; *format; format++)
+    {
+        if (*format != '%')
+        {
+            continue;
+        }
+        format++;
+        format += strspn(format, "0123456789");
+        if (*format == 'u' || *format == 'x' || *format == 'X')
+        {
+            count++;
+        }
+        else if (*format != '%')
+        {
+            return -1;
+        }
+    }
+    return count;
+}
+
+/* Check the format table and print it with -l, false if an entry is wrong */
+static int CheckLogTable(int print)
+{
+    int valid = 1;
+
+    for (int id = 0; id < log_messages; id++)
+    {
+        int conversions = LogConversions(log_formats[id]);
+        int ok = conversions == log_arguments[id] && conversions <= LOG_ARGUMENTS_MAX;
+
+        if (print || !ok)
+        {
+            fprintf(print ? stdout : stderr, "%3d %-24s %d %s", id, log_names[id], log_arguments[id],
+                    ok ? "" : "(format does not match the arguments) ");
+            for (const char* c = log_formats[id]; *c; c++)
+            {
+                if (*c == '\r' || *c == '\n')
+                {
+                    fputs((*c == '\r') ? "\\r" : "\\n", print ? stdout : stderr);
+                }
+                else
+                {
+                    fputc(*c, print ? stdout : stderr);
+                }
+            }
+            fputc('\n', print ? stdout : stderr);
+        }
+        valid &= ok;
+    }
+    return valid;
+}
+
+/* Expand a log record and print it as the firmware prints the text, false if malformed */
+static int PrintLog(int id, const uint8_t* data, int length)
+{
+    static int line_start = 1;
+    unsigned int values[LOG_ARGUMENTS_MAX] = {0};
+    char text[LOG_TEXT_SIZE];
+
+    if (id >= log_messages)
+    {
+        return 0;
+    }
+    for (int i = 0; i < log_arguments[id]; i++)
+    {
+        uint32_t value = 0;
+        int shift = 0;
+
+        // Base-128 varint, LSB first
+        do
+        {
+            if (length == 0 || shift > 28)
+            {
+                return 0;
+            }
+            value |= (uint32_t)(*data & 0x7F) << shift;
+            shift += 7;
+            length--;
+        } while (*data++ & 0x80);
+        values[i] = value;
+    }
+    if (length != 0)
+    {
+        return 0;
+    }
+
+    snprintf(text, sizeof(text), log_formats[id], values[0], values[1], values[2], values[3],
+             values[4], values[5], values[6], values[7]);
+    for (const char* c = text; *c; c++)
+    {
+        // Lines start with '#', as the text sent between the packets
+        if (line_start && *c != '#')
+        {
+            fputc('#', stderr);
+        }
+        fputc(*c, stderr);
+        line_start = (*c == '\n');
+    }
+    log_records++;
+    return 1;
+}
+
+/* Text lines between two packets: '#' first, printable characters only */
+static int IsText(const uint8_t* data, int length)
+{
+    if (length == 0 || data[0] != '#')
+    {
+        return 0;
+    }
+    for (int i = 0; i < length; i++)
+    {
+        if ((data[i] < ' ' || data[i] > '~') && data[i] != '\r' && data[i] != '\n')
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Same polynomial and initial value as Packet_Crc16() of the firmware */
+static uint16_t Crc16(const uint8_t* data, int length)
+{
+    uint16_t crc = 0xFFFF;
+
+    while (length--)
+    {
+        uint8_t x = (crc >> 8) ^ *data++;
+        x ^= x >> 4;
+        crc = (crc << 8) ^ ((uint16_t)x << 12) ^ ((uint16_t)x << 5) ^ x;
+    }
+    return crc;
+}
+
+/* Decode the bytes of a COBS packet (delimiter excluded) in place */
+static int CobsDecode(uint8_t* data, int length)
+{
+    int in = 0, out = 0;
+
+    while (in < length)
+    {
+        int code = data[in++];
+
+        if (code == 0 || in + code - 1 > length)
+        {
+            return -1;
+        }
+        for (int i = 1; i < code; i++)
+        {
+            data[out++] = data[in++];
+        }
+        if (code < 0xFF && in < length)
+        {
+            data[out++] = 0;
+        }
+    }
+    return out;
+}
+
+static void DecodePackets(FILE* input)
+{
+    uint8_t packet[TEXT_MAX_SIZE + 8];      // Room for the 64-bit loads of Unpack()
+    int level = 0, synced = 0, delta_chain = 0, delta_axes = 0;
+    uint16_t next_sequence = 0;
+    int c;
+
+    while ((c = fgetc(input)) != EOF)
+    {
+        if (c != 0)
+        {
+            // A packet longer than the maximum is garbage up to the next delimiter
+            if (level <= TEXT_MAX_SIZE)
+            {
+                packet[level] = (uint8_t)c;
+            }
+            level++;
+            continue;
+        }
+
+        if (level <= TEXT_MAX_SIZE && IsText(packet, level))
+        {
+            fwrite(packet, 1, level, stderr);
+            level = 0;
+            continue;
+        }
+
+        int length = (level <= FRAME_MAX_SIZE) ? CobsDecode(packet, level) : -1;
+
+        if (length < PACKET_HEADER_SIZE + PACKET_CRC_SIZE ||
+            Crc16(packet, length - PACKET_CRC_SIZE) !=
+                (packet[length - 2] | (packet[length - 1] << 8)))
+        {
+            // Corrupted or truncated: the next packet starts after this delimiter
+            skipped += level + 1;
+            bad_packets += (level > 0);
+            delta_chain = 0;
+            level = 0;
+            continue;
+        }
+
+        uint16_t sequence = packet[0] | (packet[1] << 8);
+
+        if (packet[2] == PACKET_LOG)
+        {
+            // Numbered apart from the samples: the gaps are lost records
+            static uint16_t next_record = 0;
+
+            lost_records += log_records ? (uint16_t)(sequence - next_record) : 0;
+            next_record = sequence + 1;
+            bad_packets += !PrintLog(packet[3], &packet[PACKET_HEADER_SIZE],
+                                     length - PACKET_HEADER_SIZE - PACKET_CRC_SIZE);
+            level = 0;
+            continue;
+        }
+
+        int flags = packet[2] & ~PACKET_COUNT_MASK;
+        int count = packet[2] & PACKET_COUNT_MASK;
+        int axes = packet[3];
+        int axis_count = AxisCount(axes);
+        const uint8_t* body = &packet[PACKET_HEADER_SIZE];
+        int body_length = length - PACKET_HEADER_SIZE - PACKET_CRC_SIZE;
+        int in_sequence = synced && sequence == next_sequence;
+
+        if (synced)
+        {
+            lost_samples += (uint16_t)(sequence - next_sequence);
+        }
+        next_sequence = sequence + count;
+        synced = 1;
+
+        if (packet[2] == PACKET_TELEMETRY)
+        {
+            // Between two data packets: the delta chain goes on
+            bad_packets += !PrintTelemetry(sequence, body, body_length);
+        }
+        else if (axes == 0 || axes > AXES_ALL)
+        {
+            bad_packets++;
+            delta_chain = 0;
+        }
+        else if (flags == PACKET_PACKED)
+        {
+            bad_packets += !DecodePacked(body, body_length, count, axis_count);
+        }
+        else if (!(flags & PACKET_DELTA))
+        {
+            if (body_length == count * axis_count * ValueSize())
+            {
+                PrintSamples(body, count, axis_count);
+            }
+            else
+            {
+                bad_packets++;
+            }
+        }
+        else if (!(flags & PACKET_KEYFRAME) && !(delta_chain && in_sequence && axes == delta_axes))
+        {
+            // The previous sample is missing: wait for the next keyframe
+            lost_samples += count;
+            delta_chain = 0;
+        }
+        else
+        {
+            delta_chain = DecodeDelta(body, body_length, count, axis_count, flags & PACKET_KEYFRAME);
+            delta_axes = axes;
+            bad_packets += !delta_chain;
+        }
+        level = 0;
+    }
+    skipped += level;
+}
+
+int main(int argc, char** argv)
+{
+    FILE* input = stdin;
+    uint8_t frame[FRAME_MAX_SIZE];
+    int level = 0;
+    int cobs = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-p") && i + 1 < argc)
+        {
+            format = (atoi(argv[++i]) == 3) ? VALUE_FLOAT : VALUE_INT16;
+        }
+        else if (!strcmp(argv[i], "-q"))
+        {
+            format = VALUE_Q16_16;
+        }
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+        {
+            frame_samples = atoi(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-a") && i + 1 < argc)
+        {
+            const char* axis = argv[++i];
+
+            frame_axes = 0;
+            for (; *axis; axis++)
+            {
+                frame_axes |= (*axis == 'x') ? 1 : (*axis == 'y') ? 2 : (*axis == 'z') ? 4 : 0;
+            }
+        }
+        else if (!strcmp(argv[i], "-c"))
+        {
+            cobs = 1;
+        }
+        else if (!strcmp(argv[i], "-l"))
+        {
+            return CheckLogTable(1) ? 0 : 1;
+        }
+        else if ((input = fopen(argv[i], "rb")) == NULL)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+    }
+
+    if (cobs)
+    {
+        if (!CheckLogTable(0))
+        {
+            return 1;
+        }
+        DecodePackets(input);
+        fprintf(stderr, "%lu packets, %lu samples, %lu samples lost, %lu bad packets, %lu bytes skipped, "
+                "%lu telemetry packets, %lu log records, %lu log records lost\n", frames, samples, lost_samples,
+                bad_packets, skipped, telemetry_packets, log_records, lost_records);
+        return 0;
+    }
+
+    int header_size = (frame_samples > 1) ? 2 : 1;
+    int axis_count = AxisCount(frame_axes);
+    int sample_size = axis_count * ValueSize();
+    int frame_size = header_size + frame_samples * sample_size + 1;
+
+    if (frame_samples < 1 || frame_size > FRAME_MAX_SIZE)
+    {
+        fprintf(stderr, "invalid number of samples per frame\n");
+        return 1;
+    }
+    if (axis_count == 0)
+    {
+        fprintf(stderr, "invalid axes\n");
+        return 1;
+    }
+
+    int c;
+    while ((c = fgetc(input)) != EOF)
+    {
+        frame[level++] = (uint8_t)c;
+        if (level < frame_size)
+        {
+            continue;
+        }
+
+        if (frame[0] == FRAME_HEADER && frame[frame_size - 1] == FRAME_TAIL &&
+            (header_size == 1 || frame[1] == frame_samples))
+        {
+            PrintSamples(&frame[header_size], frame_samples, axis_count);
+            level = 0;
+        }
+        else
+        {
+            // Out of sync: drop one byte and look for the next header
+            int next = 1;
+            while (next < level && frame[next] != FRAME_HEADER)
+            {
+                next++;
+            }
+            skipped += next;
+            level -= next;
+            memmove(frame, &frame[next], level);
+        }
+    }
+
+    fprintf(stderr, "%lu frames, %lu samples, %lu bytes skipped\n", frames, samples, skipped);
+    return 0;
+}
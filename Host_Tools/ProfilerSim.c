@@ -0,0 +1,205 @@
+/**
+ * \file ProfilerSim.c
+ * \brief Host run of the loop profiler against a simulated clock.
+ *
+ * Compiles Profiler.c of the firmware on the PC (HOST_BUILD, see
+ * Host_Tools/Sim) and drives its hooks as the acquisition loop of main.c
+ * does, with stage durations taken from a model of the loop:
+ *   - wait: TX drain, plus the bursts which find no new sample before it
+ *     is ready (back-to-back polling);
+ *   - read: status + 3 axes burst, 10 bytes at the I2C clock;
+ *   - convert: fixed cost per sample, FRAME_SAMPLES samples per frame;
+ *   - send: sealing and queueing of the frame.
+ * Every duration has a random jitter (fixed seed, so runs are repeatable).
+ * After the iterations the dump command is sent and the table is printed
+ * as the firmware sends it. The program checks that the cycles of the
+ * stages add up to the iterations and that every histogram holds all the
+ * iterations of its stage, and exits with 1 otherwise.
+ *
+ * Build: gcc -std=c99 -O2 -DHOST_BUILD -DUSE_PROFILER=1 -ISim
+ *            -I../AY1920_II_HW_05_PROJ_2.cydsn -o ProfilerSim ProfilerSim.c
+ *            ../AY1920_II_HW_05_PROJ_2.cydsn/Profiler.c ../AY1920_II_HW_05_PROJ_2.cydsn/Log.c
+ * Usage: ProfilerSim [-n iterations] [-f cpu_hz] [-i i2c_hz] [-s frame_samples]
+ *        -n    loop iterations (default 1000)
+ *        -f    CPU clock (default 24000000)
+ *        -i    I2C clock (default 100000)
+ *        -s    samples per frame (default 1)
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Profiler.h"
+#include "project.h"
+
+#define ODR_HZ 100
+#define READ_BYTES 10           // Status and 3 axes burst: 2 addresses, register, 7 data bytes
+#define CONVERT_CYCLES 180      // Per sample
+#define SEND_CYCLES 420         // Per frame
+#define DRAIN_CYCLES 60
+#define JITTER_PERCENT 10
+
+static uint32_t clock_cycles = 0;
+static int dump_requested = 0;
+
+uint32_t HostClock_Cycles(void)
+{
+    return clock_cycles;
+}
+
+void UART_Debug_Start(void)
+{
+}
+
+void UART_Debug_PutChar(uint8 data)
+{
+    // The packet delimiter is not printed
+    if (data != 0)
+    {
+        putchar(data);
+    }
+}
+
+void UART_Debug_PutString(const char* string)
+{
+    fputs(string, stdout);
+}
+
+void UART_Debug_PutArray(const uint8* data, uint8 length)
+{
+    while (length--)
+    {
+        UART_Debug_PutChar(*data++);
+    }
+}
+
+uint8 UART_Debug_GetChar(void)
+{
+    if (dump_requested)
+    {
+        dump_requested = 0;
+        return PROFILER_DUMP_COMMAND;
+    }
+    return 0;
+}
+
+void TxQueue_Flush(void)
+{
+}
+
+/* Advance the simulated clock by 'cycles', give or take JITTER_PERCENT */
+static void Spend(uint32_t cycles)
+{
+    uint32_t jitter = cycles * JITTER_PERCENT / 100;
+
+    clock_cycles += cycles - jitter + (jitter ? (uint32_t)rand() % (2 * jitter + 1) : 0);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned long iterations = 1000, cpu_hz = 24000000, i2c_hz = 100000;
+    int frame_samples = 1, frame_level = 0;
+    Profiler_Entry entries[PROFILER_STAGES + 1];
+    uint64_t stage_sum = 0;
+    int failed = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+        {
+            iterations = strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc)
+        {
+            cpu_hz = strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-i") && i + 1 < argc)
+        {
+            i2c_hz = strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+        {
+            frame_samples = atoi(argv[++i]);
+        }
+    }
+    if (iterations == 0 || cpu_hz == 0 || i2c_hz == 0 || frame_samples < 1)
+    {
+        fprintf(stderr, "usage: ProfilerSim [-n iterations] [-f cpu_hz] [-i i2c_hz] [-s frame_samples]\n");
+        return 1;
+    }
+
+    // 9 bits per byte on the bus
+    uint32_t byte_cycles = (uint32_t)((9ULL * cpu_hz) / i2c_hz);
+    uint32_t period_cycles = cpu_hz / ODR_HZ;
+    uint32_t next_ready = period_cycles;
+
+    srand(1);
+    Profiler_Start();
+    for (unsigned long n = 0; n <= iterations; n++)
+    {
+        // The last pass only closes the last iteration
+        PROFILER_POLL();
+        PROFILER_LOOP();
+        if (n == iterations)
+        {
+            break;
+        }
+
+        // Empty bursts up to the next data ready (a late loop reads the last one)
+        Spend(DRAIN_CYCLES);
+        while (clock_cycles < next_ready)
+        {
+            Spend(byte_cycles * READ_BYTES);
+        }
+        while (next_ready <= clock_cycles)
+        {
+            next_ready += period_cycles;
+        }
+
+        PROFILER_ENTER(PROFILER_STAGE_READ);
+        Spend(byte_cycles * READ_BYTES);
+
+        PROFILER_ENTER(PROFILER_STAGE_CONVERT);
+        Spend(CONVERT_CYCLES);
+        if (++frame_level == frame_samples)
+        {
+            PROFILER_ENTER(PROFILER_STAGE_SEND);
+            Spend(SEND_CYCLES);
+            frame_level = 0;
+        }
+    }
+
+    for (int i = 0; i <= PROFILER_STAGES; i++)
+    {
+        uint32_t binned = 0;
+
+        Profiler_GetEntry(i, &entries[i]);
+        for (int b = 0; b < PROFILER_BINS; b++)
+        {
+            binned += entries[i].bins[b];
+        }
+        if (binned != entries[i].count)
+        {
+            fprintf(stderr, "stage %d: %lu iterations in the histogram, %lu counted\n",
+                    i, (unsigned long)binned, (unsigned long)entries[i].count);
+            failed = 1;
+        }
+        stage_sum += (i < PROFILER_STAGES) ? entries[i].sum : 0;
+    }
+    if (entries[PROFILER_STAGES].count != iterations || stage_sum != entries[PROFILER_STAGES].sum)
+    {
+        fprintf(stderr, "%lu iterations of %llu cycles, stages add up to %llu cycles\n",
+                (unsigned long)entries[PROFILER_STAGES].count,
+                (unsigned long long)entries[PROFILER_STAGES].sum, (unsigned long long)stage_sum);
+        failed = 1;
+    }
+
+    dump_requested = 1;
+    PROFILER_POLL();
+
+    fprintf(stderr, "%lu iterations, %lu cycles simulated, %s\n", iterations,
+            (unsigned long)clock_cycles, failed ? "FAILED" : "stage sums consistent");
+    return failed;
+}
@@ -0,0 +1,297 @@
+/**
+ * \file Replay.c
+ * \brief Replay of recorded samples through the firmware, on the host.
+ *
+ * Compiles all the sources of PROJ_2 (or PROJ_3), main.c included, with the
+ * simulator of Host_Tools/Sim, as AcquisitionSim does, but the LIS3DH model
+ * gives the samples of a recording instead of its own signal (see
+ * LIS3DH_MODEL_SIGNAL_TRACE). The samples are read, converted, framed and
+ * sent by the unmodified code of main.c at the output data rate the
+ * firmware sets up, so that filters, compression and the frame formats
+ * can be tried on real data. The recording is one of:
+ *   - raw bursts: 6 bytes per sample, OUT_X_L..OUT_Z_H as read from the
+ *     sensor, replayed as they are (recorded with the same profile);
+ *   - a Bridge Control Panel log: text, one sample per line, the last 3
+ *     numbers of the line are X, Y and Z in mg (PROJ_2 frames) or in m/s2
+ *     (PROJ_3 frames, -m), turned back into digits at the resolution and
+ *     full scale of the firmware; the other lines are skipped.
+ * By default the virtual time runs as fast as the PC can (several hundred
+ * times real time with USE_INT1 or ACQ_MODE_FIFO, where the CPU sleeps
+ * between the samples; back-to-back polling simulates every poll and is
+ * much slower); -x paces it to the wall clock (1 is real time).
+ * The bytes sent on the UART are written to the output file: the same
+ * recording through the same firmware gives the same bytes, and their
+ * CRC-32 is printed for regression checks. Once the recording is over, the
+ * run goes on for the drain time so that the last frames are sent.
+ *
+ * Build: gcc -std=c99 -O2 -DHOST_BUILD -Dmain=Firmware_Main -ISim
+ *            -I../AY1920_II_HW_05_PROJ_2.cydsn -o Replay Replay.c
+ *            Sim/Sim.c Sim/LIS3DH_Model.c ../AY1920_II_HW_05_PROJ_2.cydsn/[A-Z]*.c
+ *            ../AY1920_II_HW_05_PROJ_2.cydsn/main.c -lm
+ * Usage: Replay (-r bursts | -l log [-m]) [-o file] [-x speed] [-i i2c_hz] [-b baud]
+ *               [-d drain] [-t limit]
+ *        -r    raw bursts (binary)
+ *        -l    Bridge Control Panel log (text), values in mg
+ *        -m    the values of the log are in m/s2
+ *        -o    bytes sent on the UART (input of FrameDecoder)
+ *        -x    paced: virtual seconds per wall clock second (default: as fast as possible)
+ *        -i    I2C clock (default 400000)
+ *        -b    UART bit rate (default 921600, so that the link drops no frame)
+ *        -d    virtual time after the end of the recording (default 1 s)
+ *        -t    longest virtual time (default 100000 s)
+ *
+ * \Author Marco Sinatra
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Sim.h"
+#include "macro_definition.h"
+#include "project.h"
+
+#undef main
+
+#define BURST_SIZE 6            // OUT_X_L..OUT_Z_H
+#define LINE_SIZE 256
+#define GRAVITY 9.81            // m/s2 per g, as CONVERSION_GRAVITY of PROJ_3
+
+int Firmware_Main(void);
+
+static FILE* recording;
+static int text_log;
+static int log_ms2;
+static double speed;            // 0: as fast as possible
+static double drain = 1.0;
+static uint64_t replayed;
+static uint64_t lines_skipped;
+static double wall_start;
+static FILE* output;
+static uint64_t output_bytes;
+static uint32_t output_crc = 0xFFFFFFFFu;
+
+static double Replay_WallClock(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Next line of the log with at least 3 numbers: the last 3
+static int Replay_LogSample(double value[3])
+{
+    char line[LINE_SIZE];
+
+    while (fgets(line, sizeof(line), recording) != NULL)
+    {
+        double numbers[3];
+        int count = 0;
+        char* cursor = line;
+
+        while (*cursor)
+        {
+            char* end;
+            double number = strtod(cursor, &end);
+
+            if (end == cursor)
+            {
+                cursor++;
+                continue;
+            }
+            numbers[count % 3] = number;
+            count++;
+            cursor = end;
+        }
+        if (count < 3)
+        {
+            lines_skipped++;
+            continue;
+        }
+        for (int axis = 0; axis < 3; axis++)
+        {
+            value[axis] = numbers[(count - 3 + axis) % 3];
+        }
+        return 1;
+    }
+    return 0;
+}
+
+// Output registers of the next sample (trace of the LIS3DH model)
+static int Replay_Trace(uint8_t* out, const LIS3DH_Model_Format* format)
+{
+    if (!text_log)
+    {
+        if (fread(out, 1, BURST_SIZE, recording) != BURST_SIZE)
+        {
+            Sim_Stop(drain);
+            return 0;
+        }
+    }
+    else
+    {
+        double value[3];
+        long limit = 1L << (format->bits - 1);
+
+        if (!Replay_LogSample(value))
+        {
+            Sim_Stop(drain);
+            return 0;
+        }
+        for (int axis = 0; axis < 3; axis++)
+        {
+            double mg = log_ms2 ? value[axis] * 1000.0 / GRAVITY : value[axis];
+            long digits = lround(mg / format->mg_per_digit);
+            uint16_t register_value;
+
+            digits = (digits >= limit) ? limit - 1 : (digits < -limit) ? -limit : digits;
+            register_value = (uint16_t)((unsigned long)digits << (16 - format->bits));
+            out[2 * axis] = (uint8_t)register_value;
+            out[2 * axis + 1] = (uint8_t)(register_value >> 8);
+        }
+    }
+    replayed++;
+
+    // Paced mode: wait for the wall clock to catch up with the virtual time
+    if (speed > 0)
+    {
+        double ahead = Sim_Time() / speed - (Replay_WallClock() - wall_start);
+
+        if (ahead > 0.001)
+        {
+            struct timespec wait = {(time_t)ahead, (long)((ahead - (time_t)ahead) * 1e9)};
+
+            nanosleep(&wait, NULL);
+        }
+    }
+    return 1;
+}
+
+// Byte sent on the UART: output file and CRC-32 (reflected, polynomial 0x04C11DB7)
+static void Replay_Monitor(uint8_t data, uint64_t cycle)
+{
+    (void)cycle;
+    if (output != NULL)
+    {
+        fputc(data, output);
+    }
+    output_bytes++;
+    output_crc ^= data;
+    for (int bit = 0; bit < 8; bit++)
+    {
+        output_crc = (output_crc >> 1) ^ (0xEDB88320u & -(output_crc & 1u));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Sim_Config config = {
+        .seconds = 100000,
+        .i2c_hz = 400000,
+        .baud = 921600,
+        .timer_hz = POLL_TIMER_CLOCK_HZ,
+        .sensor = {.boot_us = 5000, .signal = LIS3DH_MODEL_SIGNAL_TRACE, .trace = Replay_Trace},
+        .seed = 1,
+        .monitor = Replay_Monitor,
+    };
+    const char* recording_name = NULL;
+    const char* output_name = NULL;
+    int usage = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((!strcmp(argv[i], "-r") || !strcmp(argv[i], "-l")) && i + 1 < argc)
+        {
+            text_log = !strcmp(argv[i], "-l");
+            recording_name = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-m"))
+        {
+            log_ms2 = 1;
+        }
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+        {
+            output_name = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-x") && i + 1 < argc)
+        {
+            speed = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-i") && i + 1 < argc)
+        {
+            config.i2c_hz = strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+        {
+            config.baud = strtoul(argv[++i], NULL, 0);
+        }
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc)
+        {
+            drain = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc)
+        {
+            config.seconds = atof(argv[++i]);
+        }
+        else
+        {
+            usage = 1;
+            break;
+        }
+    }
+    if (usage || recording_name == NULL || config.seconds <= 0 || config.i2c_hz == 0 || config.baud == 0)
+    {
+        fprintf(stderr, "usage: Replay (-r bursts | -l log [-m]) [-o file] [-x speed] [-i i2c_hz] [-b baud]\n"
+                        "              [-d drain] [-t limit]\n");
+        return 1;
+    }
+    if ((recording = fopen(recording_name, text_log ? "r" : "rb")) == NULL)
+    {
+        perror(recording_name);
+        return 1;
+    }
+    if (output_name != NULL && (output = fopen(output_name, "wb")) == NULL)
+    {
+        perror(output_name);
+        return 1;
+    }
+
+    wall_start = Replay_WallClock();
+    if (Sim_Run(&config, Firmware_Main))
+    {
+        fprintf(stderr, "The firmware returned from main()\n");
+    }
+    double wall = Replay_WallClock() - wall_start;
+
+    fclose(recording);
+    if (output != NULL)
+    {
+        fclose(output);
+    }
+
+    Sim_Stats sim;
+    LIS3DH_Model_Stats sensor;
+    LIS3DH_Model_Format format;
+    uint32_t pending;
+    double seconds;
+
+    Sim_GetStats(&sim);
+    LIS3DH_Model_GetStats(&sensor, &pending);
+    LIS3DH_Model_GetFormat(&format);
+    seconds = (double)sim.cycles / BCLK__BUS_CLK__HZ;
+
+    printf("recording: %llu samples replayed at %g Hz, %d bits (%llu lines skipped)\n",
+           (unsigned long long)replayed, format.odr_hz, format.bits, (unsigned long long)lines_skipped);
+    printf("sensor:    %llu read, %llu lost, %lu unread\n",
+           (unsigned long long)sensor.read, (unsigned long long)sensor.lost, (unsigned long)pending);
+    printf("output:    %llu bytes, CRC-32 0x%08lX, %llu bytes into a full TX FIFO\n",
+           (unsigned long long)output_bytes, (unsigned long)(output_crc ^ 0xFFFFFFFFu),
+           (unsigned long long)sim.uart_overflows);
+    printf("speed:     %.3f s of virtual time in %.3f s (x%.1f), %.0f samples/s processed\n",
+           seconds, wall, wall > 0 ? seconds / wall : 0.0, wall > 0 ? sensor.read / wall : 0.0);
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+ * \file FrameTrace.c
+ * \brief Host build of the firmware modules: frames on the link traced back to their samples.
+ *
+ * See FrameTrace.h.
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <math.h>
+#include <string.h>
+#include "FrameTrace.h"
+#include "Sim.h"
+
+#define FRAME_HEADER 0xA0
+#define FRAME_TAIL 0xC0
+#define FRAME_MAX_SIZE 14
+#define GRAVITY 9.81            // m/s2 per g, as CONVERSION_GRAVITY of PROJ_3
+
+static const int frame_sizes[4] = {4, 8, 14, 14};
+
+static FrameTrace_Format format;
+static uint8_t frame[FRAME_MAX_SIZE];
+static int frame_level;
+static uint64_t last;           // Number of the last sample delivered
+static FrameTrace_Stats trace;
+
+// Digits of an axis, back from the value in the frame
+static unsigned long FrameTrace_Digits(const uint8_t* value, double mg_per_digit)
+{
+    if (format == FRAME_TRACE_INT16)
+    {
+        int16_t mg = (int16_t)(value[0] | (value[1] << 8));
+
+        return (unsigned long)lround(mg / mg_per_digit);
+    }
+    double ms2;
+
+    if (format == FRAME_TRACE_FLOAT)
+    {
+        float value_f;
+
+        memcpy(&value_f, value, sizeof(value_f));
+        ms2 = value_f;
+    }
+    else
+    {
+        ms2 = (int32_t)((uint32_t)value[0] | ((uint32_t)value[1] << 8) | ((uint32_t)value[2] << 16) |
+                        ((uint32_t)value[3] << 24)) / 65536.0;
+    }
+    return (unsigned long)lround(ms2 * 1000.0 / (GRAVITY * mg_per_digit));
+}
+
+// A whole frame: number of its sample, latency
+static void FrameTrace_Frame(uint64_t cycle)
+{
+    uint64_t sequence = LIS3DH_Model_GetSequence();
+    uint64_t residue;
+    uint64_t modulus;
+    uint64_t number;
+    uint64_t data_ready;
+
+    trace.frames++;
+    if (format == FRAME_TRACE_TEMPERATURE)
+    {
+        // 8 bits left-justified, right-justified on 10 bits by the firmware
+        residue = ((uint16_t)(frame[1] | (frame[2] << 8)) >> 2) & 0xFF;
+        modulus = 256;
+    }
+    else
+    {
+        LIS3DH_Model_Format output;
+        int size = (format == FRAME_TRACE_INT16) ? 2 : 4;
+
+        LIS3DH_Model_GetFormat(&output);
+        unsigned long mask = (1UL << output.bits) - 1;
+        unsigned long x = FrameTrace_Digits(&frame[1], output.mg_per_digit) & mask;
+        unsigned long y = FrameTrace_Digits(&frame[1 + size], output.mg_per_digit) & mask;
+        unsigned long z = FrameTrace_Digits(&frame[1 + 2 * size], output.mg_per_digit) & mask;
+
+        if (x != z)
+        {
+            trace.torn++;
+        }
+        residue = x | ((uint64_t)y << output.bits);
+        modulus = 1ULL << (2 * output.bits);
+    }
+    if (sequence == 0)
+    {
+        trace.untraced++;
+        return;
+    }
+    // The last sample produced with those bits
+    number = (sequence - 1) - (((sequence - 1) - residue) & (modulus - 1));
+    if (number > sequence - 1 || (data_ready = LIS3DH_Model_GetSampleTime(number)) == UINT64_MAX)
+    {
+        trace.untraced++;
+        return;
+    }
+    if (trace.samples && number <= last)
+    {
+        trace.duplicates++;
+        return;
+    }
+    if (trace.samples == 0)
+    {
+        Sim_Stats sim;
+
+        Sim_GetStats(&sim);
+        trace.first_cycle = cycle;
+        trace.first_awake = sim.awake_cycles;
+    }
+    else
+    {
+        trace.missing += number - last - 1;
+    }
+    trace.samples++;
+    last = number;
+    trace.latency_sum += cycle - data_ready;
+    if (cycle - data_ready > trace.latency_max)
+    {
+        trace.latency_max = cycle - data_ready;
+    }
+}
+
+void FrameTrace_Start(FrameTrace_Format value_format)
+{
+    format = value_format;
+    frame_level = 0;
+    last = 0;
+    memset(&trace, 0, sizeof(trace));
+}
+
+void FrameTrace_Monitor(uint8_t data, uint64_t cycle)
+{
+    int size = frame_sizes[format];
+
+    if (frame_level == 0 && data != FRAME_HEADER)
+    {
+        return;
+    }
+    frame[frame_level++] = data;
+    if (frame_level < size)
+    {
+        return;
+    }
+    if (frame[size - 1] == FRAME_TAIL)
+    {
+        FrameTrace_Frame(cycle);
+        frame_level = 0;
+        return;
+    }
+    // Not a frame: look for the next header within the bytes received
+    int start = 1;
+
+    while (start < size && frame[start] != FRAME_HEADER)
+    {
+        start++;
+    }
+    memmove(frame, &frame[start], size - start);
+    frame_level = size - start;
+}
+
+void FrameTrace_GetStats(FrameTrace_Stats* stats)
+{
+    *stats = trace;
+}
+
+/* [] END OF FILE */
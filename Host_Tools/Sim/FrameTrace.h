@@ -0,0 +1,73 @@
+/**
+ * \file FrameTrace.h
+ * \brief Host build of the firmware modules: frames on the link traced back to their samples.
+ *
+ * With the sequence signal of the LIS3DH model (see LIS3DH_Model.h) every
+ * sample carries its number: the frames leaving the UART (0xA0 header,
+ * one sample, 0xC0 tail, resynchronised on the header and the tail) are
+ * decoded in the value format of the project and traced back to the
+ * sample they carry, so that the firmware is checked end to end:
+ *   - samples: distinct samples delivered, in order;
+ *   - missing: samples produced between the first and the last delivered
+ *     ones and never delivered (overwritten in the sensor, dropped by the
+ *     transmit ring, refused as torn or skipped by design);
+ *   - duplicates: frames carrying a sample already delivered (read twice);
+ *   - torn: frames whose X and Z come from two different samples;
+ *   - untraced: frames whose sample is not among the last 2^(2 x bits)
+ *     ones produced (256 for the temperature of PROJ_1), or older than
+ *     the history of the model;
+ *   - latency: from the data ready of a sample to the stop bit of the last
+ *     byte of its frame.
+ * FrameTrace_Monitor() is the monitor of the simulator (see Sim_Config).
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef FRAME_TRACE_H
+    #define FRAME_TRACE_H
+
+    #include <stdint.h>
+
+    /**
+    *   \brief Values of the frames.
+    */
+    typedef enum {
+        FRAME_TRACE_TEMPERATURE,    ///< PROJ_1: 2 bytes, right-justified temperature
+        FRAME_TRACE_INT16,          ///< PROJ_2: 2 bytes per axis, mg
+        FRAME_TRACE_FLOAT,          ///< PROJ_3: 4 bytes per axis, float m/s2
+        FRAME_TRACE_Q16             ///< PROJ_3 with OUTPUT_FORMAT_Q16_16: 4 bytes per axis, Q16.16 m/s2
+    } FrameTrace_Format;
+
+    /**
+    *   \brief Trace of the frames received.
+    */
+    typedef struct {
+        uint64_t frames;            ///< Frames received
+        uint64_t samples;           ///< Distinct samples delivered
+        uint64_t missing;           ///< Samples between the first and the last delivered ones, not delivered
+        uint64_t duplicates;        ///< Frames of a sample already delivered
+        uint64_t torn;              ///< Frames with X and Z of two samples
+        uint64_t untraced;          ///< Frames not traced back to a sample
+        uint64_t first_cycle;       ///< Stop bit of the frame of the first sample delivered
+        uint64_t first_awake;       ///< CPU awake at that time (see Sim_Stats)
+        uint64_t latency_sum;       ///< Cycles from the data ready to the stop bit, summed
+        uint64_t latency_max;       ///< Longest one
+    } FrameTrace_Stats;
+
+    /**
+    *   \brief Start a trace: no frame received.
+    */
+    void FrameTrace_Start(FrameTrace_Format format);
+
+    /**
+    *   \brief Byte sent on the UART and end of its stop bit.
+    */
+    void FrameTrace_Monitor(uint8_t data, uint64_t cycle);
+
+    /**
+    *   \brief Get the trace of the frames received.
+    */
+    void FrameTrace_GetStats(FrameTrace_Stats* stats);
+
+#endif // FRAME_TRACE_H
+/* [] END OF FILE */
@@ -0,0 +1,68 @@
+/**
+ * \file I2C_Master.h
+ * \brief Host build of the firmware modules: I2C_Master component.
+ *
+ * Stands for the I2C_Master.h generated by PSoC Creator (HOST_BUILD): the
+ * manual (byte by byte) and the interrupt-driven (MasterWriteBuf and
+ * MasterReadBuf) master functions and their return values, implemented by
+ * the simulator (see Sim.h).
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef I2C_MASTER_H
+    #define I2C_MASTER_H
+    
+    #include "cytypes.h"
+    
+    /**
+    *   \brief Direction of the transfer and acknowledge of the bytes read.
+    */
+    #define I2C_Master_WRITE_XFER_MODE 0x00
+    #define I2C_Master_READ_XFER_MODE 0x01
+    #define I2C_Master_ACK_DATA 0x01
+    #define I2C_Master_NAK_DATA 0x00
+    
+    /**
+    *   \brief Modes of MasterWriteBuf() and MasterReadBuf().
+    */
+    #define I2C_Master_MODE_COMPLETE_XFER 0x00
+    #define I2C_Master_MODE_REPEAT_START 0x01
+    #define I2C_Master_MODE_NO_STOP 0x02
+    
+    /**
+    *   \brief Errors of the master functions.
+    */
+    #define I2C_Master_MSTR_NO_ERROR 0x00
+    #define I2C_Master_MSTR_BUS_BUSY 0x01
+    #define I2C_Master_MSTR_NOT_READY 0x02
+    #define I2C_Master_MSTR_ERR_LB_NAK 0x03
+    #define I2C_Master_MSTR_ERR_ARB_LOST 0x04
+    #define I2C_Master_MSTR_ERR_ABORT_START_GEN 0x05
+    
+    /**
+    *   \brief Bits of MasterStatus().
+    */
+    #define I2C_Master_MSTAT_RD_CMPLT 0x01
+    #define I2C_Master_MSTAT_WR_CMPLT 0x02
+    #define I2C_Master_MSTAT_XFER_INP 0x04
+    #define I2C_Master_MSTAT_XFER_HALT 0x08
+    #define I2C_Master_MSTAT_ERR_SHORT_XFER 0x10
+    #define I2C_Master_MSTAT_ERR_ADDR_NAK 0x20
+    #define I2C_Master_MSTAT_ERR_ARB_LOST 0x40
+    #define I2C_Master_MSTAT_ERR_XFER 0x80
+    
+    void I2C_Master_Start(void);
+    void I2C_Master_Stop(void);
+    uint8 I2C_Master_MasterSendStart(uint8 slaveAddress, uint8 R_nW);
+    uint8 I2C_Master_MasterSendRestart(uint8 slaveAddress, uint8 R_nW);
+    uint8 I2C_Master_MasterSendStop(void);
+    uint8 I2C_Master_MasterWriteByte(uint8 theByte);
+    uint8 I2C_Master_MasterReadByte(uint8 acknNak);
+    uint8 I2C_Master_MasterWriteBuf(uint8 slaveAddress, uint8* wrData, uint8 cnt, uint8 mode);
+    uint8 I2C_Master_MasterReadBuf(uint8 slaveAddress, uint8* rdData, uint8 cnt, uint8 mode);
+    uint8 I2C_Master_MasterStatus(void);
+    uint8 I2C_Master_MasterClearStatus(void);
+
+#endif // I2C_MASTER_H
+/* [] END OF FILE */
@@ -0,0 +1,608 @@
+/**
+ * \file LIS3DH_Model.c
+ * \brief Host build of the firmware modules: LIS3DH register model.
+ *
+ * See LIS3DH_Model.h.
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <math.h>
+#include <string.h>
+#include "LIS3DH_Model.h"
+
+#define REG_STATUS_REG_AUX 0x07
+#define REG_OUT_ADC1_L 0x08
+#define REG_OUT_ADC3_L 0x0C
+#define REG_OUT_ADC3_H 0x0D
+#define REG_WHO_AM_I 0x0F
+#define REG_TEMP_CFG_REG 0x1F
+#define REG_CTRL_REG1 0x20
+#define REG_CTRL_REG3 0x22
+#define REG_CTRL_REG4 0x23
+#define REG_CTRL_REG5 0x24
+#define REG_STATUS_REG 0x27
+#define REG_OUT_X_L 0x28
+#define REG_OUT_Z_H 0x2D
+#define REG_FIFO_CTRL_REG 0x2E
+#define REG_FIFO_SRC_REG 0x2F
+#define REG_COUNT 0x40
+
+#define WHO_AM_I_VALUE 0x33
+#define TEMP_CFG_ENABLE 0xC0        // ADC_EN and TEMP_EN
+#define TEMPERATURE_DIGITS 5        // Temperature output (1 digit/degC, relative)
+#define CTRL_REG1_DEFAULT 0x07      // Power-down, all the axes enabled
+#define CTRL_REG1_LPEN 0x08
+#define CTRL_REG3_I1_ZYXDA 0x10
+#define CTRL_REG3_I1_WTM 0x04
+#define CTRL_REG3_I1_OVERRUN 0x02
+#define CTRL_REG4_BDU 0x80
+#define CTRL_REG4_HR 0x08
+#define CTRL_REG5_FIFO_EN 0x40
+#define STATUS_ZYXDA 0x08
+#define STATUS_ZYXOR 0x80
+#define STATUS_AUX_3DA 0x04
+#define STATUS_AUX_3OR 0x40
+#define FIFO_MODE_FIFO 0x40
+#define FIFO_MODE_STREAM 0x80
+#define FIFO_MODE_MASK 0xC0
+#define FIFO_FTH_MASK 0x1F
+#define FIFO_SRC_WTM 0x80
+#define FIFO_SRC_OVRN 0x40
+#define FIFO_SRC_EMPTY 0x20
+#define FIFO_SIZE 32
+#define SAMPLE_SIZE 6
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+static LIS3DH_Model_Config config;
+static uint64_t now;
+static uint8_t regs[REG_COUNT];
+static uint8_t address;                 // Register of the next data byte
+static uint8_t increment;               // Address auto-increment (MSB of the register address)
+
+static double period;                   // Cycles per sample, 0 in power-down mode
+static uint64_t origin;                 // Cycle of the last change of the data rate
+static uint64_t ticks;                  // Samples since 'origin'
+static uint64_t next_sample = UINT64_MAX;
+static int trace_over;                  // End of the recording (LIS3DH_MODEL_SIGNAL_TRACE)
+
+static uint8_t next_out[SAMPLE_SIZE];   // Sample held back by BDU
+static int held;                        // Output registers held (BDU): a sample is being read
+static uint8_t held_read;               // Axes whose high byte was read since the hold began
+static uint8_t held_update;             // Axes with a sample held back
+static uint64_t sample_time;            // Data ready of the last sample (FIFO disabled)
+static uint8_t unread;                  // Its axes not read yet (in next_out if held back)
+static uint64_t held_time;              // Data ready of the sample the held registers still show
+static uint8_t held_unread;             // Its axes not read yet
+
+static uint8_t fifo[FIFO_SIZE][SAMPLE_SIZE];
+static uint64_t fifo_time[FIFO_SIZE];
+static uint8_t fifo_head;
+static uint8_t fifo_level;
+
+static uint64_t sequence;               // Samples since the power-up
+static uint64_t sequence_time[LIS3DH_MODEL_HISTORY];
+
+static int counting;                    // First sample read: ground truth counted from now on
+static uint64_t last_read;              // Cycle of the last sample read
+static LIS3DH_Model_Stats stats;
+static uint32_t noise_state;
+
+// Uniform value in (0, 1), LCG of Numerical Recipes
+static double LIS3DH_Model_Uniform(void)
+{
+    noise_state = noise_state * 1664525u + 1013904223u;
+    return ((noise_state >> 8) + 0.5) / 16777216.0;
+}
+
+// Normal value (Box-Muller)
+static double LIS3DH_Model_Gaussian(void)
+{
+    double u = LIS3DH_Model_Uniform();
+    double v = LIS3DH_Model_Uniform();
+
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+// Output data rate of CTRL_REG1 (Hz), 0 in power-down mode
+static double LIS3DH_Model_Odr(void)
+{
+    static const double rates[16] = {0, 1, 10, 25, 50, 100, 200, 400, 1600, 1344};
+    uint8_t odr = regs[REG_CTRL_REG1] >> 4;
+    int low_power = (regs[REG_CTRL_REG1] & CTRL_REG1_LPEN) != 0;
+
+    if (odr == 8 && !low_power)
+    {
+        return 0;
+    }
+    return (odr == 9 && low_power) ? 5376 : rates[odr];
+}
+
+// Resolution of the samples: 8 bits in low power mode, 12 in high resolution mode
+static int LIS3DH_Model_Bits(void)
+{
+    if (regs[REG_CTRL_REG1] & CTRL_REG1_LPEN)
+    {
+        return 8;
+    }
+    return (regs[REG_CTRL_REG4] & CTRL_REG4_HR) ? 12 : 10;
+}
+
+static int LIS3DH_Model_FifoEnabled(void)
+{
+    return (regs[REG_CTRL_REG5] & CTRL_REG5_FIFO_EN) && (regs[REG_FIFO_CTRL_REG] & FIFO_MODE_MASK);
+}
+
+// New data rate: the first sample one period after the change
+static void LIS3DH_Model_Restart(void)
+{
+    double odr = LIS3DH_Model_Odr();
+
+    period = (odr && !trace_over) ? config.cpu_hz / odr * (1.0 + config.clock_ppm * 1e-6) : 0;
+    origin = now;
+    ticks = 0;
+    next_sample = period ? origin + (uint64_t)period : UINT64_MAX;
+}
+
+// Acceleration of the signal (mg) on an axis at a given cycle
+static double LIS3DH_Model_Signal(int axis, uint64_t cycle)
+{
+    double t = (double)cycle / config.cpu_hz;
+
+    switch (axis)
+    {
+        case 0: return 100.0 * sin(2.0 * M_PI * 2.0 * t);
+        case 1: return 50.0 * sin(2.0 * M_PI * 0.5 * t + 1.0);
+        default: return 1000.0;
+    }
+}
+
+static double LIS3DH_Model_MgPerDigit(void)
+{
+    static const int sensitivity[4] = {1, 2, 4, 12}; // mg/digit in high resolution mode
+
+    return sensitivity[(regs[REG_CTRL_REG4] >> 4) & 0x03] << (12 - LIS3DH_Model_Bits());
+}
+
+// Output registers of a sample: left-justified two's complement at the current resolution
+static void LIS3DH_Model_Sample(uint8_t* out, uint64_t cycle, uint64_t number)
+{
+    if (config.signal == LIS3DH_MODEL_SIGNAL_TRACE)
+    {
+        LIS3DH_Model_Format format;
+
+        LIS3DH_Model_GetFormat(&format);
+        trace_over = !config.trace(out, &format);
+        return;
+    }
+
+    int bits = LIS3DH_Model_Bits();
+    double mg_per_digit = LIS3DH_Model_MgPerDigit();
+    double noise_mg = config.noise_ug * 1e-3 * sqrt((config.noise_hz > 0) ? config.noise_hz : LIS3DH_Model_Odr() / 2.0);
+    long limit = 1L << (bits - 1);
+    unsigned long mask = (1UL << bits) - 1;
+
+    for (int axis = 0; axis < 3; axis++)
+    {
+        long digits = lround((LIS3DH_Model_Signal(axis, cycle) + noise_mg * LIS3DH_Model_Gaussian()) / mg_per_digit);
+        uint16_t value;
+
+        digits = (digits >= limit) ? limit - 1 : (digits < -limit) ? -limit : digits;
+        if (config.signal == LIS3DH_MODEL_SIGNAL_SEQUENCE)
+        {
+            // Low bits of the number on X and Z, the next ones on Y
+            digits = (long)((number >> ((axis == 1) ? bits : 0)) & mask);
+        }
+        value = (uint16_t)((unsigned long)digits << (16 - bits));
+        out[2 * axis] = (uint8_t)value;
+        out[2 * axis + 1] = (uint8_t)(value >> 8);
+    }
+}
+
+static void LIS3DH_Model_CountRead(uint64_t data_ready)
+{
+    uint64_t age = now - data_ready;
+
+    if (!counting)
+    {
+        // The samples still pending are counted too
+        counting = 1;
+        stats.produced = 1 + (unread != 0) + (held_unread != 0);
+    }
+    if (stats.read > 0)
+    {
+        uint64_t interval = now - last_read;
+
+        stats.interval_sum += interval;
+        stats.interval_sq_sum += (double)interval * interval;
+        if (interval > stats.interval_max)
+        {
+            stats.interval_max = interval;
+        }
+    }
+    last_read = now;
+    stats.read++;
+    stats.age_sum += age;
+    if (age > stats.age_max)
+    {
+        stats.age_max = age;
+    }
+}
+
+// Data ready: status bits, output registers (or FIFO), losses
+static void LIS3DH_Model_Produce(uint64_t cycle)
+{
+    uint8_t axes = regs[REG_CTRL_REG1] & 0x07;
+    uint8_t sample[SAMPLE_SIZE];
+    uint8_t status = regs[REG_STATUS_REG];
+
+    LIS3DH_Model_Sample(sample, cycle, sequence);
+    if (trace_over)
+    {
+        return;
+    }
+    sequence_time[sequence % LIS3DH_MODEL_HISTORY] = cycle;
+    if ((regs[REG_TEMP_CFG_REG] & TEMP_CFG_ENABLE) == TEMP_CFG_ENABLE)
+    {
+        regs[REG_OUT_ADC3_L] = 0;
+        regs[REG_OUT_ADC3_H] = (config.signal == LIS3DH_MODEL_SIGNAL_SEQUENCE) ? (uint8_t)sequence : TEMPERATURE_DIGITS;
+        if (regs[REG_STATUS_REG_AUX] & STATUS_AUX_3DA)
+        {
+            regs[REG_STATUS_REG_AUX] |= STATUS_AUX_3OR;
+        }
+        regs[REG_STATUS_REG_AUX] |= STATUS_AUX_3DA;
+    }
+    sequence++;
+    if (counting)
+    {
+        stats.produced++;
+    }
+
+    if (LIS3DH_Model_FifoEnabled())
+    {
+        // Overrun of the axes not read since the previous sample
+        status |= (status & axes) << 4;
+        if (status & STATUS_ZYXDA)
+        {
+            status |= STATUS_ZYXOR;
+        }
+        regs[REG_STATUS_REG] = status | axes | (axes ? STATUS_ZYXDA : 0);
+
+        if (fifo_level == FIFO_SIZE)
+        {
+            if ((regs[REG_FIFO_CTRL_REG] & FIFO_MODE_MASK) != FIFO_MODE_STREAM)
+            {
+                // FIFO mode: collection stops when full
+                if (counting)
+                {
+                    stats.lost++;
+                }
+                return;
+            }
+            // Stream mode: the oldest sample is overwritten
+            fifo_head = (fifo_head + 1) % FIFO_SIZE;
+            fifo_level--;
+            if (counting)
+            {
+                stats.lost++;
+            }
+        }
+        memcpy(fifo[(fifo_head + fifo_level) % FIFO_SIZE], sample, SAMPLE_SIZE);
+        fifo_time[(fifo_head + fifo_level) % FIFO_SIZE] = cycle;
+        fifo_level++;
+        return;
+    }
+
+    /* BDU: the held registers still show the sample being read, which is not
+    lost; a sample already held back behind it is */
+    uint8_t overwritten = (held && !held_update) ? 0 : unread;
+
+    if (overwritten)
+    {
+        status |= (overwritten << 4) | STATUS_ZYXOR;
+        if (counting)
+        {
+            stats.lost++;
+        }
+    }
+    else if (held && unread)
+    {
+        held_unread = unread;
+        held_time = sample_time;
+    }
+    regs[REG_STATUS_REG] = status | axes | (axes ? STATUS_ZYXDA : 0);
+    unread = axes;
+    sample_time = cycle;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (!(axes & (1 << axis)))
+        {
+            continue;
+        }
+        if (held)
+        {
+            // BDU: applied when the high byte of the last enabled axis is read
+            memcpy(&next_out[2 * axis], &sample[2 * axis], 2);
+            held_update |= 1 << axis;
+        }
+        else
+        {
+            memcpy(&regs[REG_OUT_X_L + 2 * axis], &sample[2 * axis], 2);
+        }
+    }
+}
+
+static uint8_t LIS3DH_Model_FifoSource(void)
+{
+    uint8_t fth = regs[REG_FIFO_CTRL_REG] & FIFO_FTH_MASK;
+    uint8_t src = (fifo_level < FIFO_SIZE) ? fifo_level : FIFO_SIZE - 1;
+
+    if (fifo_level > fth)
+    {
+        src |= FIFO_SRC_WTM;
+    }
+    if (fifo_level == FIFO_SIZE)
+    {
+        src |= FIFO_SRC_OVRN;
+    }
+    if (fifo_level == 0)
+    {
+        src |= FIFO_SRC_EMPTY;
+    }
+    return src;
+}
+
+// High byte of an axis read (FIFO disabled): the sample it belongs to, the status bits of the axis
+static void LIS3DH_Model_AxisRead(int axis)
+{
+    uint8_t axes = regs[REG_CTRL_REG1] & 0x07;
+    uint8_t bit = 1 << axis;
+
+    if (held_update)
+    {
+        // The older sample held back by BDU, then the update: new data still available on the axis
+        if (held_unread & bit)
+        {
+            held_unread &= ~bit;
+            if (!held_unread)
+            {
+                LIS3DH_Model_CountRead(held_time);
+            }
+        }
+    }
+    else
+    {
+        if (unread & bit)
+        {
+            unread &= ~bit;
+            if (!unread)
+            {
+                LIS3DH_Model_CountRead(sample_time);
+            }
+        }
+        regs[REG_STATUS_REG] &= ~(bit | (0x10 << axis));
+        if (!(regs[REG_STATUS_REG] & axes))
+        {
+            regs[REG_STATUS_REG] &= ~(STATUS_ZYXDA | STATUS_ZYXOR);
+        }
+    }
+    if (!held)
+    {
+        return;
+    }
+    // End of the hold: the sample held back, if any, is applied
+    held_read |= bit;
+    if ((held_read & axes) == axes)
+    {
+        for (int a = 0; a < 3; a++)
+        {
+            if (held_update & (1 << a))
+            {
+                memcpy(&regs[REG_OUT_X_L + 2 * a], &next_out[2 * a], 2);
+            }
+        }
+        held = 0;
+        held_read = 0;
+        held_update = 0;
+        held_unread = 0;
+    }
+}
+
+void LIS3DH_Model_Reset(const LIS3DH_Model_Config* model_config)
+{
+    config = *model_config;
+    now = 0;
+    memset(regs, 0, sizeof(regs));
+    regs[REG_WHO_AM_I] = WHO_AM_I_VALUE;
+    regs[REG_CTRL_REG1] = CTRL_REG1_DEFAULT;
+    address = 0;
+    increment = 0;
+    held = 0;
+    held_read = 0;
+    held_update = 0;
+    unread = 0;
+    held_unread = 0;
+    fifo_head = 0;
+    fifo_level = 0;
+    sequence = 0;
+    trace_over = 0;
+    counting = 0;
+    last_read = 0;
+    memset(&stats, 0, sizeof(stats));
+    noise_state = config.seed;
+    LIS3DH_Model_Restart();
+}
+
+uint64_t LIS3DH_Model_NextSample(void)
+{
+    return next_sample;
+}
+
+void LIS3DH_Model_Run(uint64_t cycle)
+{
+    while (next_sample <= cycle)
+    {
+        now = next_sample;
+        LIS3DH_Model_Produce(next_sample);
+        ticks++;
+        next_sample = trace_over ? UINT64_MAX : origin + (uint64_t)(period * (ticks + 1));
+    }
+    now = cycle;
+}
+
+int LIS3DH_Model_IsReady(void)
+{
+    return now >= (uint64_t)config.boot_us * (config.cpu_hz / 1000000);
+}
+
+void LIS3DH_Model_SetAddress(uint8_t value)
+{
+    address = value & 0x7F;
+    increment = value & 0x80;
+}
+
+void LIS3DH_Model_Write(uint8_t value)
+{
+    uint8_t reg = address;
+
+    if (increment)
+    {
+        address = (address + 1) & 0x7F;
+    }
+    // Read-only registers
+    if (reg >= REG_COUNT || (reg >= REG_STATUS_REG_AUX && reg <= REG_WHO_AM_I) || reg == REG_STATUS_REG ||
+        (reg >= REG_OUT_X_L && reg <= REG_OUT_Z_H) || reg == REG_FIFO_SRC_REG)
+    {
+        return;
+    }
+    uint8_t old = regs[reg];
+
+    regs[reg] = value;
+    if (reg == REG_CTRL_REG1 && ((old ^ value) & 0xF8))
+    {
+        LIS3DH_Model_Restart();
+    }
+    else if ((reg == REG_CTRL_REG5 || reg == REG_FIFO_CTRL_REG) && !LIS3DH_Model_FifoEnabled())
+    {
+        // Bypass mode empties the FIFO
+        fifo_level = 0;
+    }
+}
+
+uint8_t LIS3DH_Model_Read(void)
+{
+    uint8_t reg = address;
+    uint8_t value;
+
+    if (increment)
+    {
+        address = (address + 1) & 0x7F;
+        if (address > REG_OUT_Z_H && reg == REG_OUT_Z_H && LIS3DH_Model_FifoEnabled())
+        {
+            address = REG_OUT_X_L;
+        }
+    }
+    if (reg >= REG_COUNT)
+    {
+        return 0;
+    }
+    if (reg == REG_FIFO_SRC_REG)
+    {
+        return LIS3DH_Model_FifoSource();
+    }
+    if (reg == REG_OUT_ADC3_H)
+    {
+        regs[REG_STATUS_REG_AUX] &= ~(STATUS_AUX_3DA | STATUS_AUX_3OR);
+        return regs[REG_OUT_ADC3_H];
+    }
+    if (reg < REG_OUT_X_L || reg > REG_OUT_Z_H)
+    {
+        return regs[reg];
+    }
+
+    int axis = (reg - REG_OUT_X_L) / 2;
+    int high = (reg - REG_OUT_X_L) & 1;
+
+    if (LIS3DH_Model_FifoEnabled() && fifo_level)
+    {
+        // The oldest sample of the FIFO, which leaves it with OUT_Z_H
+        value = fifo[fifo_head][reg - REG_OUT_X_L];
+        if (reg == REG_OUT_Z_H)
+        {
+            memcpy(&regs[REG_OUT_X_L], fifo[fifo_head], SAMPLE_SIZE);
+            if (!counting)
+            {
+                counting = 1;
+                stats.produced = fifo_level;
+            }
+            LIS3DH_Model_CountRead(fifo_time[fifo_head]);
+            fifo_head = (fifo_head + 1) % FIFO_SIZE;
+            fifo_level--;
+        }
+        if (high)
+        {
+            regs[REG_STATUS_REG] &= ~((1 << axis) | (0x10 << axis));
+            if (!(regs[REG_STATUS_REG] & regs[REG_CTRL_REG1] & 0x07))
+            {
+                regs[REG_STATUS_REG] &= ~(STATUS_ZYXDA | STATUS_ZYXOR);
+            }
+        }
+        return value;
+    }
+
+    value = regs[reg];
+    if (!held && (regs[REG_CTRL_REG4] & CTRL_REG4_BDU))
+    {
+        // BDU: no update of the output registers until the sample is read
+        held = 1;
+    }
+    if (high)
+    {
+        LIS3DH_Model_AxisRead(axis);
+    }
+    return value;
+}
+
+int LIS3DH_Model_Int1(void)
+{
+    uint8_t ctrl_reg3 = regs[REG_CTRL_REG3];
+    uint8_t src = LIS3DH_Model_FifoEnabled() ? LIS3DH_Model_FifoSource() : 0;
+
+    return ((ctrl_reg3 & CTRL_REG3_I1_ZYXDA) && (regs[REG_STATUS_REG] & STATUS_ZYXDA)) ||
+           ((ctrl_reg3 & CTRL_REG3_I1_WTM) && (src & FIFO_SRC_WTM)) ||
+           ((ctrl_reg3 & CTRL_REG3_I1_OVERRUN) && (src & FIFO_SRC_OVRN));
+}
+
+void LIS3DH_Model_GetStats(LIS3DH_Model_Stats* model_stats, uint32_t* pending)
+{
+    *model_stats = stats;
+    // Nothing is counted before the first read
+    *pending = !counting ? 0 :
+               LIS3DH_Model_FifoEnabled() ? fifo_level : (uint32_t)(unread != 0) + (held_unread != 0);
+}
+
+void LIS3DH_Model_GetFormat(LIS3DH_Model_Format* format)
+{
+    format->odr_hz = LIS3DH_Model_Odr();
+    format->bits = LIS3DH_Model_Bits();
+    format->mg_per_digit = LIS3DH_Model_MgPerDigit();
+}
+
+uint64_t LIS3DH_Model_GetSequence(void)
+{
+    return sequence;
+}
+
+uint64_t LIS3DH_Model_GetSampleTime(uint64_t number)
+{
+    if (number >= sequence || sequence - number > LIS3DH_MODEL_HISTORY)
+    {
+        return UINT64_MAX;
+    }
+    return sequence_time[number % LIS3DH_MODEL_HISTORY];
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,173 @@
+/**
+ * \file LIS3DH_Model.h
+ * \brief Host build of the firmware modules: LIS3DH register model.
+ *
+ * The accelerometer as the I2C master of the simulator (see Sim.h) sees
+ * it, on the virtual clock:
+ *   - samples at the output data rate of CTRL_REG1 (ODR, LPen), with the
+ *     resolution and full scale of CTRL_REG4 (HR, FS), left-justified in
+ *     OUT_X_L..OUT_Z_H; the sensor clock may be off by some ppm;
+ *   - STATUS_REG: XDA, YDA, ZDA, ZYXDA set by a new sample, XOR, YOR, ZOR,
+ *     ZYXOR when it overwrites an unread one, cleared by reading the high
+ *     byte of the axis (ZYXDA and ZYXOR once all the enabled axes are read);
+ *   - BDU (CTRL_REG4): the output registers are not updated from the
+ *     first one read to the high byte of the last enabled axis, so a burst
+ *     never mixes two samples; a sample held back so is applied after it,
+ *     its DA bits left set;
+ *   - register address auto-increment when its MSB is set, rolling from
+ *     OUT_Z_H back to OUT_X_L while the FIFO is enabled;
+ *   - FIFO (CTRL_REG5 FIFO_EN, FIFO_CTRL_REG): 32 samples, FIFO and Stream
+ *     modes, FIFO_SRC_REG with WTM (level above FTH), OVRN_FIFO, EMPTY and
+ *     FSS; a sample leaves the FIFO when OUT_Z_H is read;
+ *   - INT1: I1_ZYXDA, I1_WTM and I1_OVERRUN of CTRL_REG3;
+ *   - OUT_ADC3_L, OUT_ADC3_H: temperature (8 bits, left-justified),
+ *     updated with the samples while ADC_EN and TEMP_EN of TEMP_CFG_REG
+ *     are set; STATUS_REG_AUX: 3DA set by an update, 3OR when it
+ *     overwrites an unread one, both cleared by reading OUT_ADC3_H;
+ *   - WHO_AM_I (0x33), and no acknowledge before the end of the boot.
+ * The signal is 1 g on Z and slow sines on X and Y, with white noise of a
+ * given density (fixed seed): every run is the same. The noise is limited
+ * to ODR/2, as by the filter of the sensor, or to a wider band which
+ * aliases into the samples at the lower rates. The sequence signal
+ * carries instead the number of each sample, so that the frames on the
+ * link can be traced back to their data ready (see Host_Tools/Benchmark.c):
+ * its low bits on X and Z, the next ones on Y, its 8 low bits in the
+ * temperature. The trace signal replays a recording (see
+ * Host_Tools/Replay.c).
+ * The model counts what the firmware cannot see: samples produced, read,
+ * lost in the sensor and the age of the samples when they are read.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef LIS3DH_MODEL_H
+    #define LIS3DH_MODEL_H
+    
+    #include <stdint.h>
+    
+    /**
+    *   \brief 7-bit I2C address (SA0 low).
+    */
+    #define LIS3DH_MODEL_ADDRESS 0x18
+    
+    /**
+    *   \brief Signals of the model.
+    */
+    #define LIS3DH_MODEL_SIGNAL_SINE 0      ///< Sines, 1 g and noise
+    #define LIS3DH_MODEL_SIGNAL_SEQUENCE 1  ///< Number of the sample, no noise
+    #define LIS3DH_MODEL_SIGNAL_TRACE 2     ///< Samples of a recording (see LIS3DH_Model_Config)
+    
+    /**
+    *   \brief Samples whose data ready is kept (see LIS3DH_Model_GetSampleTime()).
+    */
+    #define LIS3DH_MODEL_HISTORY 65536
+    
+    /**
+    *   \brief Output of the current configuration.
+    */
+    typedef struct {
+        double odr_hz;          ///< Output data rate, 0 in power-down mode
+        int bits;               ///< Resolution: 8 (low power), 10 (normal), 12 (high resolution)
+        double mg_per_digit;    ///< Sensitivity at that resolution and full scale
+    } LIS3DH_Model_Format;
+    
+    /**
+    *   \brief Model parameters.
+    */
+    typedef struct {
+        uint32_t cpu_hz;        ///< Virtual clock (cycles per second)
+        uint32_t boot_us;       ///< No acknowledge before this time
+        int32_t clock_ppm;      ///< Error of the output data rate
+        double noise_ug;        ///< Noise density (ug/sqrt(Hz))
+        double noise_hz;        ///< Bandwidth of the noise: 0 for ODR/2, more for noise aliased into the samples
+        uint32_t seed;          ///< Seed of the noise
+        int signal;             ///< One of the LIS3DH_MODEL_SIGNAL_* values
+        /// LIS3DH_MODEL_SIGNAL_TRACE: writes the output registers of the next
+        /// sample (OUT_X_L..OUT_Z_H) in the given format, returns 0 at the end
+        /// of the recording (no more samples, as in power-down mode)
+        int (*trace)(uint8_t* out, const LIS3DH_Model_Format* format);
+    } LIS3DH_Model_Config;
+    
+    /**
+    *   \brief Ground truth, counted from the first sample read (the boot
+    *   and the configuration are left out).
+    */
+    typedef struct {
+        uint64_t produced;      ///< Samples produced by the sensor
+        uint64_t read;          ///< Samples read (all the enabled axes, or out of the FIFO)
+        uint64_t lost;          ///< Samples overwritten before they were read
+        uint64_t age_sum;       ///< Cycles from the data ready to the reading, summed
+        uint64_t age_max;       ///< Longest one
+        uint64_t interval_sum;  ///< Cycles between two samples read, summed (read - 1 intervals)
+        double interval_sq_sum; ///< Their squares, summed (standard deviation)
+        uint64_t interval_max;  ///< Longest one
+    } LIS3DH_Model_Stats;
+    
+    /**
+    *   \brief Power-up: registers at their default value, no sample.
+    */
+    void LIS3DH_Model_Reset(const LIS3DH_Model_Config* config);
+    
+    /**
+    *   \brief Cycle of the next sample (UINT64_MAX in power-down mode).
+    */
+    uint64_t LIS3DH_Model_NextSample(void);
+    
+    /**
+    *   \brief Produce the samples up to 'now' (the next accesses happen then).
+    */
+    void LIS3DH_Model_Run(uint64_t now);
+    
+    /**
+    *   \brief Whether the boot is over (the address is acknowledged).
+    */
+    int LIS3DH_Model_IsReady(void);
+    
+    /**
+    *   \brief First data byte of a write transfer: register address.
+    */
+    void LIS3DH_Model_SetAddress(uint8_t address);
+    
+    /**
+    *   \brief Next data byte of a write transfer.
+    */
+    void LIS3DH_Model_Write(uint8_t value);
+    
+    /**
+    *   \brief Next data byte of a read transfer.
+    */
+    uint8_t LIS3DH_Model_Read(void);
+    
+    /**
+    *   \brief Level of the INT1 pin.
+    */
+    int LIS3DH_Model_Int1(void);
+    
+    /**
+    *   \brief Get the ground truth.
+    *
+    *   \param pending Samples produced and not yet read nor lost (from the first read on,
+    *          as the statistics).
+    */
+    void LIS3DH_Model_GetStats(LIS3DH_Model_Stats* stats, uint32_t* pending);
+    
+    /**
+    *   \brief Get the output of the current configuration.
+    */
+    void LIS3DH_Model_GetFormat(LIS3DH_Model_Format* format);
+    
+    /**
+    *   \brief Samples produced since the power-up: number of the next one.
+    */
+    uint64_t LIS3DH_Model_GetSequence(void);
+    
+    /**
+    *   \brief Data ready of a sample, by number.
+    *
+    *   \retval Cycle of the data ready, UINT64_MAX if the sample is not
+    *           produced yet or older than the last LIS3DH_MODEL_HISTORY ones.
+    */
+    uint64_t LIS3DH_Model_GetSampleTime(uint64_t number);
+
+#endif // LIS3DH_MODEL_H
+/* [] END OF FILE */
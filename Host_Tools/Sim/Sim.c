@@ -0,0 +1,746 @@
+/**
+ * \file Sim.c
+ * \brief Host build of the firmware modules: virtual-time simulator.
+ *
+ * See Sim.h. Time only moves forward in Sim_Spend() (CPU running) and in
+ * HostClock_Sleep() (CPU asleep), one event at a time: samples of the
+ * LIS3DH model, bytes of the I2C buffer transfers, bytes leaving the UART
+ * shift register, terminal counts of Timer_Poll and CPU stalls.
+ *
+ * \Author Marco Sinatra
+*/
+
+#include <math.h>
+#include <setjmp.h>
+#include <string.h>
+#include "Sim.h"
+#include "project.h"
+
+#define CPU_HZ BCLK__BUS_CLK__HZ
+#define NEVER UINT64_MAX
+
+#define I2C_BYTE_BITS 9         // 8 data bits and the acknowledge
+#define UART_FRAME_BITS 10      // Start bit, 8 data bits, stop bit
+#define UART_FIFO_SIZE 4
+#define TIMER_STS_TC 0x01
+
+/**
+*   \brief CPU cycles of the component functions (estimates).
+*/
+#define COST_CALL 20            // Function call and a few register accesses
+#define COST_REGISTER 8         // Single register access (status, data, pin)
+#define COST_XFER_SETUP 120     // MasterWriteBuf(), MasterReadBuf()
+#define COST_I2C_BYTE_ISR 90    // I2C interrupt per byte of a buffer transfer
+#define COST_ISR_ENTRY 24       // Exception entry and return
+#define COST_WFI 4
+
+typedef struct {
+    cyisraddress handler;       // NULL until StartEx()
+    int enabled;
+    int pending;                // Edge or terminal count (not the UART level)
+} Sim_Interrupt;
+
+static Sim_Config config;
+static Sim_Stats stats;
+static jmp_buf run_end;
+static uint64_t now;
+static uint64_t end_time;
+static uint64_t delay;          // CPU cycles taken from the running code by the interrupts
+static int masked;              // Critical section (PRIMASK)
+static int in_isr;
+static int sleeping;
+static uint64_t isr_time;       // Cycles of the interrupt being served
+static uint32_t random_state;
+
+static Sim_Interrupt isr_int1;
+static Sim_Interrupt isr_poll;
+static Sim_Interrupt isr_uart_tx;
+static int int1_level;
+
+static uint64_t i2c_bit;        // Cycles per bit
+static int i2c_addressed;       // Slave acknowledged the address of the current transfer
+static int i2c_register;        // Next byte written is the register address
+static uint8_t i2c_status;      // MasterStatus()
+static struct {
+    uint8_t address;
+    uint8_t* data;
+    int count;
+    int index;                  // -1: address byte
+    int read;
+    uint8_t mode;
+    uint64_t next;              // End of the current byte, NEVER when idle
+} xfer;
+
+static uint64_t uart_byte;      // Cycles per byte
+static uint8_t uart_fifo[UART_FIFO_SIZE];
+static int uart_head;
+static int uart_level;
+static uint64_t uart_done;      // End of the byte in the shift register, NEVER when idle
+static uint8_t uart_data;       // That byte
+
+static uint64_t timer_count;    // Cycles per count
+static uint16_t timer_period;
+static uint64_t timer_tc;       // Next terminal count, NEVER when stopped
+static uint8_t timer_status;
+
+static uint64_t stall_next;
+
+// Uniform value in [0, 1), xorshift32
+static double Sim_Random(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state / 4294967296.0;
+}
+
+static uint64_t Sim_NextStall(void)
+{
+    if (config.stall_rate <= 0)
+    {
+        return NEVER;
+    }
+    return now + 1 + (uint64_t)(-log(1.0 - Sim_Random()) / config.stall_rate * CPU_HZ);
+}
+
+// CPU time taken by an event: woken up while asleep, delayed while running
+static void Sim_Busy(uint64_t cycles)
+{
+    stats.isr_cycles += cycles;
+    if (sleeping)
+    {
+        stats.awake_cycles += cycles;
+    }
+    else
+    {
+        delay += cycles;
+    }
+}
+
+static void Sim_Int1Update(void)
+{
+    int level = LIS3DH_Model_Int1();
+
+    if (level && !int1_level && isr_int1.handler)
+    {
+        isr_int1.pending = 1;
+    }
+    int1_level = level;
+}
+
+// Interrupt to be served, by priority
+static Sim_Interrupt* Sim_PendingInterrupt(void)
+{
+    if (isr_int1.enabled && isr_int1.pending)
+    {
+        return &isr_int1;
+    }
+    if (isr_poll.enabled && isr_poll.pending)
+    {
+        return &isr_poll;
+    }
+    if (isr_uart_tx.handler && isr_uart_tx.enabled && uart_level < UART_FIFO_SIZE)
+    {
+        return &isr_uart_tx;
+    }
+    return NULL;
+}
+
+/* -------- I2C slave side -------- */
+
+// Byte clocked on the bus: the address byte holds the R/W bit
+static void Sim_I2cByte(uint8_t data, int start)
+{
+    stats.i2c_bytes++;
+    if (config.i2c_monitor != NULL)
+    {
+        config.i2c_monitor(data, start);
+    }
+}
+
+static int Sim_I2cAcknowledge(uint8_t address)
+{
+    if (address != LIS3DH_MODEL_ADDRESS || !LIS3DH_Model_IsReady())
+    {
+        return 0;
+    }
+    if (config.nack_rate > 0 && Sim_Random() < config.nack_rate)
+    {
+        stats.nacks++;
+        return 0;
+    }
+    return 1;
+}
+
+static void Sim_I2cWrite(uint8_t data)
+{
+    if (i2c_register)
+    {
+        LIS3DH_Model_SetAddress(data);
+        i2c_register = 0;
+    }
+    else
+    {
+        LIS3DH_Model_Write(data);
+    }
+    Sim_Int1Update();
+}
+
+static uint8_t Sim_I2cRead(void)
+{
+    uint8_t data = LIS3DH_Model_Read();
+
+    Sim_Int1Update();
+    return data;
+}
+
+/* -------- Events -------- */
+
+// End of a byte of the buffer transfer
+static void Sim_XferEvent(void)
+{
+    uint8_t complete = xfer.read ? I2C_Master_MSTAT_RD_CMPLT : I2C_Master_MSTAT_WR_CMPLT;
+
+    Sim_Busy(COST_I2C_BYTE_ISR);
+    if (xfer.index < 0)
+    {
+        Sim_I2cByte((uint8_t)((xfer.address << 1) | (xfer.read ? 1 : 0)), 1);
+        if (!Sim_I2cAcknowledge(xfer.address))
+        {
+            // The component generates the stop condition
+            stats.i2c_cycles += i2c_bit;
+            i2c_status |= complete | I2C_Master_MSTAT_ERR_ADDR_NAK | I2C_Master_MSTAT_ERR_XFER;
+            xfer.next = NEVER;
+            return;
+        }
+        i2c_register = !xfer.read;
+    }
+    else if (xfer.read)
+    {
+        xfer.data[xfer.index] = Sim_I2cRead();
+        Sim_I2cByte(xfer.data[xfer.index], 0);
+    }
+    else
+    {
+        Sim_I2cByte(xfer.data[xfer.index], 0);
+        Sim_I2cWrite(xfer.data[xfer.index]);
+    }
+    if (++xfer.index < xfer.count)
+    {
+        xfer.next += I2C_BYTE_BITS * i2c_bit;
+        stats.i2c_cycles += I2C_BYTE_BITS * i2c_bit;
+        return;
+    }
+    if (xfer.mode & I2C_Master_MODE_NO_STOP)
+    {
+        i2c_status |= complete | I2C_Master_MSTAT_XFER_HALT;
+    }
+    else
+    {
+        stats.i2c_cycles += i2c_bit;
+        i2c_status |= complete;
+    }
+    xfer.next = NEVER;
+}
+
+// Next byte of the TX FIFO into the shift register
+static void Sim_UartLoad(void)
+{
+    if (uart_done == NEVER && uart_level)
+    {
+        uint8_t data = uart_fifo[uart_head];
+
+        uart_head = (uart_head + 1) % UART_FIFO_SIZE;
+        uart_level--;
+        uart_done = now + uart_byte;
+        stats.uart_cycles += uart_byte;
+        stats.uart_bytes++;
+        if (config.capture != NULL)
+        {
+            fputc(data, config.capture);
+        }
+        uart_data = data;
+    }
+}
+
+static void Sim_TimerEvent(void)
+{
+    timer_status |= TIMER_STS_TC;
+    if (isr_poll.handler)
+    {
+        isr_poll.pending = 1;
+    }
+    // The counter reloads the period register
+    timer_tc += ((uint64_t)timer_period + 1) * timer_count;
+}
+
+static uint64_t Sim_NextEvent(void)
+{
+    uint64_t next = LIS3DH_Model_NextSample();
+
+    next = (xfer.next < next) ? xfer.next : next;
+    next = (uart_done < next) ? uart_done : next;
+    next = (timer_tc < next) ? timer_tc : next;
+    next = (stall_next < next) ? stall_next : next;
+    return next;
+}
+
+// Move the clock to 'cycle' (not beyond the next event) and handle the events due
+static void Sim_StepTo(uint64_t cycle)
+{
+    if (cycle > end_time)
+    {
+        cycle = end_time;
+    }
+    if (!sleeping)
+    {
+        stats.awake_cycles += cycle - now;
+    }
+    now = cycle;
+    if (now >= end_time)
+    {
+        longjmp(run_end, 1);
+    }
+
+    LIS3DH_Model_Run(now);
+    Sim_Int1Update();
+    if (xfer.next <= now)
+    {
+        Sim_XferEvent();
+    }
+    if (uart_done <= now)
+    {
+        if (config.monitor != NULL)
+        {
+            config.monitor(uart_data, uart_done);
+        }
+        uart_done = NEVER;
+        Sim_UartLoad();
+    }
+    if (timer_tc <= now)
+    {
+        Sim_TimerEvent();
+    }
+    if (stall_next <= now)
+    {
+        stats.stalls++;
+        Sim_Busy((uint64_t)config.stall_us * (CPU_HZ / 1000000));
+        stall_next = Sim_NextStall();
+    }
+}
+
+// Serve the pending interrupts (not while masked or in an interrupt)
+static void Sim_Dispatch(void)
+{
+    Sim_Interrupt* isr;
+
+    while (!masked && !in_isr && (isr = Sim_PendingInterrupt()) != NULL)
+    {
+        isr->pending = 0;
+        in_isr = 1;
+        isr_time = COST_ISR_ENTRY;
+        stats.interrupts++;
+        isr->handler();
+        in_isr = 0;
+        stats.isr_cycles += isr_time;
+        delay += isr_time;
+    }
+}
+
+// Run the CPU for 'cycles', plus the time taken by the interrupts meanwhile
+static void Sim_Spend(uint64_t cycles)
+{
+    uint64_t target = now + cycles;
+
+    if (in_isr)
+    {
+        isr_time += cycles;
+        return;
+    }
+    for (;;)
+    {
+        Sim_Dispatch();
+        target += delay;
+        delay = 0;
+        if (now >= target)
+        {
+            return;
+        }
+        uint64_t next = Sim_NextEvent();
+        Sim_StepTo((next < target) ? next : target);
+    }
+}
+
+static void Sim_I2cBits(uint32_t bits)
+{
+    stats.i2c_cycles += bits * i2c_bit;
+    Sim_Spend(bits * i2c_bit);
+}
+
+/* -------- Host clock -------- */
+
+uint32_t HostClock_Cycles(void)
+{
+    return (uint32_t)(stats.awake_cycles + (in_isr ? isr_time : 0));
+}
+
+void HostClock_Sleep(void)
+{
+    Sim_Spend(COST_WFI);
+    sleeping = 1;
+    while (Sim_PendingInterrupt() == NULL)
+    {
+        Sim_StepTo(Sim_NextEvent());
+    }
+    sleeping = 0;
+    Sim_Spend(0);
+}
+
+uint8 CyEnterCriticalSection(void)
+{
+    uint8 state = (uint8)masked;
+
+    Sim_Spend(COST_REGISTER);
+    masked = 1;
+    return state;
+}
+
+void CyExitCriticalSection(uint8 savedIntrStatus)
+{
+    masked = savedIntrStatus;
+    Sim_Spend(COST_REGISTER);
+}
+
+void CyDelay(uint32 milliseconds)
+{
+    Sim_Spend((uint64_t)milliseconds * (CPU_HZ / 1000));
+}
+
+void CyDelayUs(uint16 microseconds)
+{
+    Sim_Spend((uint64_t)microseconds * (CPU_HZ / 1000000));
+}
+
+/* -------- I2C_Master -------- */
+
+void I2C_Master_Start(void)
+{
+    Sim_Spend(COST_CALL);
+}
+
+void I2C_Master_Stop(void)
+{
+    Sim_Spend(COST_CALL);
+}
+
+uint8 I2C_Master_MasterSendStart(uint8 slaveAddress, uint8 R_nW)
+{
+    Sim_Spend(COST_CALL);
+    if (xfer.next != NEVER)
+    {
+        return I2C_Master_MSTR_BUS_BUSY;
+    }
+    // Start condition and address byte
+    Sim_I2cBits(1 + I2C_BYTE_BITS);
+    Sim_I2cByte((uint8_t)((slaveAddress << 1) | R_nW), 1);
+    i2c_addressed = Sim_I2cAcknowledge(slaveAddress);
+    i2c_register = (R_nW == I2C_Master_WRITE_XFER_MODE);
+    return i2c_addressed ? I2C_Master_MSTR_NO_ERROR : I2C_Master_MSTR_ERR_LB_NAK;
+}
+
+uint8 I2C_Master_MasterSendRestart(uint8 slaveAddress, uint8 R_nW)
+{
+    return I2C_Master_MasterSendStart(slaveAddress, R_nW);
+}
+
+uint8 I2C_Master_MasterSendStop(void)
+{
+    Sim_Spend(COST_CALL);
+    Sim_I2cBits(1);
+    i2c_addressed = 0;
+    return I2C_Master_MSTR_NO_ERROR;
+}
+
+uint8 I2C_Master_MasterWriteByte(uint8 theByte)
+{
+    Sim_Spend(COST_CALL);
+    if (!i2c_addressed)
+    {
+        return I2C_Master_MSTR_NOT_READY;
+    }
+    Sim_I2cBits(I2C_BYTE_BITS);
+    Sim_I2cByte(theByte, 0);
+    Sim_I2cWrite(theByte);
+    return I2C_Master_MSTR_NO_ERROR;
+}
+
+uint8 I2C_Master_MasterReadByte(uint8 acknNak)
+{
+    (void)acknNak;
+    Sim_Spend(COST_CALL);
+    if (!i2c_addressed)
+    {
+        return 0;
+    }
+    Sim_I2cBits(I2C_BYTE_BITS);
+
+    uint8_t data = Sim_I2cRead();
+
+    Sim_I2cByte(data, 0);
+    return data;
+}
+
+// Buffer transfer: start (or restart) condition and address byte first
+static uint8 Sim_XferStart(uint8 address, uint8* data, uint8 count, uint8 mode, int read)
+{
+    Sim_Spend(COST_XFER_SETUP);
+    if (xfer.next != NEVER)
+    {
+        return I2C_Master_MSTR_BUS_BUSY;
+    }
+    xfer.address = address;
+    xfer.data = data;
+    xfer.count = count;
+    xfer.index = -1;
+    xfer.read = read;
+    xfer.mode = mode;
+    xfer.next = now + (1 + I2C_BYTE_BITS) * i2c_bit;
+    stats.i2c_cycles += (1 + I2C_BYTE_BITS) * i2c_bit;
+    i2c_status &= ~I2C_Master_MSTAT_XFER_HALT;
+    return I2C_Master_MSTR_NO_ERROR;
+}
+
+uint8 I2C_Master_MasterWriteBuf(uint8 slaveAddress, uint8* wrData, uint8 cnt, uint8 mode)
+{
+    return Sim_XferStart(slaveAddress, wrData, cnt, mode, 0);
+}
+
+uint8 I2C_Master_MasterReadBuf(uint8 slaveAddress, uint8* rdData, uint8 cnt, uint8 mode)
+{
+    return Sim_XferStart(slaveAddress, rdData, cnt, mode, 1);
+}
+
+uint8 I2C_Master_MasterStatus(void)
+{
+    Sim_Spend(COST_REGISTER);
+    return i2c_status | ((xfer.next != NEVER) ? I2C_Master_MSTAT_XFER_INP : 0);
+}
+
+uint8 I2C_Master_MasterClearStatus(void)
+{
+    uint8 status = i2c_status;
+
+    Sim_Spend(COST_REGISTER);
+    i2c_status = 0;
+    return status;
+}
+
+/* -------- UART_Debug -------- */
+
+void UART_Debug_Start(void)
+{
+    Sim_Spend(COST_CALL);
+}
+
+void UART_Debug_WriteTxData(uint8 txDataByte)
+{
+    Sim_Spend(COST_REGISTER);
+    if (uart_level == UART_FIFO_SIZE)
+    {
+        stats.uart_overflows++;
+        return;
+    }
+    uart_fifo[(uart_head + uart_level) % UART_FIFO_SIZE] = txDataByte;
+    uart_level++;
+    Sim_UartLoad();
+}
+
+uint8 UART_Debug_ReadTxStatus(void)
+{
+    Sim_Spend(COST_REGISTER);
+    return ((uart_level < UART_FIFO_SIZE) ? UART_Debug_TX_STS_FIFO_NOT_FULL : UART_Debug_TX_STS_FIFO_FULL) |
+           ((uart_level == 0) ? UART_Debug_TX_STS_FIFO_EMPTY : 0) |
+           ((uart_level == 0 && uart_done == NEVER) ? UART_Debug_TX_STS_COMPLETE : 0);
+}
+
+void UART_Debug_PutChar(uint8 data)
+{
+    Sim_Spend(COST_CALL);
+    // Busy wait for room in the TX FIFO
+    while (uart_level == UART_FIFO_SIZE)
+    {
+        Sim_Spend((uart_done > now) ? uart_done - now : 1);
+    }
+    UART_Debug_WriteTxData(data);
+}
+
+void UART_Debug_PutString(const char* string)
+{
+    while (*string)
+    {
+        UART_Debug_PutChar((uint8)*string++);
+    }
+}
+
+void UART_Debug_PutArray(const uint8 string[], uint8 byteCount)
+{
+    for (uint8 i = 0; i < byteCount; i++)
+    {
+        UART_Debug_PutChar(string[i]);
+    }
+}
+
+uint8 UART_Debug_GetChar(void)
+{
+    // Nothing received
+    Sim_Spend(COST_REGISTER);
+    return 0;
+}
+
+/* -------- Timer_Poll, Pin_INT1, interrupts -------- */
+
+void Timer_Poll_Start(void)
+{
+    Sim_Spend(COST_CALL);
+    timer_tc = now + ((uint64_t)timer_period + 1) * timer_count;
+}
+
+void Timer_Poll_WritePeriod(uint16 period)
+{
+    Sim_Spend(COST_REGISTER);
+    timer_period = period;
+}
+
+uint8 Timer_Poll_ReadStatusRegister(void)
+{
+    uint8 status = timer_status;
+
+    Sim_Spend(COST_REGISTER);
+    timer_status = 0;
+    return status;
+}
+
+uint16 Timer_Poll_ReadCounter(void)
+{
+    Sim_Spend(COST_REGISTER);
+    // Counts left to the terminal count: the period value right after it, 0 on the last count
+    return (timer_tc == NEVER || timer_tc <= now) ? 0 : (uint16)((timer_tc - now - 1) / timer_count);
+}
+
+uint8 Pin_INT1_Read(void)
+{
+    Sim_Spend(COST_REGISTER);
+    return (uint8)int1_level;
+}
+
+uint8 Pin_INT1_ClearInterrupt(void)
+{
+    Sim_Spend(COST_REGISTER);
+    return 0;
+}
+
+static void Sim_StartInterrupt(Sim_Interrupt* isr, cyisraddress address)
+{
+    isr->handler = address;
+    isr->enabled = 1;
+    isr->pending = 0;
+    Sim_Spend(COST_CALL);
+}
+
+void isr_INT1_StartEx(cyisraddress address)
+{
+    Sim_StartInterrupt(&isr_int1, address);
+}
+
+void isr_Poll_StartEx(cyisraddress address)
+{
+    Sim_StartInterrupt(&isr_poll, address);
+}
+
+void isr_UART_TX_StartEx(cyisraddress address)
+{
+    Sim_StartInterrupt(&isr_uart_tx, address);
+}
+
+void isr_UART_TX_Enable(void)
+{
+    isr_uart_tx.enabled = 1;
+    Sim_Spend(COST_REGISTER);
+}
+
+void isr_UART_TX_Disable(void)
+{
+    isr_uart_tx.enabled = 0;
+    Sim_Spend(COST_REGISTER);
+}
+
+/* -------- Run -------- */
+
+int Sim_Run(const Sim_Config* sim_config, int (*firmware)(void))
+{
+    LIS3DH_Model_Config sensor;
+
+    config = *sim_config;
+    memset(&stats, 0, sizeof(stats));
+    now = 0;
+    end_time = (uint64_t)(config.seconds * CPU_HZ);
+    delay = 0;
+    masked = 0;
+    in_isr = 0;
+    sleeping = 0;
+    random_state = config.seed ? config.seed : 1;
+    memset(&isr_int1, 0, sizeof(isr_int1));
+    memset(&isr_poll, 0, sizeof(isr_poll));
+    memset(&isr_uart_tx, 0, sizeof(isr_uart_tx));
+    int1_level = 0;
+
+    i2c_bit = (CPU_HZ + config.i2c_hz / 2) / config.i2c_hz;
+    i2c_addressed = 0;
+    i2c_register = 0;
+    i2c_status = 0;
+    xfer.next = NEVER;
+    uart_byte = ((uint64_t)UART_FRAME_BITS * CPU_HZ + config.baud / 2) / config.baud;
+    uart_head = 0;
+    uart_level = 0;
+    uart_done = NEVER;
+    timer_count = CPU_HZ / config.timer_hz;
+    timer_period = 0;
+    timer_tc = NEVER;
+    timer_status = 0;
+    stall_next = Sim_NextStall();
+
+    sensor = config.sensor;
+    sensor.cpu_hz = CPU_HZ;
+    LIS3DH_Model_Reset(&sensor);
+
+    if (setjmp(run_end) == 0)
+    {
+        firmware();
+        stats.cycles = now;
+        return 1;
+    }
+    stats.cycles = now;
+    return 0;
+}
+
+void Sim_GetStats(Sim_Stats* sim_stats)
+{
+    *sim_stats = stats;
+}
+
+double Sim_Time(void)
+{
+    return (double)now / CPU_HZ;
+}
+
+void Sim_Stop(double seconds)
+{
+    uint64_t stop = now + (uint64_t)(seconds * CPU_HZ);
+
+    if (stop < end_time)
+    {
+        end_time = stop;
+    }
+}
+
+/* [] END OF FILE */
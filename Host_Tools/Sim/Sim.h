@@ -0,0 +1,102 @@
+/**
+ * \file Sim.h
+ * \brief Host build of the firmware modules: virtual-time simulator.
+ *
+ * Implements the PSoC components of project.h and I2C_Master.h on a
+ * virtual clock of BCLK__BUS_CLK__HZ cycles per second, so that the
+ * firmware of PROJ_2 or PROJ_3, main() included, runs unmodified on the PC:
+ *   - each call of a component function costs a few CPU cycles (estimated:
+ *     the firmware code in between costs nothing, so the CPU load is a
+ *     lower bound) and the busy waits cost the time they wait;
+ *   - I2C_Master: 9 bit times per byte, one more for the start, restart
+ *     and stop conditions; the buffer transfers (MasterWriteBuf and
+ *     MasterReadBuf) go on while the CPU runs, one interrupt per byte;
+ *     the slave at address 0x18 is the LIS3DH model (see LIS3DH_Model.h);
+ *     the bytes clocked on the bus are counted and may be passed to a
+ *     monitor, address bytes included;
+ *   - UART_Debug: 4-byte TX FIFO, 10 bit times per byte; the bytes sent
+ *     may be written to a capture file (for Host_Tools/FrameDecoder) or
+ *     passed to a monitor with the cycle of their stop bit;
+ *   - Timer_Poll: down counter, period reloaded at the terminal count,
+ *     counter readable;
+ *   - interrupts: isr_INT1 on the rising edge of INT1, isr_Poll at the
+ *     terminal count, isr_UART_TX while the TX FIFO is not full; masked in
+ *     the critical sections, served between two component calls;
+ *   - CY_PM_WFI: the clock jumps to the next interrupt, the time asleep is
+ *     not counted by HostClock_Cycles() (as the DWT cycle counter).
+ * Faults may be injected with a fixed seed: address bytes not
+ * acknowledged and CPU stalls (other interrupts, flash writes), so that the
+ * error and overrun counters of the firmware can be checked against the
+ * ground truth of the model.
+ * The firmware keeps its static state: one run per process.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef SIM_H
+    #define SIM_H
+    
+    #include <stdio.h>
+    #include "LIS3DH_Model.h"
+    
+    /**
+    *   \brief Simulation parameters.
+    */
+    typedef struct {
+        double seconds;             ///< Virtual time to run
+        uint32_t i2c_hz;            ///< I2C clock (100000 or 400000)
+        uint32_t baud;              ///< UART bit rate
+        uint32_t timer_hz;          ///< Clock of Timer_Poll
+        LIS3DH_Model_Config sensor; ///< The clock is set by the simulator
+        double nack_rate;           ///< Probability that an address byte is not acknowledged
+        double stall_rate;          ///< CPU stalls per second (Poisson)
+        uint32_t stall_us;          ///< Length of a stall
+        uint32_t seed;              ///< Seed of the faults
+        FILE* capture;              ///< Bytes sent on the UART (NULL: not kept)
+        void (*monitor)(uint8_t data, uint64_t cycle); ///< Byte sent on the UART and end of its stop bit (NULL: none)
+        void (*i2c_monitor)(uint8_t data, int start); ///< Byte on the I2C bus, start set for an address byte (NULL: none)
+    } Sim_Config;
+    
+    /**
+    *   \brief Simulation counters.
+    */
+    typedef struct {
+        uint64_t cycles;            ///< Virtual time
+        uint64_t awake_cycles;      ///< CPU not sleeping in WFI
+        uint64_t isr_cycles;        ///< CPU in the interrupts of the firmware and of the I2C component
+        uint64_t interrupts;        ///< Interrupts of the firmware served
+        uint64_t i2c_cycles;        ///< Bus busy
+        uint64_t i2c_bytes;         ///< Bytes clocked on the bus, address bytes included
+        uint64_t uart_cycles;       ///< Link busy
+        uint64_t uart_bytes;        ///< Bytes sent
+        uint64_t uart_overflows;    ///< Bytes written into a full TX FIFO (lost)
+        uint64_t nacks;             ///< Address bytes not acknowledged by fault injection
+        uint64_t stalls;            ///< CPU stalls injected
+    } Sim_Stats;
+    
+    /**
+    *   \brief Run the firmware for the virtual time of the configuration.
+    *
+    *   \param firmware main() of the firmware (renamed at build time).
+    *   \retval 0 when the time is over, 1 if the firmware returned.
+    */
+    int Sim_Run(const Sim_Config* config, int (*firmware)(void));
+    
+    /**
+    *   \brief Get the simulation counters.
+    */
+    void Sim_GetStats(Sim_Stats* stats);
+    
+    /**
+    *   \brief Virtual time since the start of the run (s).
+    */
+    double Sim_Time(void);
+    
+    /**
+    *   \brief End the run earlier: 'seconds' of virtual time from now (e.g.
+    *   to send the last frames once a recording is over).
+    */
+    void Sim_Stop(double seconds);
+
+#endif // SIM_H
+/* [] END OF FILE */
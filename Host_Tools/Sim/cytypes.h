@@ -0,0 +1,42 @@
+/**
+ * \file cytypes.h
+ * \brief Host build of the firmware modules: PSoC types.
+ *
+ * Stands for the cytypes.h generated by PSoC Creator when the firmware
+ * modules are compiled on the PC (HOST_BUILD): the same integer types and
+ * the few macros of the core the modules use.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef CYTYPES_H
+    #define CYTYPES_H
+    
+    #include <stdint.h>
+    #include <stddef.h>
+    
+    typedef uint8_t uint8;
+    typedef uint16_t uint16;
+    typedef uint32_t uint32;
+    typedef int8_t int8;
+    typedef int16_t int16;
+    typedef int32_t int32;
+    typedef float float32;
+    typedef volatile uint8_t reg8;
+    typedef volatile uint32_t reg32;
+    typedef void (*cyisraddress)(void);
+    
+    #define CY_ISR(name) void name(void)
+    #define CY_ISR_PROTO(name) void name(void)
+    
+    #define CyGlobalIntEnable
+    #define CyGlobalIntDisable
+    
+    /**
+    *   \brief Variables left out of the startup initialisation: plain ones
+    *   on the PC (zero at each run).
+    */
+    #define CY_NOINIT
+
+#endif // CYTYPES_H
+/* [] END OF FILE */
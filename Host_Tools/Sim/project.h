@@ -0,0 +1,71 @@
+/**
+ * \file project.h
+ * \brief Host build of the firmware modules: PSoC components.
+ *
+ * Stands for the project.h generated by PSoC Creator (HOST_BUILD): the
+ * functions of the components called by the firmware modules, implemented
+ * by the host program. ProfilerSim only implements the UART_Debug ones,
+ * the simulator (see Sim.h) all of them.
+ *
+ * \Author Marco Sinatra
+*/
+
+#ifndef PROJECT_H
+    #define PROJECT_H
+    
+    #include "cytypes.h"
+    #include "I2C_Master.h"
+    
+    /**
+    *   \brief Bus clock of the TopDesign (the CPU clock).
+    */
+    #define BCLK__BUS_CLK__HZ 24000000U
+    
+    /**
+    *   \brief UART_Debug component.
+    */
+    #define UART_Debug_TX_STS_COMPLETE 0x01
+    #define UART_Debug_TX_STS_FIFO_EMPTY 0x02
+    #define UART_Debug_TX_STS_FIFO_FULL 0x04
+    #define UART_Debug_TX_STS_FIFO_NOT_FULL 0x08
+    
+    void UART_Debug_Start(void);
+    void UART_Debug_PutChar(uint8 data);
+    void UART_Debug_PutString(const char* string);
+    void UART_Debug_PutArray(const uint8 string[], uint8 byteCount);
+    uint8 UART_Debug_GetChar(void);
+    void UART_Debug_WriteTxData(uint8 txDataByte);
+    uint8 UART_Debug_ReadTxStatus(void);
+    
+    /**
+    *   \brief Timer_Poll component (see USE_POLL_TIMER).
+    */
+    void Timer_Poll_Start(void);
+    void Timer_Poll_WritePeriod(uint16 period);
+    uint8 Timer_Poll_ReadStatusRegister(void);
+    uint16 Timer_Poll_ReadCounter(void);
+    
+    /**
+    *   \brief Pin_INT1 and the interrupt components.
+    */
+    uint8 Pin_INT1_Read(void);
+    uint8 Pin_INT1_ClearInterrupt(void);
+    void isr_INT1_StartEx(cyisraddress address);
+    void isr_Poll_StartEx(cyisraddress address);
+    void isr_UART_TX_StartEx(cyisraddress address);
+    void isr_UART_TX_Enable(void);
+    void isr_UART_TX_Disable(void);
+    
+    /**
+    *   \brief Core: critical sections, busy wait and sleep until an interrupt.
+    */
+    uint8 CyEnterCriticalSection(void);
+    void CyExitCriticalSection(uint8 savedIntrStatus);
+    void CyDelay(uint32 milliseconds);
+    void CyDelayUs(uint16 microseconds);
+    void HostClock_Sleep(void);
+    
+    #define CY_PM_WFI HostClock_Sleep()
+
+#endif // PROJECT_H
+/* [] END OF FILE */